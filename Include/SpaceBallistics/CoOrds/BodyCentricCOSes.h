@@ -108,6 +108,9 @@ namespace SpaceBallistics
   template<Body BodyName>
   using ForceVRot  = ForceV <BodyCentricRotatingCOS<BodyName>>;
 
+  template<Body BodyName>
+  using GravGradTRot = GravGradT<BodyCentricRotatingCOS<BodyName>>;
+
   // XXX: Probably no point in considering the MOI Tensors and Rotational Vecs
   // in this COS yet...
 }
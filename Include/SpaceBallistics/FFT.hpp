@@ -0,0 +1,193 @@
+// vim:ts=2:et
+//===========================================================================//
+//                         "SpaceBallistics/FFT.hpp":                        //
+//            A Small Mixed-Radix Fast Fourier Transform (Any Size)          //
+//===========================================================================//
+#pragma once
+#include "SpaceBallistics/Types.hpp"
+#include <algorithm>
+#include <cassert>
+#include <complex>
+#include <stdexcept>
+#include <vector>
+
+namespace SpaceBallistics
+{
+  //=========================================================================//
+  // "FFT" Class:                                                            //
+  //=========================================================================//
+  // A plan for the complex DFT of the given size "n" (any n >= 1):  the size
+  // is factored into primes, and the recursive decimation-in-time algorithm
+  // is applied, with a specialised radix-2 butterfly and a generic O(p^2) one
+  // for the other prime factors "p". So the cost is O(n * Sum(p)), ie O(n *
+  // log(n)) for the "smooth" sizes typically used for grids (360, 720, 1024,
+  // ...), and O(n^2) in the worst case of a prime "n".
+  // The plan is immutable after construction, so it can be shared between
+  // threads; the work space of the generic butterfly is provided by the call-
+  // er (see "ScratchSize"), so the transforms do not allocate:
+  //
+  class FFT
+  {
+  public:
+    using Complex = std::complex<double>;
+
+  private:
+    //=======================================================================//
+    // Data Flds:                                                            //
+    //=======================================================================//
+    int                  m_n;
+    int                  m_maxP;    // Max radix handled by "ButterflyP"
+    std::vector<int>     m_factors; // Pairs (p, n/(p1*...*p)), last one is 1
+    std::vector<Complex> m_tw;      // exp(+2*Pi*i*k/n), k = 0 .. n-1
+
+  public:
+    //=======================================================================//
+    // Non-Default Ctor:                                                     //
+    //=======================================================================//
+    explicit FFT(int a_n)
+    : m_n      (a_n),
+      m_maxP   (0),
+      m_factors(),
+      m_tw     ()
+    {
+      if (UNLIKELY(a_n < 1))
+        throw std::invalid_argument("FFT: Invalid Size");
+
+      for (int k = a_n, p = 2; k > 1; )
+      {
+        if (p * p > k)
+          p = k;        // "k" is a prime
+        if (k % p == 0)
+        {
+          k /= p;
+          if (p > 2)
+            m_maxP = std::max(m_maxP, p);
+          m_factors.push_back(p);
+          m_factors.push_back(k);
+        }
+        else
+          ++p;
+      }
+      if (a_n == 1)
+      {
+        m_factors.push_back(1);
+        m_factors.push_back(1);
+      }
+      m_tw.resize(size_t(a_n));
+      for (int k = 0; k < a_n; ++k)
+      {
+        double phi = 2.0 * Pi<double> * double(k) / double(a_n);
+        m_tw[size_t(k)] = Complex(Cos(phi), Sin(phi));
+      }
+    }
+
+    int Size() const { return m_n; }
+
+    // The min size of the "a_scratch" buffer to be passed to "Backward" (0 if
+    // the size is a power of 2):
+    int ScratchSize() const { return m_maxP; }
+
+    //=======================================================================//
+    // "Backward": The Un-Normalised Inverse Transform:                      //
+    //=======================================================================//
+    //   a_out[j] = Sum_{k=0}^{n-1} a_in[k] * exp(+2*Pi*i*j*k/n),
+    // ie the synthesis of a trig polynomial from its coeffs at the points
+    // 2*Pi*j/n. "a_in" and "a_out" must not overlap; "a_scratch" must hold at
+    // least "ScratchSize()" elements (it is typically allocated once per
+    // thread, along with "a_out"):
+    //
+    void Backward
+      (Complex const* a_in, Complex* a_out, Complex* a_scratch) const
+    {
+      assert(a_in != nullptr && a_out != nullptr && a_in != a_out &&
+            (a_scratch != nullptr || m_maxP == 0));
+      Work(a_out, a_in, 1, m_factors.data(), a_scratch);
+    }
+
+  private:
+    //=======================================================================//
+    // "Work": Recursive Step:                                               //
+    //=======================================================================//
+    // The output of size p*m is composed of "p" sub-transforms of size "m" of
+    // the decimated input (with the stride "a_fstride * p"), which are then
+    // combined by the butterflies:
+    //
+    void Work
+    (
+      Complex*       a_out,
+      Complex const* a_in,
+      size_t         a_fstride,
+      int const*     a_factors,
+      Complex*       a_scratch
+    )
+    const
+    {
+      int const p   = a_factors[0];
+      int const m   = a_factors[1];
+      Complex*  end = a_out + p * m;
+
+      if (m == 1)
+        for (Complex* out = a_out; out != end; ++out, a_in += a_fstride)
+          *out = *a_in;
+      else
+        for (Complex* out = a_out; out != end; out += m, a_in += a_fstride)
+          Work(out, a_in, a_fstride * size_t(p), a_factors + 2, a_scratch);
+
+      if (p == 2)
+        Butterfly2 (a_out, a_fstride, m);
+      else
+      if (p > 1)
+        ButterflyP(a_out, a_fstride, m, p, a_scratch);
+    }
+
+    //-----------------------------------------------------------------------//
+    // "Butterfly2":                                                         //
+    //-----------------------------------------------------------------------//
+    void Butterfly2(Complex* a_out, size_t a_fstride, int a_m) const
+    {
+      Complex const* tw = m_tw.data();
+      for (int u = 0; u < a_m; ++u)
+      {
+        Complex t     = a_out[u + a_m] * tw[size_t(u) * a_fstride];
+        a_out[u + a_m] = a_out[u] - t;
+        a_out[u]      += t;
+      }
+    }
+
+    //-----------------------------------------------------------------------//
+    // "ButterflyP": Generic Radix "p":                                      //
+    //-----------------------------------------------------------------------//
+    void ButterflyP
+      (Complex* a_out, size_t a_fstride, int a_m, int a_p, Complex* a_scratch)
+    const
+    {
+      Complex const* tw      = m_tw.data();
+      size_t  const  n       = size_t(m_n);
+      Complex*       scratch = a_scratch;
+
+      for (int u = 0; u < a_m; ++u)
+      {
+        for (int q = 0; q < a_p; ++q)
+          scratch[size_t(q)] = a_out[u + q * a_m];
+
+        for (int q1 = 0; q1 < a_p; ++q1)
+        {
+          // NB: a_fstride * k < n, so a single subtraction keeps the twiddle
+          // index in range:
+          size_t const k   = size_t(u + q1 * a_m);
+          size_t       idx = 0;
+          Complex      sum = scratch[0];
+          for (int q = 1; q < a_p; ++q)
+          {
+            idx += a_fstride * k;
+            if (idx >= n)
+              idx -= n;
+            sum += scratch[size_t(q)] * tw[idx];
+          }
+          a_out[k] = sum;
+        }
+      }
+    }
+  };
+}
+// End namespace SpaceBallistics
@@ -0,0 +1,256 @@
+// vim:ts=2:et
+//===========================================================================//
+//                    "SpaceBallistics/ODE/Ensemble.hpp":                    //
+//         Parallel Propagation of Ensembles of Independent Trajectories     //
+//===========================================================================//
+#pragma once
+#include "SpaceBallistics/ODE/RungeKutta.hpp"
+#include "SpaceBallistics/ODE/Events.hpp"
+#include "SpaceBallistics/ThreadPool.hpp"
+#include <algorithm>
+#include <cassert>
+#include <exception>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace SpaceBallistics
+{
+  //=========================================================================//
+  // Ensemble Cases and Results:                                             //
+  //=========================================================================//
+  // Each case is an initial state, an end time, and the force model settings
+  // (ie the RHS object, eg with the max degree of the gravity field), which
+  // may differ between the cases:
+  //
+  template<typename COS, typename RHS>
+  struct EnsembleCase
+  {
+    Time      m_t0;
+    PosV<COS> m_r0;
+    VelV<COS> m_v0;
+    Time      m_tEnd;
+    RHS       m_rhs;
+  };
+
+  enum class EnsembleOutcome
+  {
+    Completed,  // "m_tEnd" has been reached
+    Event,      // The terminal event has occurred before "m_tEnd"
+    Exception   // Thrown by the RHS (eg "ImpactExn") or the integrator
+  };
+
+  template<typename COS>
+  struct EnsembleResult
+  {
+    size_t             m_index;     // Of the case in the input vector
+    EnsembleOutcome    m_outcome;
+    Time               m_t;         // The final state (on "Exception",  the
+    PosV<COS>          m_r;         //   last accepted one)
+    VelV<COS>          m_v;
+    long               m_nSteps;    // For this trajectory only
+    long               m_nRHS;      //
+    std::exception_ptr m_exn;       // On "Exception" only
+  };
+
+  //=========================================================================//
+  // "Ensemble":                                                             //
+  //=========================================================================//
+  // Propagates the cases over a "ThreadPool" (one case per job; the pool's
+  // work stealing balances the load, as the trajectory lengths may vary by
+  // orders of magnitude due to impacts and early termination). Each worker
+  // thread has its own integrator, created on first use and re-used (via
+  // "Reset") for all cases it runs; the RHS should use the per-thread work-
+  // spaces (eg "GravityField::ThisThread()"), so the workers share no muta-
+  // ble state.
+  // Each result is passed to the sink as soon as its trajectory is done, as
+  //   a_sink(int a_worker, EnsembleResult<COS> const&),
+  // where "a_worker" is the "ThreadPool::WorkerIndex()" of the caller:  the
+  // calls with different "a_worker"s may be concurrent, those with the same
+  // one are not, so the sink needs no locks if it keeps per-worker state (see
+  // "EnsembleCollector" below). If the sink throws, the 1st exception is re-
+  // thrown by "Run" after all cases are done.
+  // The results are bitwise independent of the scheduling and the number of
+  // threads:
+  //
+  template
+  <
+    typename COS,
+    typename RHS,
+    RKMethod Method = RKMethod::DOP853,
+    typename G      = NoEvent
+  >
+  class Ensemble
+  {
+  public:
+    using Case       = EnsembleCase  <COS, RHS>;
+    using Result     = EnsembleResult<COS>;
+    using Integrator = RKIntegrator  <Method, COS, RHS>;
+
+  private:
+    //=======================================================================//
+    // Data Flds:                                                            //
+    //=======================================================================//
+    ThreadPool*  m_pool;
+    double       m_relTol;
+    Len          m_absTolR;
+    Vel          m_absTolV;
+    Time         m_h0;
+    Time         m_hMax;
+    G            m_g;           // The terminal event (if any)
+    EventDir     m_dir;
+
+    // The per-worker integrators, each in its own cache line(s):
+    struct alignas(64) Slot
+    {
+      std::optional<Integrator> m_ode;
+    };
+    std::vector<Slot> m_slots;
+
+  public:
+    //=======================================================================//
+    // Non-Default Ctor:                                                     //
+    //=======================================================================//
+    // The tolerances and the step sizes are as for "RKIntegrator", the same
+    // for all cases. If "G" is not "NoEvent", each trajectory is terminated
+    // at the 1st occurrence of the event "a_g" in the direction "a_dir" (see
+    // "Events.hpp"). "a_pool" must outlive the "Ensemble":
+    //
+    Ensemble
+    (
+      ThreadPool& a_pool,
+      double      a_rel_tol,
+      Len         a_abs_tol_pos,
+      Vel         a_abs_tol_vel,
+      Time        a_h0    = Time(0.0),
+      Time        a_h_max = Time(0.0),
+      G const&    a_g     = G(),
+      EventDir    a_dir   = EventDir::Any
+    )
+    : m_pool   (&a_pool),
+      m_relTol (a_rel_tol),
+      m_absTolR(a_abs_tol_pos),
+      m_absTolV(a_abs_tol_vel),
+      m_h0     (a_h0),
+      m_hMax   (a_h_max),
+      m_g      (a_g),
+      m_dir    (a_dir),
+      m_slots  (size_t(a_pool.NThreads()))
+    {}
+
+    //=======================================================================//
+    // "Run":                                                                //
+    //=======================================================================//
+    template<typename Sink>
+    void Run(std::vector<Case> const& a_cases, Sink& a_sink)
+    {
+      if (UNLIKELY(a_cases.size() > size_t(std::numeric_limits<int>::max())))
+        throw std::invalid_argument("Ensemble::Run: Too many cases");
+
+      m_pool->ParallelFor
+      (
+        int(a_cases.size()),
+        [&](int a_i) -> void
+        {
+          int const w = ThreadPool::WorkerIndex();
+          assert(0 <= w && size_t(w) < m_slots.size());
+          Result const res = RunCase(&m_slots[size_t(w)], a_cases, a_i);
+          a_sink(w, res);
+        }
+      );
+    }
+
+  private:
+    //=======================================================================//
+    // "RunCase": Propagates a single case on the given worker's integrator: //
+    //=======================================================================//
+    Result RunCase(Slot* a_slot, std::vector<Case> const& a_cases, int a_i)
+    {
+      assert(a_slot != nullptr);
+      Case const& c = a_cases[size_t(a_i)];
+
+      if (!a_slot->m_ode.has_value())
+        a_slot->m_ode.emplace(c.m_rhs, c.m_t0, c.m_r0, c.m_v0,
+                              m_relTol, m_absTolR, m_absTolV, m_h0, m_hMax);
+      else
+      {
+        a_slot->m_ode->GetRHS() = c.m_rhs;
+        a_slot->m_ode->Reset(c.m_t0, c.m_r0, c.m_v0, m_h0);
+      }
+      Integrator& ode    = *(a_slot->m_ode);
+      long const  steps0 = ode.NSteps();
+      long const  rhs0   = ode.NRHSCalls();
+
+      Result res
+      {
+        size_t(a_i), EnsembleOutcome::Completed, c.m_t0, c.m_r0, c.m_v0,
+        0, 0, nullptr
+      };
+      try
+      {
+        if constexpr (std::is_same_v<G, NoEvent>)
+          ode.Propagate(c.m_tEnd);
+        else
+        {
+          Time te(0.0);
+          if (PropagateToEvent(&ode, c.m_tEnd, m_g, m_dir, &te))
+            res.m_outcome = EnsembleOutcome::Event;
+        }
+      }
+      catch (...)
+      {
+        res.m_outcome = EnsembleOutcome::Exception;
+        res.m_exn     = std::current_exception();
+      }
+      res.m_t      = ode.GetTime();
+      res.m_r      = ode.GetPos();
+      res.m_v      = ode.GetVel();
+      res.m_nSteps = ode.NSteps()    - steps0;
+      res.m_nRHS   = ode.NRHSCalls() - rhs0;
+      return res;
+    }
+  };
+
+  //=========================================================================//
+  // "EnsembleCollector": A Lock-Free Sink which Keeps All Results:          //
+  //=========================================================================//
+  // The results are appended to per-worker buffers;  "Results()" (to be in-
+  // voked after "Ensemble::Run") merges them in the order of the cases:
+  //
+  template<typename COS>
+  class EnsembleCollector
+  {
+  private:
+    struct alignas(64) Buff
+    {
+      std::vector<EnsembleResult<COS>> m_res;
+    };
+    std::vector<Buff> m_buffs;
+
+  public:
+    explicit EnsembleCollector(ThreadPool const& a_pool)
+    : m_buffs(size_t(a_pool.NThreads()))
+    {}
+
+    void operator()(int a_worker, EnsembleResult<COS> const& a_res)
+    {
+      assert(0 <= a_worker && size_t(a_worker) < m_buffs.size());
+      m_buffs[size_t(a_worker)].m_res.push_back(a_res);
+    }
+
+    std::vector<EnsembleResult<COS>> Results() const
+    {
+      std::vector<EnsembleResult<COS>> res;
+      for (Buff const& b: m_buffs)
+        res.insert(res.end(), b.m_res.cbegin(), b.m_res.cend());
+      std::sort(res.begin(), res.end(),
+                [](EnsembleResult<COS> const& a_l,
+                   EnsembleResult<COS> const& a_r)
+                { return a_l.m_index < a_r.m_index; });
+      return res;
+    }
+  };
+}
+// End namespace SpaceBallistics
@@ -0,0 +1,319 @@
+// vim:ts=2:et
+//===========================================================================//
+//                     "SpaceBallistics/ODE/Events.hpp":                     //
+//        Event Detection using the Dense Output of the RK Integrators       //
+//===========================================================================//
+#pragma once
+#include "SpaceBallistics/ODE/RungeKutta.hpp"
+#include <algorithm>
+#include <cassert>
+
+namespace SpaceBallistics
+{
+  //=========================================================================//
+  // Event Functions:                                                        //
+  //=========================================================================//
+  // An event is a zero crossing of a scalar function "g(t, r, v)" (returning
+  // "double", in any consistent units), in the direction specified by
+  // "EventDir".  The following common events are provided (and "TerrainEvent"
+  // in "TerrainModel.h"); any other functor with the same signature can be
+  // used as well:
+  //
+  enum class EventDir
+  {
+    Any,
+    Rising,     // g goes from < 0 to >= 0
+    Falling     // g goes from > 0 to <= 0
+  };
+
+  //-------------------------------------------------------------------------//
+  // "AltitudeEvent": |r| - R (in m):                                        //
+  //-------------------------------------------------------------------------//
+  // "Falling" is an impact on (or a descent through) the sphere of radius R:
+  //
+  template<typename COS>
+  struct AltitudeEvent
+  {
+    Len m_R;
+
+    double operator()(Time, PosV<COS> const& a_r, VelV<COS> const&) const
+    {
+      Len const r = SqRt(Sqr(a_r[0]) + Sqr(a_r[1]) + Sqr(a_r[2]));
+      return (r - m_R).Magnitude();
+    }
+  };
+
+  //-------------------------------------------------------------------------//
+  // "RadialVelEvent": r . v (in m^2/sec):                                   //
+  //-------------------------------------------------------------------------//
+  // "Rising" is a periapsis, "Falling" is an apoapsis:
+  //
+  template<typename COS>
+  struct RadialVelEvent
+  {
+    double operator()
+      (Time, PosV<COS> const& a_r, VelV<COS> const& a_v) const
+    {
+      return (a_r[0] * a_v[0] + a_r[1] * a_v[1] + a_r[2] * a_v[2])
+             .Magnitude();
+    }
+  };
+
+  //-------------------------------------------------------------------------//
+  // "NodeEvent": z (in m):                                                  //
+  //-------------------------------------------------------------------------//
+  // "Rising" is the ascending node, "Falling" is the descending one  (wrt the
+  // equatorial plane of the COS):
+  //
+  template<typename COS>
+  struct NodeEvent
+  {
+    double operator()(Time, PosV<COS> const& a_r, VelV<COS> const&) const
+      { return a_r[2].Magnitude(); }
+  };
+
+  // The event functor type which means "no terminal event" (for the propaga-
+  // tors which take an optional one, eg "Ensemble"):
+  struct NoEvent {};
+
+  //-------------------------------------------------------------------------//
+  // "EventTimeTol": Tolerance of the Event Times over [a_t0, a_t1]:         //
+  //-------------------------------------------------------------------------//
+  inline Time EventTimeTol(Time a_t0, Time a_t1)
+  {
+    return std::max(Time(1e-9),
+                    4.0 * Eps<double> * std::max(Abs(a_t0), Abs(a_t1)));
+  }
+
+  //-------------------------------------------------------------------------//
+  // "IsEventCrossing": Do "g0" -> "g1" Cross 0 in the Direction "a_dir"?    //
+  //-------------------------------------------------------------------------//
+  inline bool IsEventCrossing(double a_g0, double a_g1, EventDir a_dir)
+  {
+    bool const rising  = a_g0 <  0.0 && a_g1 >= 0.0;
+    bool const falling = a_g0 >  0.0 && a_g1 <= 0.0;
+    return (rising  && a_dir != EventDir::Falling) ||
+           (falling && a_dir != EventDir::Rising);
+  }
+
+  //-------------------------------------------------------------------------//
+  // "IllinoisRoot":                                                         //
+  //-------------------------------------------------------------------------//
+  // The root of "a_g(t)" between "a_t0" and "a_t1" (where its values "a_g0"
+  // and "a_g1" must be of opposite signs, or "a_g1" = 0), to within "Event-
+  // TimeTol",  by the Illinois variant of Regula Falsi: the retained end-point
+  // value is halved if the same end is retained twice in a row,  which guar-
+  // antees super-linear convergence:
+  //
+  template<typename F>
+  Time IllinoisRoot(Time a_t0, double a_g0, Time a_t1, double a_g1,
+                    F const& a_g)
+  {
+    if (a_g1 == 0.0)
+      return a_t1;
+
+    Time const tTol = EventTimeTol(a_t0, a_t1);
+    int  side = 0;
+    Time t    = a_t1;
+    for (int it = 0; it < 100 && Abs(a_t1 - a_t0) > tTol; ++it)
+    {
+      t = (a_g1 * a_t0 - a_g0 * a_t1) / (a_g1 - a_g0);
+      double const g = a_g(t);
+
+      if (g == 0.0)
+        break;
+      if ((g < 0.0) == (a_g0 < 0.0))
+      {
+        a_t0 = t;
+        a_g0 = g;
+        if (side == -1)
+          a_g1 *= 0.5;
+        side = -1;
+      }
+      else
+      {
+        a_t1 = t;
+        a_g1 = g;
+        if (side == +1)
+          a_g0 *= 0.5;
+        side = +1;
+      }
+    }
+    return t;
+  }
+
+  //=========================================================================//
+  // "LocateEvent":                                                          //
+  //=========================================================================//
+  // Checks whether the event "a_g" occurs within the last step of "a_ode" (as
+  // given by the signs of "g" at the ends of the step, so an even number of
+  // crossings within one step is not detected; the step size control normal-
+  // ly makes the steps short enough for that not to matter). If so, returns
+  // "true" and the time of the 1st crossing in "a_te",  located by "Illinois-
+  // Root" on the dense output (see "RKIntegrator::DenseState"; only then, its
+  // extra RHS calls, if any, are made), to within ~1 nsec:
+  //
+  template<RKMethod Method, typename COS, typename RHS, typename G>
+  bool LocateEvent
+  (
+    RKIntegrator<Method, COS, RHS>* a_ode,
+    G const&                        a_g,
+    EventDir                        a_dir,
+    Time*                           a_te
+  )
+  {
+    assert(a_ode != nullptr && a_te != nullptr);
+    if (!a_ode->HasStep())
+      return false;
+
+    // The ends of the step (the values there are exact, not interpolated):
+    Time   const t0 = a_ode->LastStepStart();
+    Time   const t1 = a_ode->GetTime();
+    double const g0 =
+      a_g(t0, a_ode->GetPrevPos(), a_ode->GetPrevVel());
+    double const g1 = a_g(t1, a_ode->GetPos(),     a_ode->GetVel());
+
+    if (!IsEventCrossing(g0, g1, a_dir))
+      return false;
+
+    PosV<COS> r;
+    VelV<COS> v;
+    *a_te = IllinoisRoot
+    (
+      t0, g0, t1, g1,
+      [&](Time a_t) -> double
+      {
+        a_ode->DenseState(a_t, &r, &v);
+        return a_g(a_t, r, v);
+      }
+    );
+    return true;
+  }
+
+  //=========================================================================//
+  // "StopAtEvent":                                                          //
+  //=========================================================================//
+  // Stops "a_ode" at the event located by "LocateEvent" at "*a_te", by
+  // "StopAt". For DOP853, the event time is then final: its dense output is
+  // of the same order as the method, so the event is located on the states
+  // which "StopAt" would produce anyway, and "a_refine" is ignored.
+  // For the other methods, the dense output (Hermite) is less accurate than
+  // the method itself for large steps; so if "a_refine" is set (by default),
+  // the event time is refined by the secant method on the states computed by
+  // "StopAt" (each iteration costing one more step); otherwise, the event
+  // time is retained as is (but the state is still that of the method, not
+  // of the dense output, so the subsequent propagation does not accumulate
+  // the dense output errors). On return, "a_ode" is at "*a_te":
+  //
+  template<RKMethod Method, typename COS, typename RHS, typename G>
+  void StopAtEvent
+  (
+    RKIntegrator<Method, COS, RHS>* a_ode,
+    G const&                        a_g,
+    Time*                           a_te,
+    bool                            a_refine = !RKTableau<Method>::Dense
+  )
+  {
+    assert(a_ode != nullptr && a_te != nullptr);
+    if (RKTableau<Method>::Dense || !a_refine)
+    {
+      a_ode->StopAt(*a_te);
+      return;
+    }
+    Time const tA   = a_ode->LastStepStart();
+    Time const tB   = a_ode->GetTime();
+    Time const tTol = EventTimeTol(tA, tB);
+
+    Time   t0 = *a_te;
+    a_ode->StopAt(t0);
+    double g0 = a_g(t0, a_ode->GetPos(), a_ode->GetVel());
+    if (g0 == 0.0)
+      return;
+
+    // The 2nd initial point is a small fraction of the step away, towards the
+    // interior of the step:
+    Time const d  = 1e-4 * (tB - tA);
+    Time       t1 = (Abs(tB - t0) > Abs(d)) ? (t0 + d) : (t0 - d);
+    a_ode->StopAt(t1);
+    double g1 = a_g(t1, a_ode->GetPos(), a_ode->GetVel());
+
+    for (int it = 0; it < 10 && g1 != 0.0 && g1 != g0; ++it)
+    {
+      Time t2 = t1 - g1 * (t1 - t0) / (g1 - g0);
+      // Stay within the step:
+      if (IsPos(tB - tA))
+        t2 = std::min(std::max(t2, tA), tB);
+      else
+        t2 = std::max(std::min(t2, tA), tB);
+
+      bool const conv = Abs(t2 - t1) <= tTol;
+      t0 = t1;
+      g0 = g1;
+      t1 = t2;
+      a_ode->StopAt(t1);
+      g1 = a_g(t1, a_ode->GetPos(), a_ode->GetVel());
+      if (conv)
+        break;
+    }
+    // "a_ode" is now at "t1":
+    *a_te = t1;
+  }
+
+  //=========================================================================//
+  // "PropagateToEvent":                                                     //
+  //=========================================================================//
+  // Propagates "a_ode" up to "a_t_end" or up to the 1st occurrence of the
+  // event "a_g" before that, whichever comes first. In the latter case,  the
+  // integrator is stopped exactly at the event (see "StopAtEvent"), its time
+  // is returned in "a_te", and the return value is "true".  An event at the
+  // initial time (eg if the integrator has already been stopped at it) is
+  // ignored, so the subsequent ones can be found by repeated calls  (as the
+  // sign of "g" right at the event is arbitrary, the window ignored is 1e-6
+  // of the 1st step, or 1e-4 of it if the event time was located on the
+  // Hermite dense output only, to cover its error):
+  // NB: The RHS is evaluated on the whole last step, ie possibly beyond the
+  // event, so it must remain valid (not throw) across the event surface. In
+  // particular, "GravityField" throws "ImpactExn" at r <= its impact radius
+  // (Re by default). For impact detection, use a "TerrainEvent" (rather than
+  // an "AltitudeEvent" with a fixed R > Re, which ignores the actual terrain),
+  // with the impact radius lowered to "TerrainModel::MinRadius()", so that
+  // "ImpactExn" is only a backstop.
+  // "a_refine" is passed to "StopAtEvent" (by default, the event time is as
+  // accurate as the method in all cases):
+  //
+  template<RKMethod Method, typename COS, typename RHS, typename G>
+  bool PropagateToEvent
+  (
+    RKIntegrator<Method, COS, RHS>* a_ode,
+    Time                            a_t_end,
+    G const&                        a_g,
+    EventDir                        a_dir,
+    Time*                           a_te,
+    bool                            a_refine = !RKTableau<Method>::Dense
+  )
+  {
+    assert(a_ode != nullptr && a_te != nullptr);
+    Time const tStart = a_ode->GetTime();
+    if (tStart == a_t_end)
+      return false;
+
+    double const win =
+      (RKTableau<Method>::Dense || a_refine) ? 1e-6 : 1e-4;
+    for (bool first = true; ; first = false)
+    {
+      bool const last = a_ode->Step(a_t_end);
+      if (LocateEvent(a_ode, a_g, a_dir, a_te) &&
+          !(first &&
+            Abs(*a_te - tStart) <=
+            std::max(EventTimeTol(tStart, *a_te),
+                     win * Abs(a_ode->GetTime() - tStart))))
+      {
+        StopAtEvent(a_ode, a_g, a_te, a_refine);
+        return true;
+      }
+      if (last)
+        return false;
+    }
+  }
+}
+// End namespace SpaceBallistics
@@ -0,0 +1,497 @@
+// vim:ts=2:et
+//===========================================================================//
+//                  "SpaceBallistics/ODE/GaussJackson.hpp":                  //
+//      Gauss-Jackson (Summed Stormer-Cowell) 8th-Order Multistep Method     //
+//===========================================================================//
+#pragma once
+#include "SpaceBallistics/ODE/RungeKutta.hpp"
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace SpaceBallistics
+{
+  //=========================================================================//
+  // "GaussJackson":                                                         //
+  //=========================================================================//
+  // Fixed-step predictor-corrector for r'' = acc(t, r, v), in the ordinate
+  // form of M.M. Berry, L.M. Healy, "Implementation of Gauss-Jackson Integ-
+  // ration for Orbit Propagation", J. Astronaut. Sci. 52(3), 2004: the posi-
+  // tion and velocity are obtained from the running 2nd and 1st sums of the
+  // accelerations (which keeps the round-off errors from growing) plus the
+  // weighted accelerations over a window of the last 9 steps.    After the
+  // start-up, each step costs one RHS evaluation at the predicted state, and
+  // more only if the corrector has not converged within the tolerance; for
+  // the expensive RHS (eg the high-degree gravity fields) over long runs,
+  // this is several times cheaper than RK methods of the same order.
+  // The same RHS functors as for "RKIntegrator" are used.  The start-up (and
+  // any re-start) is performed by "DOP853" with the given tolerances, BACK-
+  // WARDS over 8 steps from the current state,  so the RHS is never evaluat-
+  // ed beyond the end time, but it must be valid over those 8 steps in the
+  // past. The end times which are not on the step grid are reached by DOP853
+  // from the last grid point, without abandoning the grid, so the output
+  // times need not be multiples of the step. If the corrector fails to con-
+  // verge, the step is halved and the method re-started from the last grid
+  // point:
+  //
+  template<typename COS, typename RHS>
+  class GaussJackson
+  {
+  public:
+    constexpr static int NW = 9;        // Window size; the order is NW-1
+
+  private:
+    //=======================================================================//
+    // The Coeffs:                                                           //
+    //=======================================================================//
+    // With the 1st and 2nd sums of the accelerations (in the units of "h"):
+    //   s(n+1) = s(n) + (a(n) + a(n+1)) / 2,
+    //   S(n+1) = S(n) + (s(n) + s(n+1)) / 2,
+    // and the window a(n-8) .. a(n), the state at the step "n" is
+    //   v(n) = h   * (s(n) + Sum(WV[i] * a(n-8+i))),
+    //   r(n) = h^2 * (S(n) + Sum(WR[i] * a(n-8+i))),
+    // where WV and WR are the Euler-Maclaurin corrections of the trapezoidal
+    // sums, applied to the degree-8 interpolant of the window; they are exact
+    // if "a" is a polynomial of degree <= 8 in "t". This is used to initial-
+    // ise the sums after the start-up, and (with a(n+1) added to the window)
+    // as the corrector. The predictor extrapolates the window to n+1; its
+    // weights "PV", "PR" include all terms of the sums' updates:
+    //   v(n+1) = h   * (s(n)        + Sum(PV[i] * a(n-8+i))),
+    //   r(n+1) = h^2 * (S(n) + s(n) + Sum(PR[i] * a(n-8+i))):
+    //
+    constexpr static double WV[NW]
+    {
+         -8183.0 / 1036800.0,
+        263077.0 / 3628800.0,
+        -24019.0 /   80640.0,
+       2616161.0 / 3628800.0,
+         -6467.0 /    5670.0,
+        500327.0 /  403200.0,
+      -3498217.0 / 3628800.0,
+        427487.0 /  725760.0,
+        -19087.0 /   89600.0
+    };
+
+    constexpr static double WR[NW]
+    {
+        -12863.0 /  6220800.0,
+         29389.0 /  1555200.0,
+       -839261.0 / 10886400.0,
+       2010157.0 / 10886400.0,
+       -250099.0 /   870912.0,
+       3294229.0 / 10886400.0,
+      -2373173.0 / 10886400.0,
+       1093411.0 / 10886400.0,
+      -1175279.0 /  6220800.0
+    };
+
+    constexpr static double PV[NW]
+    {
+          25713.0 /   89600.0,
+       -9401029.0 / 3628800.0,
+        5393233.0 /  518400.0,
+       -9839609.0 /  403200.0,
+         167287.0 /    4536.0,
+     -135352319.0 / 3628800.0,
+       10219841.0 /  403200.0,
+      -40987771.0 / 3628800.0,
+        3806921.0 / 1036800.0
+    };
+
+    constexpr static double PR[NW]
+    {
+         379921.0 /  6220800.0,
+        -429019.0 /   777600.0,
+        1724339.0 /   777600.0,
+       -1771489.0 /   340200.0,
+        6862619.0 /   870912.0,
+      -43449409.0 /  5443200.0,
+        7392827.0 /  1360800.0,
+       -6577049.0 /  2721600.0,
+       39195067.0 / 43545600.0
+    };
+
+    //=======================================================================//
+    // "RefRHS": Passes the RHS by reference to the Start-Up Integrator:     //
+    //=======================================================================//
+    struct RefRHS
+    {
+      RHS* m_rhs;
+
+      void operator()
+      (
+        Time             a_t,
+        PosV<COS> const& a_r,
+        VelV<COS> const& a_v,
+        AccV<COS>*       a_acc
+      )
+      const
+      { (*m_rhs)(a_t, a_r, a_v, a_acc); }
+    };
+    using StartUp = DOP853<COS, RefRHS>;
+
+    //=======================================================================//
+    // Data Flds:                                                            //
+    //=======================================================================//
+    RHS          m_rhs;
+    double       m_relTol;
+    Len          m_absTolR;
+    Vel          m_absTolV;
+    int          m_maxIters;    // Max number of corrector iterations
+    Time         m_h;           // Step size (> 0)
+
+    // The current state (on or off the grid):
+    Time         m_t;
+    PosV<COS>    m_r;
+    VelV<COS>    m_v;
+
+    // If "m_started": the grid is "m_tS" + "m_n" * "m_hS" ("m_hS" is signed),
+    // the last grid point is ("m_tG", "m_rG", "m_vG"), "m_a" is the window of
+    // the accelerations at the last "NW" grid points, and "m_s1" and "m_s2"
+    // are the sums:
+    bool         m_started;
+    Time         m_tS;
+    Time         m_hS;
+    long         m_n;
+    Time         m_tG;
+    PosV<COS>    m_rG;
+    VelV<COS>    m_vG;
+    AccV<COS>    m_a[NW];
+    AccV<COS>    m_s1;
+    AccV<COS>    m_s2;
+
+    // Statistics:
+    long         m_nSteps;
+    long         m_nStarts;
+    long         m_nRHS;
+
+  public:
+    //=======================================================================//
+    // Non-Default Ctor:                                                     //
+    //=======================================================================//
+    // "a_h" is the step size (its sign is irrelevant). The tolerances are
+    // those of the start-up integrator, and of the corrector convergence.
+    // Throws "std::invalid_argument" for invalid params:
+    //
+    GaussJackson
+    (
+      RHS const&       a_rhs,
+      Time             a_t0,
+      PosV<COS> const& a_r0,
+      VelV<COS> const& a_v0,
+      Time             a_h,
+      double           a_rel_tol,
+      Len              a_abs_tol_pos,
+      Vel              a_abs_tol_vel,
+      int              a_max_iters = 4
+    )
+    : m_rhs      (a_rhs),
+      m_relTol   (a_rel_tol),
+      m_absTolR  (a_abs_tol_pos),
+      m_absTolV  (a_abs_tol_vel),
+      m_maxIters (a_max_iters),
+      m_h        (Abs(a_h)),
+      m_t        (a_t0),
+      m_r        (a_r0),
+      m_v        (a_v0),
+      m_started  (false),
+      m_tS       (a_t0),
+      m_hS       (Abs(a_h)),
+      m_n        (0),
+      m_tG       (a_t0),
+      m_rG       (a_r0),
+      m_vG       (a_v0),
+      m_a        (),
+      m_s1       (),
+      m_s2       (),
+      m_nSteps   (0),
+      m_nStarts  (0),
+      m_nRHS     (0)
+    {
+      if (UNLIKELY(!(a_rel_tol >= 0.0) || IsNeg(a_abs_tol_pos) ||
+                   IsNeg(a_abs_tol_vel)                        ||
+                   (a_rel_tol == 0.0 && (IsZero(a_abs_tol_pos) ||
+                                         IsZero(a_abs_tol_vel)))))
+        throw std::invalid_argument("GaussJackson: Invalid Tolerance(s)");
+      if (UNLIKELY(IsZero(a_h) || a_max_iters < 1))
+        throw std::invalid_argument("GaussJackson: Invalid Step or Iters");
+    }
+
+    //=======================================================================//
+    // "Reset": Starts a New Trajectory (the step size is unchanged):        //
+    //=======================================================================//
+    void Reset(Time a_t0, PosV<COS> const& a_r0, VelV<COS> const& a_v0)
+    {
+      m_t       = a_t0;
+      m_r       = a_r0;
+      m_v       = a_v0;
+      m_started = false;
+    }
+
+    //=======================================================================//
+    // "SetStep": Changes the Step Size (Re-Starts from the Current State):  //
+    //=======================================================================//
+    void SetStep(Time a_h)
+    {
+      if (UNLIKELY(IsZero(a_h)))
+        throw std::invalid_argument("GaussJackson::SetStep: Zero Step");
+      m_h       = Abs(a_h);
+      m_started = false;
+    }
+
+    //=======================================================================//
+    // Accessors:                                                            //
+    //=======================================================================//
+    Time             GetTime()   const { return m_t;       }
+    PosV<COS> const& GetPos()    const { return m_r;       }
+    VelV<COS> const& GetVel()    const { return m_v;       }
+    Time             GetStep()   const { return m_h;       }
+    long             NSteps()    const { return m_nSteps;  }
+    long             NStarts()   const { return m_nStarts; }
+    long             NRHSCalls() const { return m_nRHS;    }
+    RHS&             GetRHS()          { return m_rhs;     }
+
+    //=======================================================================//
+    // "Step": One Step towards "a_t_end":                                   //
+    //=======================================================================//
+    // Never goes beyond "a_t_end"; returns "true" iff it has been reached.
+    // Throws "std::runtime_error" if the step size becomes too small.  The
+    // exceptions thrown by the RHS (eg "ImpactExn") are propagated,  the
+    // state remaining that of the last accepted step:
+    //
+    bool Step(Time a_t_end)
+    {
+      if (m_t == a_t_end)
+        return true;
+
+      // (Re-)Start from the current state if there is no grid yet, or if
+      // "a_t_end" is not ahead of the last grid point:
+      if (!m_started || !IsPos((a_t_end - m_tG) / m_hS))
+        Start(IsPos(a_t_end - m_t) ? m_h : -m_h);
+
+      // The next grid point, possibly snapped to "a_t_end" (to within the
+      // rounding errors); if it is beyond "a_t_end", the latter is off the
+      // grid:
+      Time tn   = m_tS + double(m_n + 1) * m_hS;
+      bool last = false;
+      if (Abs(a_t_end - tn) <= 16.0 * Eps<double> * Abs(a_t_end))
+      {
+        tn   = a_t_end;
+        last = true;
+      }
+      else
+      if (!IsPos((a_t_end - tn) / m_hS))
+      {
+        OffGrid(a_t_end);
+        return true;
+      }
+
+      //---------------------------------------------------------------------//
+      // Predictor:                                                          //
+      //---------------------------------------------------------------------//
+      Time const h = m_hS;
+      PosV<COS>  r;
+      VelV<COS>  v;
+      for (size_t c = 0; c < 3; ++c)
+      {
+        Acc sv = m_s1[c];
+        Acc sr = m_s2[c] + m_s1[c];
+        for (int i = 0; i < NW; ++i)
+        {
+          sv += PV[i] * m_a[i][c];
+          sr += PR[i] * m_a[i][c];
+        }
+        v[c] = h * sv;
+        r[c] = h * h * sr;
+      }
+
+      //---------------------------------------------------------------------//
+      // Corrector Iterations:                                               //
+      //---------------------------------------------------------------------//
+      // The new acceleration is evaluated at the latest estimate, and the
+      // corrected state is accepted as soon as it agrees with that estimate
+      // within the tolerances (so the window and the state are consistent to
+      // within the tolerances):
+      AccV<COS> an;
+      bool      conv = false;
+      for (int it = 0; it < m_maxIters && !conv; ++it)
+      {
+        an = Eval(tn, r, v);
+        double err = 0.0;
+        for (size_t c = 0; c < 3; ++c)
+        {
+          // The window shifted by 1, with "an" added; in the sums, the new
+          // terms are (a(n) + a(n+1)) / 2 and / 4, resp:
+          Acc sv = m_s1[c] + 0.5  * (m_a[NW-1][c] + an[c]);
+          Acc sr = m_s2[c] + m_s1[c] + 0.25 * (m_a[NW-1][c] + an[c]);
+          for (int i = 0; i < NW-1; ++i)
+          {
+            sv += WV[i] * m_a[i+1][c];
+            sr += WR[i] * m_a[i+1][c];
+          }
+          sv += WV[NW-1] * an[c];
+          sr += WR[NW-1] * an[c];
+
+          Vel const vc  = h * sv;
+          Len const rc  = h * h * sr;
+          Len const scR = m_absTolR + m_relTol * Abs(rc);
+          Vel const scV = m_absTolV + m_relTol * Abs(vc);
+          err  = std::max(err, std::max(double(Abs(rc - r[c]) / scR),
+                                        double(Abs(vc - v[c]) / scV)));
+          r[c] = rc;
+          v[c] = vc;
+        }
+        conv = (err <= 1.0);
+      }
+
+      if (UNLIKELY(!conv))
+      {
+        // Halve the step and re-start from the last grid point:
+        if (UNLIKELY(0.5 * m_h <= 16.0 * Eps<double> * Abs(m_tG)))
+          throw std::runtime_error("GaussJackson: Step Size UnderFlow");
+        m_h      *= 0.5;
+        m_t       = m_tG;
+        m_r       = m_rG;
+        m_v       = m_vG;
+        m_started = false;
+        return false;
+      }
+
+      //---------------------------------------------------------------------//
+      // Accept the Step:                                                    //
+      //---------------------------------------------------------------------//
+      for (size_t c = 0; c < 3; ++c)
+      {
+        Acc const s1n = m_s1[c] + 0.5 * (m_a[NW-1][c] + an[c]);
+        m_s2[c] += 0.5 * (m_s1[c] + s1n);
+        m_s1[c]  = s1n;
+      }
+      for (int i = 0; i < NW-1; ++i)
+        m_a[i] = m_a[i+1];
+      m_a[NW-1] = an;
+
+      ++m_n;
+      ++m_nSteps;
+      m_tG = tn;
+      m_rG = r;
+      m_vG = v;
+      m_t  = tn;
+      m_r  = r;
+      m_v  = v;
+      return last;
+    }
+
+    //=======================================================================//
+    // "Propagate": Up to "a_t_end" exactly:                                 //
+    //=======================================================================//
+    void Propagate(Time a_t_end)
+      { while (!Step(a_t_end)); }
+
+  private:
+    //=======================================================================//
+    // Internal Utils:                                                       //
+    //=======================================================================//
+    //-----------------------------------------------------------------------//
+    // "Eval": The Acceleration at the given point:                          //
+    //-----------------------------------------------------------------------//
+    AccV<COS> Eval(Time a_t, PosV<COS> const& a_r, VelV<COS> const& a_v)
+    {
+      AccV<COS> acc {{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+      m_rhs(a_t, a_r, a_v, &acc);
+      ++m_nRHS;
+      return acc;
+    }
+
+    //-----------------------------------------------------------------------//
+    // "RunRK": Propagates by the Start-Up Integrator:                       //
+    //-----------------------------------------------------------------------//
+    // From ("a_t0", "a_r0", "a_v0") to "a_t1", with the step size <= "m_h";
+    // the RHS calls are accounted for even if an exception is thrown:
+    //
+    void RunRK
+    (
+      Time             a_t0,
+      PosV<COS> const& a_r0,
+      VelV<COS> const& a_v0,
+      Time             a_t1,
+      PosV<COS>*       a_r1,
+      VelV<COS>*       a_v1
+    )
+    {
+      assert(a_r1 != nullptr && a_v1 != nullptr);
+      StartUp rk(RefRHS{&m_rhs}, a_t0, a_r0, a_v0,
+                 m_relTol, m_absTolR, m_absTolV, m_h, m_h);
+      try
+      {
+        rk.Propagate(a_t1);
+      }
+      catch (...)
+      {
+        m_nRHS += rk.NRHSCalls();
+        throw;
+      }
+      m_nRHS += rk.NRHSCalls();
+      *a_r1   = rk.GetPos();
+      *a_v1   = rk.GetVel();
+    }
+
+    //-----------------------------------------------------------------------//
+    // "Start": The Start-Up at the Current State:                           //
+    //-----------------------------------------------------------------------//
+    // The grid step is "a_h" (signed); the window is filled by propagating
+    // backwards over NW-1 steps, and the current state becomes the last grid
+    // point:
+    //
+    void Start(Time a_h)
+    {
+      PosV<COS> r = m_r;
+      VelV<COS> v = m_v;
+      m_a[NW-1]   = Eval(m_t, r, v);
+      for (int i = NW-2; i >= 0; --i)
+      {
+        Time const ti = m_t - double(NW-1 - i) * a_h;
+        RunRK(ti + a_h, r, v, ti, &r, &v);
+        m_a[i] = Eval(ti, r, v);
+      }
+
+      // Initialise the sums at the current point:
+      Time const h = a_h;
+      for (size_t c = 0; c < 3; ++c)
+      {
+        Acc sv = m_v[c] / h;
+        Acc sr = m_r[c] / (h * h);
+        for (int i = 0; i < NW; ++i)
+        {
+          sv -= WV[i] * m_a[i][c];
+          sr -= WR[i] * m_a[i][c];
+        }
+        m_s1[c] = sv;
+        m_s2[c] = sr;
+      }
+      m_tS      = m_t;
+      m_hS      = a_h;
+      m_n       = 0;
+      m_tG      = m_t;
+      m_rG      = m_r;
+      m_vG      = m_v;
+      m_started = true;
+      ++m_nStarts;
+    }
+
+    //-----------------------------------------------------------------------//
+    // "OffGrid": To an Off-Grid "a_t_end" from the Last Grid Point:         //
+    //-----------------------------------------------------------------------//
+    // The grid is retained, so the next "Step" continues from its last point:
+    //
+    void OffGrid(Time a_t_end)
+    {
+      PosV<COS> r;
+      VelV<COS> v;
+      RunRK(m_tG, m_rG, m_vG, a_t_end, &r, &v);
+      m_t = a_t_end;
+      m_r = r;
+      m_v = v;
+    }
+  };
+}
+// End namespace SpaceBallistics
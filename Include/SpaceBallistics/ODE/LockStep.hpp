@@ -0,0 +1,336 @@
+// vim:ts=2:et
+//===========================================================================//
+//                    "SpaceBallistics/ODE/LockStep.hpp":                    //
+//       Lock-Step Integration of Several Trajectories in the SIMD Lanes     //
+//===========================================================================//
+#pragma once
+#include "SpaceBallistics/ODE/RungeKutta.hpp"
+#include "SpaceBallistics/ODE/Events.hpp"
+#include "SpaceBallistics/SIMD.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <stdexcept>
+#include <type_traits>
+
+namespace SpaceBallistics
+{
+  //=========================================================================//
+  // "LockStepRK" Class:                                                     //
+  //=========================================================================//
+  // Propagates up to "NL" independent trajectories (eg neighbouring Monte
+  // Carlo samples) at once, by the same method as "RKIntegrator", with  the
+  // step size shared by all of them: each component of the state is an "NL"-
+  // lane vector (see "LanesV"), so all arithmetic of the step is vectorised
+  // across the trajectories (see "RKStepper"), and so is the RHS, which is
+  // invoked as
+  //   a_rhs(Time t, LanesV<Len, NL> const& r, LanesV<Vel, NL> const& v,
+  //         LanesV<Acc, NL>* acc),
+  // and must ADD the accelerations of all lanes to "*acc" (zeroed before the
+  // call). With NL = 4, the RHS can invoke "GravityField::GravAccBatch" on
+  // the lanes directly, so the model coeffs are loaded once for all 4 traj-
+  // ectories (with NL = 8, "GravAccMixedBatch" processes all 8 lanes at once
+  // if the mixed precision is acceptable).
+  // The step size is controlled by the largest (over the lanes) of the norm-
+  // alised errors of "RKIntegrator", so each trajectory is at least as acc-
+  // urate as if it was propagated alone; but the lanes are then coupled via
+  // the step size, so the results depend (slightly) on which trajectories are
+  // grouped together. If that is undesirable (eg for the bitwise reproduc-
+  // ibility of a Monte Carlo run), a fixed step can be set (see "SetFixed-
+  // Step").
+  // The lanes which are not in use, and those terminated by the event "G"
+  // (if it is not "NoEvent"; the event time and state are located on the
+  // dense output, see "RKStepper::DenseLane"), are frozen: their states are
+  // kept unchanged and excluded from the error control, but they are still
+  // passed to the RHS (whose results for them are discarded), so the RHS must
+  // accept them (eg an "AltitudeEvent" for impact detection must use R > Re,
+  // as for "PropagateToEvent").  The exceptions thrown by the RHS (eg "Impact-
+  // Exn") are propagated to the caller, the state of all lanes remaining that
+  // of the last accepted step.
+  // The object must NOT be shared between threads (but it is small, so each
+  // worker of a "ThreadPool" may have its own, as in "Ensemble"):
+  //
+  template
+  <
+    RKMethod Method,
+    typename COS,
+    typename BRHS,
+    int      NL,
+    typename G = NoEvent
+  >
+  class LockStepRK:
+    public RKStepper<LockStepRK<Method, COS, BRHS, NL, G>, Method, COS,
+                     DoubleLanes<NL>>
+  {
+  public:
+    static_assert(NL == 4 || NL == 8, "LockStepRK: NL must be 4 or 8");
+    using Base = RKStepper<LockStepRK, Method, COS, DoubleLanes<NL>>;
+    using PosL = LanesV<Len, NL>;
+    using VelL = LanesV<Vel, NL>;
+    using AccL = LanesV<Acc, NL>;
+    constexpr static char const Name[] = "LockStepRK";
+
+  private:
+    friend Base;
+    using Base::m_t;
+    using Base::m_r;
+    using Base::m_v;
+    using Base::m_h;
+    using Base::m_hFix;
+    using Base::m_kr;
+    using Base::m_kv;
+    using Base::m_k0Valid;
+    using Base::m_hasStep;
+    using Base::m_tPrev;
+    using Base::m_tLast;
+    using Base::m_rPrev;
+    using Base::m_vPrev;
+    using Base::m_denseOK;
+    using Base::m_nSteps;
+    using Base::m_nRejected;
+    using Base::m_nRHS;
+
+    //=======================================================================//
+    // Data Flds:                                                            //
+    //=======================================================================//
+    constexpr static size_t L = size_t(NL);
+
+    // The lanes of "double"s (magnitudes of the SI values), for masking the
+    // stages (1 or 2 AVX2 registers):
+    using V = DoubleLanes<NL>;
+
+    BRHS         m_rhs;
+    G            m_g;           // The terminal event (if any)
+    EventDir     m_dir;
+
+    // The lanes: "m_live" is 1.0 for the lanes being propagated and 0.0 for
+    // the frozen ones (the stages are multiplied by it, as a "V"); "m_tLane"
+    // is the time of the state of each lane (the event time for the lanes
+    // terminated by the event, "m_t" otherwise):
+    int                   m_nLanes;
+    int                   m_nLive;
+    std::array<double, L> m_live;
+    std::array<bool,   L> m_event;
+    std::array<Time,   L> m_tLane;
+
+  public:
+    //=======================================================================//
+    // Non-Default Ctor:                                                     //
+    //=======================================================================//
+    // The initial states of "a_n" (1 <= a_n <= NL) trajectories are given by
+    // "a_r0" and "a_v0" (arrays of length "a_n");  all trajectories start at
+    // the same time "a_t0". The other params are as for "RKIntegrator";  "a_g"
+    // and "a_dir" are the terminal event. Throws "std::invalid_argument" for
+    // invalid params:
+    //
+    LockStepRK
+    (
+      BRHS const&      a_rhs,
+      Time             a_t0,
+      int              a_n,
+      PosV<COS> const  a_r0[],
+      VelV<COS> const  a_v0[],
+      double           a_rel_tol,
+      Len              a_abs_tol_pos,
+      Vel              a_abs_tol_vel,
+      Time             a_h0    = Time(0.0),
+      Time             a_h_max = Time(0.0),
+      G const&         a_g     = G(),
+      EventDir         a_dir   = EventDir::Any
+    )
+    : Base     (a_t0, a_rel_tol, a_abs_tol_pos, a_abs_tol_vel, a_h0, a_h_max),
+      m_rhs    (a_rhs),
+      m_g      (a_g),
+      m_dir    (a_dir),
+      m_nLanes (0),
+      m_nLive  (0),
+      m_live   (),
+      m_event  (),
+      m_tLane  ()
+    {
+      Reset(a_t0, a_n, a_r0, a_v0, a_h0);
+    }
+
+    //=======================================================================//
+    // "Reset": Starts a New Group of Trajectories:                          //
+    //=======================================================================//
+    // The unused lanes (a_n <= k < NL) replicate the last trajectory, and are
+    // frozen from the start:
+    //
+    void Reset
+    (
+      Time             a_t0,
+      int              a_n,
+      PosV<COS> const  a_r0[],
+      VelV<COS> const  a_v0[],
+      Time             a_h0 = Time(0.0)
+    )
+    {
+      if (UNLIKELY(a_n < 1 || a_n > NL || a_r0 == nullptr ||
+                   a_v0 == nullptr))
+        throw std::invalid_argument("LockStepRK::Reset: Invalid Param(s)");
+
+      for (size_t k = 0; k < L; ++k)
+      {
+        size_t const j = std::min(k, size_t(a_n - 1));
+        for (size_t c = 0; c < 3; ++c)
+        {
+          m_r[c][k] = a_r0[j][c];
+          m_v[c][k] = a_v0[j][c];
+        }
+        m_live [k] = (j == k) ? 1.0 : 0.0;
+        m_event[k] = false;
+        m_tLane[k] = a_t0;
+      }
+      m_t       = a_t0;
+      m_h       = Abs(a_h0);
+      m_k0Valid = false;
+      m_hasStep = false;
+      m_denseOK = false;
+      m_nLanes  = a_n;
+      m_nLive   = a_n;
+      m_tPrev   = a_t0;
+      m_tLast   = a_t0;
+    }
+
+    //=======================================================================//
+    // Accessors:                                                            //
+    //=======================================================================//
+    using Base::GetTime;
+
+    int   NLanes()    const { return m_nLanes;    }
+    int   NLive()     const { return m_nLive;     }
+    BRHS& GetRHS()          { return m_rhs;       }
+
+    // The lanes (0 <= a_k < NLanes()):
+    bool IsLive   (int a_k) const { return m_live [Lane(a_k)] != 0.0; }
+    bool HasEvent (int a_k) const { return m_event[Lane(a_k)];        }
+    Time GetTime  (int a_k) const { return m_tLane[Lane(a_k)];        }
+
+    PosV<COS> GetPos(int a_k) const
+      { return Base::LaneOf(m_r, int(Lane(a_k))); }
+
+    VelV<COS> GetVel(int a_k) const
+      { return Base::LaneOf(m_v, int(Lane(a_k))); }
+
+    //=======================================================================//
+    // "Step": One Accepted Step towards "a_t_end":                          //
+    //=======================================================================//
+    // As "RKIntegrator::Step". Returns "true" iff "a_t_end" has been reached,
+    // or all lanes have been terminated by the event:
+    //
+    bool Step(Time a_t_end)
+    {
+      if (m_t == a_t_end || m_nLive == 0)
+        return true;
+
+      bool const last = Base::DoStep(a_t_end);
+      for (size_t k = 0; k < L; ++k)
+        if (m_live[k] != 0.0)
+          m_tLane[k] = m_t;
+
+      if constexpr (!std::is_same_v<G, NoEvent>)
+        Events();
+      return last || m_nLive == 0;
+    }
+
+    //=======================================================================//
+    // "Propagate": Up to "a_t_end" exactly (or until all Lanes Terminate):  //
+    //=======================================================================//
+    void Propagate(Time a_t_end)
+      { while (!Step(a_t_end)); }
+
+  private:
+    //=======================================================================//
+    // Internal Utils:                                                       //
+    //=======================================================================//
+    size_t Lane(int a_k) const
+    {
+      assert(0 <= a_k && a_k < m_nLanes);
+      return size_t(a_k);
+    }
+
+    //-----------------------------------------------------------------------//
+    // For "RKStepper":                                                      //
+    //-----------------------------------------------------------------------//
+    // The stages of the frozen lanes are zeroed, so their states do not move:
+    //
+    void CallRHS
+    (
+      Time        a_t,
+      PosL const& a_r,
+      VelL const& a_v,
+      VelL*       a_kr,
+      AccL*       a_kv
+    )
+    {
+      m_rhs(a_t, a_r, a_v, a_kv);
+
+      V const live = LoadV<V>(m_live.data());
+      for (size_t c = 0; c < 3; ++c)
+      {
+        StoreV((*a_kr)[c].data(), live * LoadV<V>((*a_kr)[c].data()));
+        StoreV((*a_kv)[c].data(), live * LoadV<V>((*a_kv)[c].data()));
+      }
+    }
+
+    bool IsLiveLane(int a_k) const
+      { return m_live[size_t(a_k)] != 0.0; }
+
+    //-----------------------------------------------------------------------//
+    // "Events": Terminates the Lanes in which the Event Occurred:           //
+    //-----------------------------------------------------------------------//
+    // In each live lane, the event is detected and located over the last step
+    // as in "LocateEvent"; the lane is then set to the (interpolated) state at
+    // the event time, and frozen:
+    //
+    void Events()
+    {
+      for (size_t k = 0; k < L; ++k)
+      {
+        if (m_live[k] == 0.0)
+          continue;
+        double const g0 =
+          m_g(m_tPrev, Base::LaneOf(m_rPrev, int(k)),
+                       Base::LaneOf(m_vPrev, int(k)));
+        double const g1 = m_g(m_t, GetPos(int(k)), GetVel(int(k)));
+        if (!IsEventCrossing(g0, g1, m_dir))
+          continue;
+
+        PosV<COS> r;
+        VelV<COS> v;
+        Time const te = IllinoisRoot
+        (
+          m_tPrev, g0, m_t, g1,
+          [&](Time a_t) -> double
+          {
+            Base::DenseLane(int(k), a_t, &r, &v);
+            return m_g(a_t, r, v);
+          }
+        );
+        Base::DenseLane(int(k), te, &r, &v);
+        for (size_t c = 0; c < 3; ++c)
+        {
+          m_r[c][k]     = r[c];
+          m_v[c][k]     = v[c];
+          m_kr[0][c][k] = Vel(0.0);
+          m_kv[0][c][k] = Acc(0.0);
+        }
+        m_live [k] = 0.0;
+        m_event[k] = true;
+        m_tLane[k] = te;
+        --m_nLive;
+      }
+    }
+  };
+
+  //=========================================================================//
+  // Convenience Aliases:                                                    //
+  //=========================================================================//
+  template<typename COS, typename BRHS, int NL = 4, typename G = NoEvent>
+  using LockStepDOP853 = LockStepRK<RKMethod::DOP853, COS, BRHS, NL, G>;
+
+  template<typename COS, typename BRHS, int NL = 4, typename G = NoEvent>
+  using LockStepRKF78  = LockStepRK<RKMethod::RKF78,  COS, BRHS, NL, G>;
+}
+// End namespace SpaceBallistics
@@ -0,0 +1,1262 @@
+// vim:ts=2:et
+//===========================================================================//
+//                   "SpaceBallistics/ODE/RungeKutta.hpp":                   //
+//     Embedded Runge-Kutta Integrators (DOP853, RKF78) over Typed States    //
+//===========================================================================//
+#pragma once
+#include "SpaceBallistics/Types.hpp"
+#include "SpaceBallistics/SIMD.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace SpaceBallistics
+{
+  //=========================================================================//
+  // "RKMethod": The Available Embedded Pairs:                               //
+  //=========================================================================//
+  enum class RKMethod
+  {
+    DOP853,   // Dormand-Prince 8(5,3) (Hairer's "DOP853"): 12 stages + FSAL
+    RKF78     // Runge-Kutta-Fehlberg 7(8): 13 stages, 8th-order propagation
+  };
+
+  //=========================================================================//
+  // "RKTableau": The Butcher Tableaux:                                      //
+  //=========================================================================//
+  // "NS" stages are used for the solution. The 1st stage of each step (the
+  // derivative at the new point, also needed for the dense output) is evalu-
+  // ated once the previous step has been accepted; "FSAL" only indicates
+  // that the method counts it as the last stage of the previous step (as in
+  // "dop853.f"). "E" are the error estimators (without the factor "h"); their
+  // order is "ErrOrder", so the step size is controlled by the exponent
+  // 1/(ErrOrder+1). "Dense" indicates that the method has its own continuous
+  // extension (see "RKStepper::DenseLane"), which needs "NK" stages in total;
+  // otherwise, the dense output is the quintic Hermite interpolant (see
+  // "QuinticHermite"), and NK = NS:
+  //
+  template<RKMethod Method>
+  struct RKTableau;
+
+  //-------------------------------------------------------------------------//
+  // DOP853:                                                                 //
+  //-------------------------------------------------------------------------//
+  // E. Hairer, S.P. Norsett, G. Wanner, "Solving Ordinary Differential Equ-
+  // ations I", 2nd ed, Springer, 1993, Sect II.10. There are 2 error estima-
+  // tors, of the orders 5 and 3, combined as in "dop853.f":
+  //
+  template<>
+  struct RKTableau<RKMethod::DOP853>
+  {
+    constexpr static int    NS       = 12;
+    constexpr static bool   FSAL     = true;
+    constexpr static int    NE       = 2;
+    constexpr static int    ErrOrder = 7;
+    constexpr static bool   Dense    = true;
+
+    constexpr static double C[NS+1]
+    {
+      0.0,
+      0.526001519587677318785587544488e-01,
+      0.789002279381515978178381316732e-01,
+      0.118350341907227396726757197510,
+      0.281649658092772603273242802490,
+      0.333333333333333333333333333333,
+      0.25,
+      0.307692307692307692307692307692,
+      0.651282051282051282051282051282,
+      0.6,
+      0.857142857142857142857142857142,
+      1.0,
+      1.0
+    };
+
+    constexpr static double A[NS][NS]
+    {
+      { },
+      { 5.26001519587677318785587544488e-2 },
+      { 1.97250569845378994544595329183e-2,
+        5.91751709536136983633785987549e-2 },
+      { 2.95875854768068491816892993775e-2,  0.0,
+        8.87627564304205475450678981324e-2 },
+      { 2.41365134159266685502369798665e-1,  0.0,
+       -8.84549479328286085344864962717e-1,
+        9.24834003261792003115737966543e-1 },
+      { 3.7037037037037037037037037037e-2,   0.0, 0.0,
+        1.70828608729473871279604482173e-1,
+        1.25467687566822425016691814123e-1 },
+      { 3.7109375e-2,                         0.0, 0.0,
+        1.70252211019544039314978060272e-1,
+        6.02165389804559606850219397283e-2,
+       -1.7578125e-2 },
+      { 3.70920001185047927108779319836e-2,  0.0, 0.0,
+        1.70383925712239993810214054705e-1,
+        1.07262030446373284651809199168e-1,
+       -1.53194377486244017527936158236e-2,
+        8.27378916381402288758473766002e-3 },
+      { 6.24110958716075717114429577812e-1,  0.0, 0.0,
+       -3.36089262944694129406857109825,
+       -8.68219346841726006818189891453e-1,
+        2.75920996994467083049415600797e1,
+        2.01540675504778934086186788979e1,
+       -4.34898841810699588477366255144e1 },
+      { 4.77662536438264365890433908527e-1,  0.0, 0.0,
+       -2.48811461997166764192642586468,
+       -5.90290826836842996371446475743e-1,
+        2.12300514481811942347288949897e1,
+        1.52792336328824235832596922938e1,
+       -3.32882109689848629194453265587e1,
+       -2.03312017085086261358222928593e-2 },
+      {-9.3714243008598732571704021658e-1,   0.0, 0.0,
+        5.18637242884406370830023853209,
+        1.09143734899672957818500254654,
+       -8.14978701074692612513997267357,
+       -1.85200656599969598641566180701e1,
+        2.27394870993505042818970056734e1,
+        2.49360555267965238987089396762,
+       -3.0467644718982195003823669022 },
+      { 2.27331014751653820792359768449,     0.0, 0.0,
+       -1.05344954667372501984066689879e1,
+       -2.00087205822486249909675718444,
+       -1.79589318631187989172765950534e1,
+        2.79488845294199600508499808837e1,
+       -2.85899827713502369474065508674,
+       -8.87285693353062954433549289258,
+        1.23605671757943030647266201528e1,
+        6.43392746015763530355970484046e-1 }
+    };
+
+    constexpr static double B[NS]
+    {
+      5.42937341165687622380535766363e-2,    0.0, 0.0, 0.0, 0.0,
+      4.45031289275240888144113950566,
+      1.89151789931450038304281599044,
+     -5.8012039600105847814672114227,
+      3.1116436695781989440891606237e-1,
+     -1.52160949662516078556178806805e-1,
+      2.01365400804030348374776537501e-1,
+      4.47106157277725905176885569043e-2
+    };
+
+    // The 5th-order estimator, and the 3rd-order one (B - BHH):
+    constexpr static double E[NE][NS]
+    {
+      { 0.1312004499419488073250102996e-1,   0.0, 0.0, 0.0, 0.0,
+       -0.1225156446376204440720569753e+1,
+       -0.4957589496572501915214079952,
+        0.1664377182454986536961530415e+1,
+       -0.3503288487499736816886487290,
+        0.3341791187130174790297318841,
+        0.8192320648511571246570742613e-1,
+       -0.2235530786388629525884427845e-1 },
+      { B[0] - 0.244094488188976377952755905512,
+        0.0, 0.0, 0.0, 0.0,
+        B[5], B[6], B[7],
+        B[8] - 0.733846688281611857341361741547,
+        B[9], B[10],
+        B[11] - 0.220588235294117647058823529412e-1 }
+    };
+
+    // The dense output of the order 7 ("contd8" in "dop853.f"): "NK" stages,
+    // of which 0..NS-1 are those of the step, NS is the FSAL one (the deriv-
+    // ative at the end of the step), and the remaining 3 are evaluated only
+    // if the dense output is actually needed, at "CD" and with the coeffs
+    // "AD" (over all previous stages). "D" are the coeffs of the 4 highest-
+    // order terms of the interpolant:
+    constexpr static int    NK       = 16;
+
+    constexpr static double CD[NK-NS-1]
+    {
+      0.1,
+      0.2,
+      0.777777777777777777777777777778
+    };
+
+    constexpr static double AD[NK-NS-1][NK]
+    {
+      { 5.61675022830479523392909219681e-2,  0.0, 0.0, 0.0, 0.0, 0.0,
+        2.53500210216624811088794765333e-1,
+       -2.46239037470802489917441475441e-1,
+       -1.24191423263816360469010140626e-1,
+        1.53291798278765697312063226850e-1,
+        8.20105229563468988491666602057e-3,
+        7.56789766054569976138603589584e-3,
+       -8.298e-3 },
+      { 3.18346481635021405060768473261e-2,  0.0, 0.0, 0.0, 0.0,
+        2.83009096723667755288322961402e-2,
+        5.35419883074385676223797384372e-2,
+       -5.49237485713909884646569340306e-2,
+        0.0, 0.0,
+       -1.08347328697249322858509316994e-4,
+        3.82571090835658412954920192323e-4,
+       -3.40465008687404560802977114492e-4,
+        1.41312443674632500278074618366e-1 },
+      {-4.28896301583791923408573538692e-1,  0.0, 0.0, 0.0, 0.0,
+       -4.69762141536116384314449447206,
+        7.68342119606259904184240953878,
+        4.06898981839711007970213554331,
+        3.56727187455281109270669543021e-1,
+        0.0, 0.0, 0.0,
+       -1.39902416515901462129418009734e-3,
+        2.94751478915277233895562721490,
+       -9.15095847217987001081870187138 }
+    };
+
+    constexpr static double D[4][NK]
+    {
+      {-0.84289382761090128651353491142e+1,  0.0, 0.0, 0.0, 0.0,
+        0.56671495351937776962531783590,
+       -0.30689499459498916912797304727e+1,
+        0.23846676565120698287728149680e+1,
+        0.21170345824450282767155149946e+1,
+       -0.87139158377797299206789907490,
+        0.22404374302607882758541771650e+1,
+        0.63157877876946881815570249290,
+       -0.88990336451333310820698117400e-1,
+        0.18148505520854727256656404962e+2,
+       -0.91946323924783554000451984436e+1,
+       -0.44360363875948939664310572000e+1 },
+      { 0.10427508642579134603413151009e+2,  0.0, 0.0, 0.0, 0.0,
+        0.24228349177525818288430175319e+3,
+        0.16520045171727028198505394887e+3,
+       -0.37454675472269020279518312152e+3,
+       -0.22113666853125306036270938578e+2,
+        0.77334326684722638389603898808e+1,
+       -0.30674084731089398182061213626e+2,
+       -0.93321305264302278729567221706e+1,
+        0.15697238121770843886131091075e+2,
+       -0.31139403219565177677282850411e+2,
+       -0.93529243588444783865713862664e+1,
+        0.35816841486394083752465898540e+2 },
+      { 0.19985053242002433820987653617e+2,  0.0, 0.0, 0.0, 0.0,
+       -0.38703730874935176555105901742e+3,
+       -0.18917813819516756882830838328e+3,
+        0.52780815920542364900561016686e+3,
+       -0.11573902539959630126141871134e+2,
+        0.68812326946963000169666922661e+1,
+       -0.10006050966910838403183860980e+1,
+        0.77771377980534432092869265740,
+       -0.27782057523535084065932004339e+1,
+       -0.60196695231264120758267380846e+2,
+        0.84320405506677161018159903784e+2,
+        0.11992291136182789328035130030e+2 },
+      {-0.25693933462703749003312586129e+2,  0.0, 0.0, 0.0, 0.0,
+       -0.15418974869023643374053993627e+3,
+       -0.23152937917604549567536039109e+3,
+        0.35763911791061412378285349910e+3,
+        0.93405324183624310003907691704e+2,
+       -0.37458323136451633156875139351e+2,
+        0.10409964950896230045147246184e+3,
+        0.29840293426660503123344363579e+2,
+       -0.43533456590011143754432175058e+2,
+        0.96324553959188282948394950600e+2,
+       -0.39177261675615439165231486172e+2,
+       -0.14972683625798562581422125276e+3 }
+    };
+  };
+
+  //-------------------------------------------------------------------------//
+  // RKF78:                                                                  //
+  //-------------------------------------------------------------------------//
+  // E. Fehlberg, "Classical Fifth-, Sixth-, Seventh- and Eighth-Order Runge-
+  // Kutta Formulas with Stepsize Control", NASA TR R-287, 1968. The 8th-order
+  // solution is propagated (local extrapolation); the error estimator is the
+  // difference between the 7th- and 8th-order ones:
+  //
+  template<>
+  struct RKTableau<RKMethod::RKF78>
+  {
+    constexpr static int    NS       = 13;
+    constexpr static bool   FSAL     = false;
+    constexpr static int    NE       = 1;
+    constexpr static int    ErrOrder = 7;
+    constexpr static bool   Dense    = false;
+    constexpr static int    NK       = NS;
+
+    constexpr static double C[NS]
+    {
+      0.0, 2.0/27.0, 1.0/9.0, 1.0/6.0, 5.0/12.0, 0.5, 5.0/6.0, 1.0/6.0,
+      2.0/3.0, 1.0/3.0, 1.0, 0.0, 1.0
+    };
+
+    constexpr static double A[NS][NS]
+    {
+      { },
+      { 2.0/27.0 },
+      { 1.0/36.0,       1.0/12.0 },
+      { 1.0/24.0,       0.0, 1.0/8.0 },
+      { 5.0/12.0,       0.0, -25.0/16.0, 25.0/16.0 },
+      { 1.0/20.0,       0.0, 0.0, 1.0/4.0, 1.0/5.0 },
+      { -25.0/108.0,    0.0, 0.0, 125.0/108.0, -65.0/27.0, 125.0/54.0 },
+      { 31.0/300.0,     0.0, 0.0, 0.0, 61.0/225.0, -2.0/9.0, 13.0/900.0 },
+      { 2.0,            0.0, 0.0, -53.0/6.0, 704.0/45.0, -107.0/9.0,
+        67.0/90.0,      3.0 },
+      { -91.0/108.0,    0.0, 0.0, 23.0/108.0, -976.0/135.0, 311.0/54.0,
+        -19.0/60.0,     17.0/6.0, -1.0/12.0 },
+      { 2383.0/4100.0,  0.0, 0.0, -341.0/164.0, 4496.0/1025.0, -301.0/82.0,
+        2133.0/4100.0,  45.0/82.0, 45.0/164.0, 18.0/41.0 },
+      { 3.0/205.0,      0.0, 0.0, 0.0, 0.0, -6.0/41.0, -3.0/205.0,
+        -3.0/41.0,      3.0/41.0, 6.0/41.0, 0.0 },
+      { -1777.0/4100.0, 0.0, 0.0, -341.0/164.0, 4496.0/1025.0, -289.0/82.0,
+        2193.0/4100.0,  51.0/82.0, 33.0/164.0, 12.0/41.0, 0.0, 1.0 }
+    };
+
+    constexpr static double B[NS]
+    {
+      0.0, 0.0, 0.0, 0.0, 0.0, 34.0/105.0, 9.0/35.0, 9.0/35.0, 9.0/280.0,
+      9.0/280.0, 0.0, 41.0/840.0, 41.0/840.0
+    };
+
+    constexpr static double E[NE][NS]
+    {
+      { -41.0/840.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
+        -41.0/840.0, 41.0/840.0, 41.0/840.0 }
+    };
+  };
+
+  //=========================================================================//
+  // "QuinticHermite": The Dense Output Basis for Methods without their Own: //
+  //=========================================================================//
+  // Over a step [t0, t0+h], with s = (t-t0)/h, the position is interpolated
+  // by the quintic Hermite polynomial which matches the positions,  veloci-
+  // ties and accelerations at both ends:
+  //   r(s) = H0*r0 + H3*r1 + h*(H1*v0 + H4*v1) + h^2*(H2*a0 + H5*a1),
+  // and its derivative wrt "s" is the same with "D" instead of "H" (D3 = -D0,
+  // so the term with the positions is D0*(r0-r1)); the velocity is the latter
+  // divided by "h":
+  //
+  struct QuinticHermite
+  {
+    double m_H0, m_H1, m_H2, m_H3, m_H4, m_H5;
+    double m_D0, m_D1, m_D2,         m_D4, m_D5;
+
+    explicit QuinticHermite(double a_s)
+    {
+      double const s  = a_s;
+      double const s2 = s  * s;
+      double const s3 = s2 * s;
+      double const s4 = s3 * s;
+      double const s5 = s4 * s;
+
+      m_H0 = 1.0 - 10.0 * s3 + 15.0 * s4 - 6.0 * s5;
+      m_H1 = s   -  6.0 * s3 +  8.0 * s4 - 3.0 * s5;
+      m_H2 = 0.5 * (s2 - 3.0 * s3 + 3.0 * s4 - s5);
+      m_H3 = 1.0 - m_H0;
+      m_H4 = -4.0 * s3 +  7.0 * s4 - 3.0 * s5;
+      m_H5 = 0.5 * (s3 - 2.0 * s4 + s5);
+
+      m_D0 = -30.0 * s2 + 60.0 * s3 - 30.0 * s4;
+      m_D1 = 1.0 - 18.0 * s2 + 32.0 * s3 - 15.0 * s4;
+      m_D2 = 0.5 * (2.0 * s - 9.0 * s2 + 12.0 * s3 - 5.0 * s4);
+      m_D4 = -12.0 * s2 + 28.0 * s3 - 15.0 * s4;
+      m_D5 = 0.5 * (3.0 * s2 - 8.0 * s3 + 5.0 * s4);
+    }
+  };
+
+  //=========================================================================//
+  // "LanesV": 3D Vectors in "NL" Lanes:                                     //
+  //=========================================================================//
+  // A Structure-of-Arrays: "[c][k]" is the component "c" of the vector in the
+  // lane "k", so each "[c].data()" can be passed directly to the batched eva-
+  // luators of "GravityField" (eg "GravAccBatch"):
+  //
+  template<typename Q, int NL>
+  using LanesV = std::array<std::array<Q, size_t(NL)>, 3>;
+
+  //=========================================================================//
+  // "RKLanes": The State Types for the given Lane Type:                     //
+  //=========================================================================//
+  // "V" is "double" for a single trajectory, whose states are then the typed
+  // 3D vectors, or "DoubleLanes<NL>" for "NL" trajectories in the SIMD lanes,
+  // whose states are then "LanesV"s. "Comp" gives the lanes of the component
+  // "a_c", which are loaded into a "V" (or stored from it) by "LoadV" (or by
+  // "StoreV"):
+  //
+  template<typename COS, typename V>
+  struct RKLanes
+  {
+    constexpr static int NL = SIMDTraits<V>::Lanes;
+    using PosT = LanesV<Len, NL>;
+    using VelT = LanesV<Vel, NL>;
+    using AccT = LanesV<Acc, NL>;
+
+    template<typename Q>
+    static Q*       Comp(LanesV<Q, NL>&       a_x, size_t a_c)
+      { return a_x[a_c].data(); }
+
+    template<typename Q>
+    static Q const* Comp(LanesV<Q, NL> const& a_x, size_t a_c)
+      { return a_x[a_c].data(); }
+  };
+
+  template<typename COS>
+  struct RKLanes<COS, double>
+  {
+    constexpr static int NL = 1;
+    using PosT = PosV<COS>;
+    using VelT = VelV<COS>;
+    using AccT = AccV<COS>;
+
+    template<typename Q>
+    static Q*       Comp(std::array<Q, 3>&       a_x, size_t a_c)
+      { return &(a_x[a_c]); }
+
+    template<typename Q>
+    static Q const* Comp(std::array<Q, 3> const& a_x, size_t a_c)
+      { return &(a_x[a_c]); }
+  };
+
+  //=========================================================================//
+  // "RKStepper": The Common Base of "RKIntegrator" and "LockStepRK":        //
+  //=========================================================================//
+  // The adaptive step control, the stages and the dense output of the given
+  // method, over the states of 1 trajectory ("V" = "double") or of several
+  // ones in the SIMD lanes ("V" = "DoubleLanes<NL>"), see "RKLanes". All li-
+  // near combinations of the stages are computed on "V"s  (ie on the magni-
+  // tudes of the SI values), so with several lanes, they are vectorised across
+  // the trajectories. The step size is controlled by the max over the live
+  // lanes of the normalised errors, so the trajectories share the step size.
+  // The error in each lane is controlled component-wise: for the position,
+  //   |err| <= a_abs_tol_pos + a_rel_tol * |r|,
+  // and similarly for the velocity; the RMS of the normalised errors over all
+  // 6 components must be <= 1.
+  // "Derived" (CRTP) provides:
+  // (*) "Name":  the class name (for the error messages);
+  // (*) "CallRHS(t, r, v, kr, kv)": invokes the RHS at (t, r, v), adding the
+  //     accelerations to "*kv" (which is zeroed beforehand; "*kr" is "v");
+  // (*) "IsLiveLane(k)": whether the lane "k" is being propagated; the step
+  //     size only depends on the live lanes (the stages of the other ones must
+  //     be zeroed by "CallRHS", so their states do not move):
+  //
+  template<typename Derived, RKMethod Method, typename COS, typename V>
+  class RKStepper
+  {
+  public:
+    using Tableau = RKTableau<Method>;
+    using Lanes   = RKLanes<COS, V>;
+    using PosT    = typename Lanes::PosT;
+    using VelT    = typename Lanes::VelT;
+    using AccT    = typename Lanes::AccT;
+    constexpr static int NS = Tableau::NS;
+
+  protected:
+    //=======================================================================//
+    // Data Flds:                                                            //
+    //=======================================================================//
+    constexpr static int    NL     = Lanes::NL;
+    constexpr static int    NK     = Tableau::NK;
+
+    // Step size control params:
+    constexpr static double Safety = 0.9;
+    constexpr static double FacMin = 0.333;
+    constexpr static double FacMax = 6.0;
+
+    double       m_relTol;
+    Len          m_absTolR;
+    Vel          m_absTolV;
+    Time         m_hMax;        // 0: No limit
+    Time         m_hFix;        // 0: Adaptive steps
+
+    // The current state (common to all lanes), and the step size for the next
+    // step (0 if not known yet, then it is selected automatically):
+    Time         m_t;
+    PosT         m_r;
+    VelT         m_v;
+    Time         m_h;
+
+    // The stages: "m_kr" are the derivatives of the position (ie the stage
+    // velocities), "m_kv" those of the velocity (ie the accelerations). If
+    // "m_k0Valid", the stage 0 (the derivatives at the current state)  is
+    // already known. For the methods with their own dense output, the extra
+    // stages (NS+1 .. NK-1) follow those of the step; the slot NS is not used,
+    // as the FSAL stage is the stage 0 of the next step:
+    VelT         m_kr[NK];
+    AccT         m_kv[NK];
+    bool         m_k0Valid;
+
+    // The state at the beginning of the last step (valid iff "m_hasStep"),
+    // for the dense output; "m_tLast" is the end of the last adaptive step
+    // (which is the limit for "RKIntegrator::StopAt"):
+    bool         m_hasStep;
+    Time         m_tPrev;
+    Time         m_tLast;
+    PosT         m_rPrev;
+    VelT         m_vPrev;
+    AccT         m_aPrev;
+
+    // For the methods with their own dense output: its coeffs over the last
+    // adaptive step ("contd8" in "dop853.f"), valid iff "m_denseOK" (they are
+    // only computed when the dense output is first needed in that step):
+    bool         m_denseOK;
+    PosT         m_dR[7];
+    VelT         m_dV[7];
+
+    // Statistics (with several lanes, the RHS calls are batched ones):
+    long         m_nSteps;
+    long         m_nRejected;
+    long         m_nRHS;
+
+    //=======================================================================//
+    // Non-Default Ctor:                                                     //
+    //=======================================================================//
+    // The initial state is set by "Derived".  "a_h0" is the initial step size
+    // (0 for the automatic selection); "a_h_max" is the max step size (0 for
+    // no limit). Throws "std::invalid_argument" for invalid tolerances:
+    //
+    RKStepper
+    (
+      Time             a_t0,
+      double           a_rel_tol,
+      Len              a_abs_tol_pos,
+      Vel              a_abs_tol_vel,
+      Time             a_h0,
+      Time             a_h_max
+    )
+    : m_relTol   (a_rel_tol),
+      m_absTolR  (a_abs_tol_pos),
+      m_absTolV  (a_abs_tol_vel),
+      m_hMax     (Abs(a_h_max)),
+      m_hFix     (0.0),
+      m_t        (a_t0),
+      m_r        (),
+      m_v        (),
+      m_h        (Abs(a_h0)),
+      m_kr       (),
+      m_kv       (),
+      m_k0Valid  (false),
+      m_hasStep  (false),
+      m_tPrev    (a_t0),
+      m_tLast    (a_t0),
+      m_rPrev    (),
+      m_vPrev    (),
+      m_aPrev    (),
+      m_denseOK  (false),
+      m_dR       (),
+      m_dV       (),
+      m_nSteps   (0),
+      m_nRejected(0),
+      m_nRHS     (0)
+    {
+      if (UNLIKELY(!(a_rel_tol >= 0.0) || IsNeg(a_abs_tol_pos) ||
+                   IsNeg(a_abs_tol_vel)                        ||
+                   (a_rel_tol == 0.0 && (IsZero(a_abs_tol_pos) ||
+                                         IsZero(a_abs_tol_vel)))))
+        throw std::invalid_argument
+              (std::string(Derived::Name) + ": Invalid Tolerance(s)");
+    }
+
+  public:
+    //=======================================================================//
+    // Accessors:                                                            //
+    //=======================================================================//
+    Time GetTime()       const { return m_t;         }
+    Time GetStep()       const { return m_h;         }
+    long NSteps()        const { return m_nSteps;    }
+    long NRejected()     const { return m_nRejected; }
+    long NRHSCalls()     const { return m_nRHS;      }
+
+    // The last step is [LastStepStart(), GetTime()] (only if "HasStep()"):
+    bool HasStep()       const { return m_hasStep;   }
+    Time LastStepStart() const { return m_tPrev;     }
+
+    //=======================================================================//
+    // "SetFixedStep":                                                       //
+    //=======================================================================//
+    // With a_h > 0, all subsequent steps are of the size "a_h" (except the
+    // last one of each "Propagate",  which ends exactly at the target time),
+    // without error control (so the lanes, if several, are not coupled at
+    // all).  With a_h = 0, the adaptive steps are resumed:
+    //
+    void SetFixedStep(Time a_h)
+      { m_hFix = Abs(a_h); }
+
+  protected:
+    //=======================================================================//
+    // "DoStep": One Accepted Step towards "a_t_end":                        //
+    //=======================================================================//
+    // The step never goes beyond "a_t_end" (which may be before the current
+    // time, then the integration is backwards).  Returns "true" iff "a_t_end"
+    // has been reached. Throws "std::runtime_error" if the step size becomes
+    // too small to make any progress:
+    //
+    bool DoStep(Time a_t_end)
+    {
+      if (m_t == a_t_end)
+        return true;
+
+      double const dir = IsPos(a_t_end - m_t) ? 1.0 : -1.0;
+      if (!m_k0Valid)
+      {
+        Eval(0, m_t, m_r, m_v);
+        m_k0Valid = true;
+      }
+      bool const fixed = IsPos(m_hFix);
+      if (fixed)
+        m_h = m_hFix;
+      else
+      if (IsZero(m_h))
+        m_h = InitStep(dir);
+
+      Time h        = dir * m_h;
+      bool rejected = false;
+
+      while (true)
+      {
+        if (IsPos(m_hMax) && Abs(h) > m_hMax && !fixed)
+          h = dir * m_hMax;
+
+        bool last = false;
+        if (Abs(h) >= Abs(a_t_end - m_t))
+        {
+          h    = a_t_end - m_t;
+          last = true;
+        }
+        if (UNLIKELY(Abs(h) <= 16.0 * Eps<double> * Abs(m_t)))
+          throw std::runtime_error
+                (std::string(Derived::Name) + ": Step Size UnderFlow");
+
+        //-------------------------------------------------------------------//
+        // The stages, the new state and the error:                          //
+        //-------------------------------------------------------------------//
+        PosT   rn;
+        VelT   vn;
+        double err = Attempt(h, &rn, &vn);
+
+        constexpr double Exp = -1.0 / double(Tableau::ErrOrder + 1);
+        if (fixed || err <= 1.0)
+        {
+          // Accepted:
+          if (!fixed)
+          {
+            double fac =
+              (err == 0.0) ? FacMax
+                           : std::min(FacMax, Safety * std::pow(err, Exp));
+            if (rejected)
+              fac = std::min(fac, 1.0);
+            m_h = Abs(h) * fac;
+          }
+          ++m_nSteps;
+          Advance(last ? a_t_end : (m_t + h), rn, vn);
+          m_tLast = m_t;
+          return last;
+        }
+        // Rejected: Retry with a smaller step:
+        rejected = true;
+        ++m_nRejected;
+        h *= std::max(FacMin, Safety * std::pow(err, Exp));
+      }
+    }
+
+    //=======================================================================//
+    // "DenseLane": The Dense Output over the Last Step in the Lane "a_k":   //
+    //=======================================================================//
+    // For the methods with their own dense output (DOP853), this is the meth-
+    // od's interpolant of the order 7 (as in "dop853.f"), which is as accur-
+    // ate as the step itself; it costs 3 more RHS calls, made only at the 1st
+    // call of "DenseLane" in the given step (see "MakeDense"). Otherwise, the
+    // position is interpolated by the quintic Hermite polynomial (see "Quin-
+    // ticHermite"), at no extra cost (the acceleration at the end is the stage
+    // 0 of the next step), with the local error O(h^6); the velocity is then
+    // the derivative of the polynomial:
+    //
+    void DenseLane(int a_k, Time a_t, PosV<COS>* a_r, VelV<COS>* a_v)
+    {
+      assert(m_hasStep && 0 <= a_k && a_k < NL && a_r != nullptr &&
+             a_v != nullptr);
+      size_t const k = size_t(a_k);
+
+      if constexpr (Tableau::Dense)
+      {
+        MakeDense();
+        double const s  = double((a_t - m_tPrev) / (m_tLast - m_tPrev));
+        double const s1 = 1.0 - s;
+        for (size_t c = 0; c < 3; ++c)
+        {
+          // The nested form, with the factors s and (1-s) alternating:
+          Len dr = Lanes::Comp(m_dR[6], c)[k];
+          Vel dv = Lanes::Comp(m_dV[6], c)[k];
+          for (int i = 5; i >= 0; --i)
+          {
+            double const w = (i % 2 != 0) ? s : s1;
+            dr = Lanes::Comp(m_dR[i], c)[k] + w * dr;
+            dv = Lanes::Comp(m_dV[i], c)[k] + w * dv;
+          }
+          (*a_r)[c] = Lanes::Comp(m_rPrev, c)[k] + s * dr;
+          (*a_v)[c] = Lanes::Comp(m_vPrev, c)[k] + s * dv;
+        }
+      }
+      else
+      {
+        Time           const h = m_t - m_tPrev;
+        QuinticHermite const b(double((a_t - m_tPrev) / h));
+        for (size_t c = 0; c < 3; ++c)
+        {
+          Len const r0 = Lanes::Comp(m_rPrev, c)[k];
+          Len const r1 = Lanes::Comp(m_r,     c)[k];
+          Vel const v0 = Lanes::Comp(m_vPrev, c)[k];
+          Vel const v1 = Lanes::Comp(m_v,     c)[k];
+          Acc const a0 = Lanes::Comp(m_aPrev, c)[k];
+          Acc const a1 = Lanes::Comp(m_kv[0], c)[k];
+          (*a_r)[c] =
+            b.m_H0 * r0 + b.m_H3 * r1 + h * (b.m_H1 * v0 + b.m_H4 * v1) +
+            h * h * (b.m_H2 * a0 + b.m_H5 * a1);
+          (*a_v)[c] =
+            b.m_D0 * (r0 - r1) / h + b.m_D1 * v0 + b.m_D4 * v1          +
+            h * (b.m_D2 * a0 + b.m_D5 * a1);
+        }
+      }
+    }
+
+    //-----------------------------------------------------------------------//
+    // "LaneOf": The 3D Vector in the Lane "a_k" of "a_x":                   //
+    //-----------------------------------------------------------------------//
+    template<typename X>
+    static auto LaneOf(X const& a_x, int a_k)
+    {
+      assert(0 <= a_k && a_k < NL);
+      size_t const k = size_t(a_k);
+      using Q = std::remove_cvref_t<decltype(*Lanes::Comp(a_x, 0))>;
+      return std::array<Q, 3>
+        {{ Lanes::Comp(a_x, 0)[k], Lanes::Comp(a_x, 1)[k],
+           Lanes::Comp(a_x, 2)[k] }};
+    }
+
+    //=======================================================================//
+    // Internal Utils:                                                       //
+    //=======================================================================//
+    //-----------------------------------------------------------------------//
+    // "Ld", "St": The Component "a_c" of a State Vector as a "V":           //
+    //-----------------------------------------------------------------------//
+    template<typename X>
+    static V Ld(X const& a_x, size_t a_c)
+      { return LoadV<V>(Lanes::Comp(a_x, a_c)); }
+
+    template<typename X>
+    static void St(X* a_x, size_t a_c, V a_y)
+      { StoreV(Lanes::Comp(*a_x, a_c), a_y); }
+
+    //-----------------------------------------------------------------------//
+    // "StageSums": Linear Combinations of the Stages:                       //
+    //-----------------------------------------------------------------------//
+    // The sums over j < a_n of a_w[j] times the stages "a_kr(j)" and "a_kv(j)"
+    // in the component "a_c" (the zero coeffs, of which there are many in the
+    // tableaux, are skipped):
+    //
+    template<typename KR, typename KV>
+    static void StageSums
+    (
+      double const* a_w,
+      int           a_n,
+      KR const&     a_kr,
+      KV const&     a_kv,
+      size_t        a_c,
+      V*            a_sr,
+      V*            a_sv
+    )
+    {
+      V sr = Splat<V>(0.0);
+      V sv = Splat<V>(0.0);
+      for (int j = 0; j < a_n; ++j)
+      {
+        double const w = a_w[j];
+        if (w == 0.0)
+          continue;
+        sr += w * Ld(a_kr(j), a_c);
+        sv += w * Ld(a_kv(j), a_c);
+      }
+      *a_sr = sr;
+      *a_sv = sv;
+    }
+
+    //-----------------------------------------------------------------------//
+    // "Eval": The Stage "a_k" at the given point:                           //
+    //-----------------------------------------------------------------------//
+    void Eval(int a_k, Time a_t, PosT const& a_r, VelT const& a_v)
+    {
+      assert(0 <= a_k && a_k < NK);
+      m_kr[a_k] = a_v;
+      m_kv[a_k] = AccT();
+      static_cast<Derived*>(this)->Derived::CallRHS
+        (a_t, a_r, a_v, &(m_kr[a_k]), &(m_kv[a_k]));
+      ++m_nRHS;
+    }
+
+    //-----------------------------------------------------------------------//
+    // "Advance": Moves to the New State after an Accepted Step:             //
+    //-----------------------------------------------------------------------//
+    // The old state is saved for the dense output; the stage 0 of the next
+    // step (ie the acceleration at the new state, which is also needed for
+    // the dense output) is evaluated now. For the FSAL methods, this is the
+    // last stage of the accepted step; as in "dop853.f", it is only evaluated
+    // after the acceptance, so the rejected steps do not waste it:
+    //
+    void Advance(Time a_t, PosT const& a_rn, VelT const& a_vn)
+    {
+      m_tPrev   = m_t;
+      m_rPrev   = m_r;
+      m_vPrev   = m_v;
+      m_aPrev   = m_kv[0];
+      m_t       = a_t;
+      m_r       = a_rn;
+      m_v       = a_vn;
+      m_hasStep = true;
+      m_denseOK = false;
+      m_k0Valid = false;
+      Eval(0, m_t, m_r, m_v);
+      m_k0Valid = true;
+    }
+
+    //-----------------------------------------------------------------------//
+    // "Attempt": One Step of the Size "a_h":                                //
+    //-----------------------------------------------------------------------//
+    // The stage 0 must already be in place. Returns the normalised error (the
+    // max over the lanes):
+    //
+    double Attempt(Time a_h, PosT* a_rn, VelT* a_vn)
+    {
+      assert(a_rn != nullptr && a_vn != nullptr);
+      double const h  = a_h.Magnitude();
+      auto   const kr = [this](int a_j) -> VelT const& { return m_kr[a_j]; };
+      auto   const kv = [this](int a_j) -> AccT const& { return m_kv[a_j]; };
+
+      for (int i = 1; i < NS; ++i)
+      {
+        PosT ri;
+        VelT vi;
+        for (size_t c = 0; c < 3; ++c)
+        {
+          V sr, sv;
+          StageSums(Tableau::A[i], i, kr, kv, c, &sr, &sv);
+          St(&ri, c, Ld(m_r, c) + h * sr);
+          St(&vi, c, Ld(m_v, c) + h * sv);
+        }
+        Eval(i, m_t + Tableau::C[i] * a_h, ri, vi);
+      }
+
+      // The new state:
+      for (size_t c = 0; c < 3; ++c)
+      {
+        V sr, sv;
+        StageSums(Tableau::B, NS, kr, kv, c, &sr, &sv);
+        St(a_rn, c, Ld(m_r, c) + h * sr);
+        St(a_vn, c, Ld(m_v, c) + h * sv);
+      }
+
+      // The error estimate(s) in each lane, as the sums of squares of the
+      // normalised components (without the factor "h"):
+      double e2[Tableau::NE][NL];
+      for (int e = 0; e < Tableau::NE; ++e)
+      {
+        std::fill_n(e2[e], NL, 0.0);
+        for (size_t c = 0; c < 3; ++c)
+        {
+          V er, ev;
+          StageSums(Tableau::E[e], NS, kr, kv, c, &er, &ev);
+
+          Len const* r0 = Lanes::Comp(m_r,   c);
+          Len const* r1 = Lanes::Comp(*a_rn, c);
+          Vel const* v0 = Lanes::Comp(m_v,   c);
+          Vel const* v1 = Lanes::Comp(*a_vn, c);
+          for (int k = 0; k < NL; ++k)
+          {
+            Len const scR =
+              m_absTolR + m_relTol * std::max(Abs(r0[k]), Abs(r1[k]));
+            Vel const scV =
+              m_absTolV + m_relTol * std::max(Abs(v0[k]), Abs(v1[k]));
+            e2[e][k] += Sqr(GetLane(er, k) / scR.Magnitude()) +
+                        Sqr(GetLane(ev, k) / scV.Magnitude());
+          }
+        }
+      }
+
+      // The frozen lanes (if any) have zero errors, so they do not affect the
+      // max:
+      double const ah  = std::fabs(h);
+      double       err = 0.0;
+      for (int k = 0; k < NL; ++k)
+      {
+        double ek = 0.0;
+        if constexpr (Tableau::NE == 1)
+          ek = ah * std::sqrt(e2[0][k] / 6.0);
+        else
+        {
+          // The 5th-order estimate, damped by the 3rd-order one (as in "dop-
+          // 853.f"), which makes the controller more robust for large steps:
+          double const den = e2[0][k] + 0.01 * e2[1][k];
+          ek = (den > 0.0) ? ah * e2[0][k] / std::sqrt(6.0 * den) : 0.0;
+        }
+        err = std::max(err, ek);
+      }
+      return err;
+    }
+
+    //-----------------------------------------------------------------------//
+    // "InitStep": Automatic Initial Step Size Selection:                    //
+    //-----------------------------------------------------------------------//
+    // As in Hairer et al, Sect II.4, in all live lanes, with the trial Euler
+    // step common to all of them (the smallest one); the result is the min
+    // over the live lanes. The stage 0 must already be in place:
+    //
+    Time InitStep(double a_dir)
+    {
+      auto const live = [this](int a_k) -> bool
+        { return static_cast<Derived const*>(this)->Derived::IsLiveLane(a_k); };
+
+      double d0[NL], d1[NL];
+      std::fill_n(d0, NL, 0.0);
+      std::fill_n(d1, NL, 0.0);
+      for (size_t c = 0; c < 3; ++c)
+      {
+        Len const* r  = Lanes::Comp(m_r,     c);
+        Vel const* v  = Lanes::Comp(m_v,     c);
+        Vel const* kr = Lanes::Comp(m_kr[0], c);
+        Acc const* kv = Lanes::Comp(m_kv[0], c);
+        for (int k = 0; k < NL; ++k)
+        {
+          Len const scR = m_absTolR + m_relTol * Abs(r[k]);
+          Vel const scV = m_absTolV + m_relTol * Abs(v[k]);
+          d0[k] += Sqr(double(r [k] / scR)) + Sqr(double(v[k] / scV));
+          d1[k] += Sqr(double(kr[k] / scR * 1.0_sec)) +
+                   Sqr(double(kv[k] / scV * 1.0_sec));
+        }
+      }
+      double h0 = 0.0;
+      for (int k = 0; k < NL; ++k)
+      {
+        d0[k] = std::sqrt(d0[k] / 6.0);
+        d1[k] = std::sqrt(d1[k] / 6.0);
+        double const h0k =
+          (d0[k] < 1e-5 || d1[k] < 1e-5) ? 1e-6 : 0.01 * d0[k] / d1[k];
+        if (live(k) && (h0 == 0.0 || h0k < h0))
+          h0 = h0k;
+      }
+      assert(h0 > 0.0);
+
+      // An explicit Euler step, in the stage 1 (which is then overwritten):
+      Time const h0t = a_dir * Time(h0);
+      PosT r1;
+      VelT v1;
+      for (size_t c = 0; c < 3; ++c)
+      {
+        St(&r1, c, Ld(m_r, c) + h0t.Magnitude() * Ld(m_kr[0], c));
+        St(&v1, c, Ld(m_v, c) + h0t.Magnitude() * Ld(m_kv[0], c));
+      }
+      Eval(1, m_t + h0t, r1, v1);
+
+      double d2[NL];
+      std::fill_n(d2, NL, 0.0);
+      for (size_t c = 0; c < 3; ++c)
+      {
+        Len const* r   = Lanes::Comp(m_r,     c);
+        Vel const* v   = Lanes::Comp(m_v,     c);
+        Vel const* kr0 = Lanes::Comp(m_kr[0], c);
+        Acc const* kv0 = Lanes::Comp(m_kv[0], c);
+        Vel const* kr1 = Lanes::Comp(m_kr[1], c);
+        Acc const* kv1 = Lanes::Comp(m_kv[1], c);
+        for (int k = 0; k < NL; ++k)
+        {
+          Len const scR = m_absTolR + m_relTol * Abs(r[k]);
+          Vel const scV = m_absTolV + m_relTol * Abs(v[k]);
+          d2[k] += Sqr(double((kr1[k] - kr0[k]) / scR * 1.0_sec)) +
+                   Sqr(double((kv1[k] - kv0[k]) / scV * 1.0_sec));
+        }
+      }
+
+      Time h(0.0);
+      for (int k = 0; k < NL; ++k)
+      {
+        if (!live(k))
+          continue;
+        double const dm = std::max(d1[k], std::sqrt(d2[k] / 6.0) / h0);
+        double const h1 =
+          (dm <= 1e-15)
+          ? std::max(1e-6, h0 * 1e-3)
+          : std::pow(0.01 / dm, 1.0 / double(Tableau::ErrOrder + 2));
+        Time const hk(std::min(100.0 * h0, h1));
+        if (IsZero(h) || hk < h)
+          h = hk;
+      }
+      if (IsPos(m_hMax))
+        h = std::min(h, m_hMax);
+      return h;
+    }
+
+    //-----------------------------------------------------------------------//
+    // "MakeDense": The Coeffs of the Method's Own Dense Output:             //
+    //-----------------------------------------------------------------------//
+    // Over the last adaptive step, from its stages (which remain in place
+    // until the next step is attempted, except for the stage 0, which is now
+    // in "m_vPrev" and "m_aPrev", as "m_kr[0]" and "m_kv[0]" are the FSAL
+    // stage), and the extra ones:
+    //
+    void MakeDense()
+    {
+      if (m_denseOK)
+        return;
+      assert(m_hasStep && m_t == m_tLast);
+
+      auto const kr = [this](int a_j) -> VelT const&
+        { return (a_j == 0) ? m_vPrev : m_kr[(a_j == NS) ? 0 : a_j]; };
+      auto const kv = [this](int a_j) -> AccT const&
+        { return (a_j == 0) ? m_aPrev : m_kv[(a_j == NS) ? 0 : a_j]; };
+
+      Time   const ht = m_t - m_tPrev;
+      double const h  = ht.Magnitude();
+      for (int i = NS+1; i < NK; ++i)
+      {
+        PosT ri;
+        VelT vi;
+        for (size_t c = 0; c < 3; ++c)
+        {
+          V sr, sv;
+          StageSums(Tableau::AD[i-NS-1], i, kr, kv, c, &sr, &sv);
+          St(&ri, c, Ld(m_rPrev, c) + h * sr);
+          St(&vi, c, Ld(m_vPrev, c) + h * sv);
+        }
+        Eval(i, m_tPrev + Tableau::CD[i-NS-1] * ht, ri, vi);
+      }
+
+      // The lower-order terms are given by the values and the derivatives at
+      // both ends of the step:
+      for (size_t c = 0; c < 3; ++c)
+      {
+        V const dr = Ld(m_r, c) - Ld(m_rPrev, c);
+        V const dv = Ld(m_v, c) - Ld(m_vPrev, c);
+        V const br = h * Ld(kr(0), c) - dr;
+        V const bv = h * Ld(kv(0), c) - dv;
+        St(&(m_dR[0]), c, dr);
+        St(&(m_dV[0]), c, dv);
+        St(&(m_dR[1]), c, br);
+        St(&(m_dV[1]), c, bv);
+        St(&(m_dR[2]), c, dr - h * Ld(kr(NS), c) - br);
+        St(&(m_dV[2]), c, dv - h * Ld(kv(NS), c) - bv);
+
+        for (int d = 0; d < 4; ++d)
+        {
+          V sr, sv;
+          StageSums(Tableau::D[d], NK, kr, kv, c, &sr, &sv);
+          St(&(m_dR[3+d]), c, h * sr);
+          St(&(m_dV[3+d]), c, h * sv);
+        }
+      }
+      m_denseOK = true;
+    }
+  };
+
+  //=========================================================================//
+  // "RKIntegrator" Class:                                                   //
+  //=========================================================================//
+  // Adaptive embedded Runge-Kutta integrator of the 2nd-order equations of
+  // motion  r'' = acc(t, r, r'),  with the state (r, v) in the given COS:
+  // unlike "gsl_odeiv2", the state is typed and the RHS is a template functor
+  // (typically a lambda), so the whole step, including the RHS, can be in-
+  // lined. The RHS is invoked as
+  //   a_rhs(Time t, PosV<COS> const& r, VelV<COS> const& v, AccV<COS>* acc)
+  // and must ADD the acceleration to "*acc", which is zeroed before the call
+  // (as "GravityField::GravAcc" does, so the latter can be invoked directly);
+  // the exceptions thrown by the RHS (eg "ImpactExn") are propagated to the
+  // caller, the integrator state remaining that of the last accepted step.
+  // The step control and the dense output are those of "RKStepper" (with 1
+  // lane); the latter is used for the location of events (see "Events.hpp").
+  // The object holds the state of one trajectory, so it must NOT be shared
+  // between threads:
+  //
+  template<RKMethod Method, typename COS, typename RHS>
+  class RKIntegrator:
+    public RKStepper<RKIntegrator<Method, COS, RHS>, Method, COS, double>
+  {
+  public:
+    using Base    = RKStepper<RKIntegrator, Method, COS, double>;
+    using Tableau = typename Base::Tableau;
+    constexpr static char const Name[] = "RKIntegrator";
+
+  private:
+    friend Base;
+    using Base::m_t;
+    using Base::m_r;
+    using Base::m_v;
+    using Base::m_h;
+    using Base::m_kr;
+    using Base::m_kv;
+    using Base::m_k0Valid;
+    using Base::m_hasStep;
+    using Base::m_tPrev;
+    using Base::m_tLast;
+    using Base::m_rPrev;
+    using Base::m_vPrev;
+    using Base::m_aPrev;
+    using Base::m_denseOK;
+
+    //=======================================================================//
+    // Data Flds:                                                            //
+    //=======================================================================//
+    RHS          m_rhs;
+
+  public:
+    //=======================================================================//
+    // Non-Default Ctor:                                                     //
+    //=======================================================================//
+    // "a_h0" is the initial step size (0 for the automatic selection); "a_h_
+    // max" is the max step size (0 for no limit). Throws "std::invalid_argu-
+    // ment" for invalid params:
+    //
+    RKIntegrator
+    (
+      RHS const&       a_rhs,
+      Time             a_t0,
+      PosV<COS> const& a_r0,
+      VelV<COS> const& a_v0,
+      double           a_rel_tol,
+      Len              a_abs_tol_pos,
+      Vel              a_abs_tol_vel,
+      Time             a_h0    = Time(0.0),
+      Time             a_h_max = Time(0.0)
+    )
+    : Base (a_t0, a_rel_tol, a_abs_tol_pos, a_abs_tol_vel, a_h0, a_h_max),
+      m_rhs(a_rhs)
+    {
+      m_r = a_r0;
+      m_v = a_v0;
+    }
+
+    //=======================================================================//
+    // "Reset": Starts a New Trajectory (the tolerances are unchanged):      //
+    //=======================================================================//
+    void Reset
+    (
+      Time             a_t0,
+      PosV<COS> const& a_r0,
+      VelV<COS> const& a_v0,
+      Time             a_h0 = Time(0.0)
+    )
+    {
+      m_t       = a_t0;
+      m_r       = a_r0;
+      m_v       = a_v0;
+      m_h       = Abs(a_h0);
+      m_k0Valid = false;
+      m_hasStep = false;
+      m_tPrev   = a_t0;
+      m_tLast   = a_t0;
+      m_denseOK = false;
+    }
+
+    //=======================================================================//
+    // Accessors:                                                            //
+    //=======================================================================//
+    PosV<COS> const& GetPos()     const { return m_r;     }
+    VelV<COS> const& GetVel()     const { return m_v;     }
+    RHS&             GetRHS()           { return m_rhs;   }
+
+    // The state at "LastStepStart()":
+    PosV<COS> const& GetPrevPos() const { return m_rPrev; }
+    VelV<COS> const& GetPrevVel() const { return m_vPrev; }
+
+    //=======================================================================//
+    // "Step": One Accepted Step towards "a_t_end":                          //
+    //=======================================================================//
+    // See "RKStepper::DoStep":
+    //
+    bool Step(Time a_t_end)
+      { return Base::DoStep(a_t_end); }
+
+    //=======================================================================//
+    // "Propagate": Up to "a_t_end" exactly:                                 //
+    //=======================================================================//
+    void Propagate(Time a_t_end)
+      { while (!Step(a_t_end)); }
+
+    //=======================================================================//
+    // "DenseState": The Dense Output over the Last Step:                    //
+    //=======================================================================//
+    // See "RKStepper::DenseLane"; only valid if "HasStep()":
+    //
+    void DenseState(Time a_t, PosV<COS>* a_r, VelV<COS>* a_v)
+      { Base::DenseLane(0, a_t, a_r, a_v); }
+
+    //=======================================================================//
+    // "StopAt": Truncates the Last Step at "a_t":                           //
+    //=======================================================================//
+    // Eg at an event located within the last step. For DOP853, the state at
+    // "a_t" is that of the dense output (which is of the same order as the
+    // method), so the stages of the accepted step are reused, and the only
+    // RHS call (apart from those of "DenseState") is the one at the new state
+    // (the stage 0 of the next step). For the other methods, the state is
+    // computed by a single (non-adaptive) step of the method from the begin-
+    // ning of the last step, so it is as accurate as the step itself, rather
+    // than the Hermite interpolant. In both cases, "StopAt" may be invoked
+    // again with any "a_t" within the last adaptive step (eg for the itera-
+    // tive refinement of an event time):
+    //
+    void StopAt(Time a_t)
+    {
+      assert(m_tLast != m_tPrev);
+      double const s = double((a_t - m_tPrev) / (m_tLast - m_tPrev));
+      if (UNLIKELY(!(0.0 <= s && s <= 1.0)))
+        throw std::invalid_argument("RKIntegrator::StopAt: Invalid Time");
+
+      if constexpr (Tableau::Dense)
+      {
+        // The dense output remains valid over the whole adaptive step:
+        PosV<COS> rn;
+        VelV<COS> vn;
+        DenseState(a_t, &rn, &vn);
+        m_t       = a_t;
+        m_r       = rn;
+        m_v       = vn;
+        m_k0Valid = false;
+        Base::Eval(0, m_t, m_r, m_v);
+        m_k0Valid = true;
+      }
+      else
+      {
+        // Go back to the beginning of the last step:
+        m_t       = m_tPrev;
+        m_r       = m_rPrev;
+        m_v       = m_vPrev;
+        m_kr[0]   = m_vPrev;
+        m_kv[0]   = m_aPrev;
+        m_k0Valid = true;
+        m_hasStep = false;
+        if (a_t == m_tPrev)
+          return;
+
+        // Re-do the step up to "a_t" (the error estimate is not needed):
+        PosV<COS> rn;
+        VelV<COS> vn;
+        (void) Base::Attempt(a_t - m_t, &rn, &vn);
+        Base::Advance(a_t, rn, vn);
+      }
+    }
+
+  private:
+    //=======================================================================//
+    // For "RKStepper":                                                      //
+    //=======================================================================//
+    void CallRHS
+    (
+      Time             a_t,
+      PosV<COS> const& a_r,
+      VelV<COS> const& a_v,
+      VelV<COS>*,
+      AccV<COS>*       a_acc
+    )
+    { m_rhs(a_t, a_r, a_v, a_acc); }
+
+    constexpr bool IsLiveLane(int) const { return true; }
+  };
+
+  //=========================================================================//
+  // Convenience Aliases:                                                    //
+  //=========================================================================//
+  template<typename COS, typename RHS>
+  using DOP853 = RKIntegrator<RKMethod::DOP853, COS, RHS>;
+
+  template<typename COS, typename RHS>
+  using RKF78  = RKIntegrator<RKMethod::RKF78,  COS, RHS>;
+}
+// End namespace SpaceBallistics
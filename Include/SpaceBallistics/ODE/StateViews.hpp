@@ -0,0 +1,158 @@
+// vim:ts=2:et
+//===========================================================================//
+//                   "SpaceBallistics/ODE/StateViews.hpp":                   //
+//           Typed Loads and Stores for Flat "double" State Arrays           //
+//===========================================================================//
+#pragma once
+#include "SpaceBallistics/Types.hpp"
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+namespace SpaceBallistics
+{
+  //=========================================================================//
+  // The Layout Contract:                                                    //
+  //=========================================================================//
+  // A "DimQ" is a standard-layout wrapper of a single "double", and the 3D
+  // vectors are "std::array"s of 3 such values (see "Types.hpp"); so a vector
+  // has exactly the layout of "double[3]", and can be copied to and from a
+  // flat array of "double"s (eg the state of an external ODE solver, such as
+  // GSL). This is checked below for all vector types; if any of these checks
+  // fails (eg in a debugging build of DimTypes which adds some fields to
+  // "DimQ"), the functions below must not be used.
+  // The copying is done by "memcpy" (as in "LoadV" and "StoreV" in "SIMD.hpp"),
+  // so no "double" is ever accessed via a "DimQ" lvalue (which the C++ object
+  // model does not allow); it is compiled into plain register loads and stores,
+  // so there is no overhead compared to an in-place view:
+  //
+  template<typename Vec>
+  constexpr bool IsFlatVec =
+    std::is_standard_layout_v<typename Vec::value_type>           &&
+    std::is_trivially_copyable_v<Vec>                             &&
+    sizeof (typename Vec::value_type) == sizeof (double)          &&
+    alignof(typename Vec::value_type) == alignof(double)          &&
+    sizeof (Vec)                      == 3 * sizeof(double)       &&
+    alignof(Vec)                      == alignof(double);
+
+  namespace Detail
+  {
+    struct AnyCOS;
+  }
+  static_assert(IsFlatVec<PosV<Detail::AnyCOS>>);
+  static_assert(IsFlatVec<VelV<Detail::AnyCOS>>);
+  static_assert(IsFlatVec<AccV<Detail::AnyCOS>>);
+
+  //=========================================================================//
+  // Single Vectors and States:                                              //
+  //=========================================================================//
+  // "LoadVec<Vec>(p)":  The typed vector from the 3 "double"s at "p";
+  // "StoreVec(p, v)":   Stores "v" into the 3 "double"s at "p":
+  //
+  template<typename Vec>
+  inline Vec LoadVec(double const* a_p)
+  {
+    static_assert(IsFlatVec<Vec>);
+    assert(a_p != nullptr);
+    Vec res;
+    std::memcpy(static_cast<void*>(&res), a_p, sizeof(Vec));
+    return res;
+  }
+
+  template<typename Vec>
+  inline void StoreVec(double* a_p, Vec const& a_v)
+  {
+    static_assert(IsFlatVec<Vec>);
+    assert(a_p != nullptr);
+    std::memcpy(a_p, static_cast<void const*>(&a_v), sizeof(Vec));
+  }
+
+  // A 6D state "y" is (x, y, z, vx, vy, vz); its time derivative "y_dot" is
+  // (vx, vy, vz, ax, ay, az):
+  //
+  template<typename COS>
+  inline PosV<COS> PosOf (double const* a_y)
+    { return LoadVec<PosV<COS>>(a_y); }
+
+  template<typename COS>
+  inline VelV<COS> VelOf (double const* a_y)
+    { return LoadVec<VelV<COS>>(a_y + 3); }
+
+  template<typename COS>
+  inline VelV<COS> DPosOf(double const* a_y_dot)
+    { return LoadVec<VelV<COS>>(a_y_dot); }
+
+  template<typename COS>
+  inline AccV<COS> AccOf (double const* a_y_dot)
+    { return LoadVec<AccV<COS>>(a_y_dot + 3); }
+
+  template<typename COS>
+  inline void StorePos (double* a_y,     PosV<COS> const& a_pos)
+    { StoreVec(a_y,         a_pos); }
+
+  template<typename COS>
+  inline void StoreVel (double* a_y,     VelV<COS> const& a_vel)
+    { StoreVec(a_y + 3,     a_vel); }
+
+  template<typename COS>
+  inline void StoreDPos(double* a_y_dot, VelV<COS> const& a_vel)
+    { StoreVec(a_y_dot,     a_vel); }
+
+  template<typename COS>
+  inline void StoreAcc (double* a_y_dot, AccV<COS> const& a_acc)
+    { StoreVec(a_y_dot + 3, a_acc); }
+
+  //=========================================================================//
+  // "StateBatchView": Batches of States:                                    //
+  //=========================================================================//
+  // "a_n" 6D states (or their derivatives) stored in a flat array, each one
+  // "a_stride" (>= 6) "double"s after the previous one. "D" is "double", or
+  // "double const" for a read-only view (then the "Store*" methods cannot be
+  // used). Nothing is owned:
+  //
+  template<typename COS, typename D = double>
+  class StateBatchView
+  {
+  private:
+    static_assert(std::is_same_v<std::remove_const_t<D>, double>);
+
+    D*     m_y;
+    size_t m_n;
+    size_t m_stride;
+
+  public:
+    StateBatchView(D* a_y, size_t a_n, size_t a_stride = 6)
+    : m_y     (a_y),
+      m_n     (a_n),
+      m_stride(a_stride)
+    { assert((a_y != nullptr || a_n == 0) && a_stride >= 6); }
+
+    size_t Size() const { return m_n; }
+
+    // The state "a_i" as "y":
+    PosV<COS> PosAt (size_t a_i) const { return PosOf <COS>(Raw(a_i)); }
+    VelV<COS> VelAt (size_t a_i) const { return VelOf <COS>(Raw(a_i)); }
+
+    void StorePos(size_t a_i, PosV<COS> const& a_pos) const
+      { SpaceBallistics::StorePos<COS>(Raw(a_i), a_pos); }
+
+    void StoreVel(size_t a_i, VelV<COS> const& a_vel) const
+      { SpaceBallistics::StoreVel<COS>(Raw(a_i), a_vel); }
+
+    // The state "a_i" as "y_dot":
+    VelV<COS> DPosAt(size_t a_i) const { return DPosOf<COS>(Raw(a_i)); }
+    AccV<COS> AccAt (size_t a_i) const { return AccOf <COS>(Raw(a_i)); }
+
+    void StoreDPos(size_t a_i, VelV<COS> const& a_vel) const
+      { SpaceBallistics::StoreDPos<COS>(Raw(a_i), a_vel); }
+
+    void StoreAcc (size_t a_i, AccV<COS> const& a_acc) const
+      { SpaceBallistics::StoreAcc<COS>(Raw(a_i), a_acc); }
+
+    // The underlying "double"s of the state "a_i":
+    D* Raw(size_t a_i) const
+      { assert(a_i < m_n); return m_y + a_i * m_stride; }
+  };
+}
+// End namespace SpaceBallistics
@@ -0,0 +1,90 @@
+// vim:ts=2:et
+//===========================================================================//
+//                 "SpaceBallistics/PhysForces/CacheFile.h":                 //
+//       Binary Cache Files: Checksums, Atomic Writes, Read-Only Mappings    //
+//===========================================================================//
+// Common back-end of the binary files written and "mmap"ed by "GravityModel",
+// "GravityGrid", "GravityMap" and "TerrainModel". Each of them defines its own
+// (fixed-size) header; this module only deals with the raw bytes:
+//
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace SpaceBallistics::CacheFile
+{
+  //=========================================================================//
+  // "CheckSum":                                                             //
+  //=========================================================================//
+  // FNV-1a-style hash over "a_n_words" 64-bit words (rather than bytes, which
+  // is ~8 times faster and still detects any truncation or corruption of the
+  // data). "a_data" need not be 8-byte-aligned:
+  //
+  uint64_t CheckSum(void const* a_data, size_t a_n_words);
+
+  //=========================================================================//
+  // "WriteAll":                                                             //
+  //=========================================================================//
+  // Writes the whole buffer, retrying partial and interrupted (EINTR) writes.
+  // Returns "false" on any other error:
+  //
+  bool WriteAll(int a_fd, void const* a_buff, size_t a_len);
+
+  //=========================================================================//
+  // "AtomicWrite":                                                          //
+  //=========================================================================//
+  // Writes the header followed by the data into a temporary file in the same
+  // dir, "fsync"s it and atomically renames it into "a_file", so concurrent
+  // processes never see a partially-written file (and a crash cannot leave a
+  // truncated one behind). Returns "false" on any error, in which case the
+  // temporary file is removed and "a_file" is not modified:
+  //
+  bool AtomicWrite
+  (
+    std::string const& a_file,
+    void const*        a_hdr,
+    size_t             a_hdr_len,
+    void const*        a_data,
+    size_t             a_data_len
+  );
+
+  //=========================================================================//
+  // "MappedFile": RAII wrapper for a read-only "mmap"ed file:               //
+  //=========================================================================//
+  class MappedFile
+  {
+  private:
+    void*  m_addr;
+    size_t m_len;
+
+  public:
+    MappedFile() noexcept: m_addr(nullptr), m_len(0) {}
+
+    MappedFile(MappedFile const&)            = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    ~MappedFile() { Unmap(m_addr, m_len); }
+
+    // Maps the whole file, which must be non-empty; returns "false" if it
+    // cannot be opened or mapped:
+    bool Map(std::string const& a_file);
+
+    void const* Addr() const { return m_addr; }
+    size_t      Len () const { return m_len;  }
+
+    // Transfers the ownership of the mapping to the caller, who must then
+    // release it via "Unmap":
+    void* Release() noexcept
+    {
+      void* addr = m_addr;
+      m_addr     = nullptr;
+      m_len      = 0;
+      return addr;
+    }
+
+    // Releases a mapping (a no-op for "nullptr"):
+    static void Unmap(void* a_addr, size_t a_len) noexcept;
+  };
+}
+// End namespace SpaceBallistics::CacheFile
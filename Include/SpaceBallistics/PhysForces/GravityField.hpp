@@ -7,24 +7,40 @@
 #include "SpaceBallistics/CoOrds/Bodies.h"
 #include "SpaceBallistics/CoOrds/BodyCentricCOSes.h"
 #include "SpaceBallistics/PhysForces/BodyData.hpp"
+#include "SpaceBallistics/PhysForces/GravityModel.h"
+#include "SpaceBallistics/SIMD.hpp"
+#include "SpaceBallistics/ThreadPool.hpp"
+#include "SpaceBallistics/XNumber.hpp"
+#include <boost/align/aligned_allocator.hpp>
 #include <type_traits>
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
 #include <cmath>
 #include <stdexcept>
-#include <gsl/gsl_sf_legendre.h>
 
 namespace SpaceBallistics
 {
   //=========================================================================//
   // "GravityField" Class:                                                   //
   //=========================================================================//
-  // Provides the Gravitational Field Model for the given Body:
+  // Provides the Gravitational Field Model for the given Body.
+  // Objects of this class are "evaluators": they own the (cache-aligned) work
+  // buffers which are re-used across the calls, so they stay warm in the cache
+  // and are not allocated on the stack (which, for the high-degree models, may
+  // require over 1 MB). An evaluator must NOT be shared between threads; the
+  // static "GravAcc" uses a separate evaluator for each calling thread.
+  // By default, an evaluator uses the model compiled in for the given Body
+  // ("s_coeffs" with the consts below);  alternatively, it can be constructed
+  // from a run-time "GravityModel":
   //
   template<Body BodyName>
   class GravityField
   {
   public:
     //=======================================================================//
-    // Consts:                                                               //
+    // Consts of the Compiled-In Model:                                      //
     //=======================================================================//
     // Equatorial Radius of the Body (used in the Gravitational Potential exp-
     // ansion):
@@ -33,11 +49,21 @@ namespace SpaceBallistics
     // Gravitational Field Constant of the Body:
     constexpr static GM  K  = BodyData<BodyName>::K;
 
+    // The Max Degree and Order of Spherical Harmonics available:
+    constexpr static int N = BodyData<BodyName>::MaxSpherHarmDegreeAndOrder;
+
+    // For use as the "a_n" arg below:  the Max Degree and Order of the model
+    // actually used by the evaluator:
+    constexpr static int FullDeg = -1;
+
     //=======================================================================//
     // Model Coeffs:                                                         //
     //=======================================================================//
     // The struct for Dimension-Less Spherical Harmonics Coeffs representing the
-    // Gravitational Potential, with Geodesy-style normalisation (to 4*Pi):
+    // Gravitational Potential, with Geodesy-style normalisation (to 4*Pi). This
+    // is the source format of the compiled-in coeffs ("s_coeffs", defined in
+    // the generated "GravityPotential-*.cpp" files); the evaluators use them
+    // packed into the layout of "GravityModel.h" (see "Packed"):
     //
     struct SpherHarmonicCoeffs
     {
@@ -48,18 +74,43 @@ namespace SpaceBallistics
       double const m_Slm;    // Coeff at Sin
     };
 
-    // The Max Degree and Order of Spherical Harmonics available:
-    constexpr static int N = BodyData<BodyName>::MaxSpherHarmDegreeAndOrder;
+    constexpr static int ColIdx(int a_m)
+      { return GravityModel::ColIdx(a_m, N); }
+
+    constexpr static int CoeffIdx(int a_l, int a_m)
+      { return GravityModel::CoeffIdx(a_l, a_m, N); }
 
   private:
     // Actual Coeffs:
     static_assert(N == 0 || N >= 2);
-    static SpherHarmonicCoeffs const s_coeffs[N == 0 ? 0 : ((N+1)*(N+2))/2];
+    static SpherHarmonicCoeffs const s_coeffs[GravityModel::NCoeffs(N)];
+
+    //-----------------------------------------------------------------------//
+    // "Packed": The Compiled-In Coeffs in the "GravityModel" Layout:        //
+    //-----------------------------------------------------------------------//
+    // Packed once, on first use (thread-safe), and shared by all evaluators:
+    //
+    static PackedSHCoeffs const* Packed()
+    {
+      static std::vector<PackedSHCoeffs> const packed =
+        GravityModel::Pack(s_coeffs, size_t(GravityModel::NCoeffs(N)), N);
+      return packed.data();
+    }
+
+  public:
+    //-----------------------------------------------------------------------//
+    // "Coeffs": Access by (l,m):                                            //
+    //-----------------------------------------------------------------------//
+    static PackedSHCoeffs const& Coeffs(int a_l, int a_m)
+      { return Packed()[CoeffIdx(a_l, a_m)]; }
 
   public:
     //-----------------------------------------------------------------------//
-    // For convenience: Exception thrown on "impact" (actually when r <= Re) //
+    // For convenience: Exception thrown on "impact":                        //
     //-----------------------------------------------------------------------//
+    // Actually when r <= "ImpactRadius()" (Re by default, see "SetImpact-
+    // Radius"):
+    //
     struct ImpactExn
     {
       Time   const m_t;      // Time
@@ -69,171 +120,2655 @@ namespace SpaceBallistics
     };
 
 
+  private:
     //=======================================================================//
-    // Gravitational Acceleration Computation:                               //
+    // Internal Utils:                                                       //
     //=======================================================================//
-    // The function ADDS the components of the gravitational  acceleration vec-
-    // tor to the output vector "acc",  so the latter must be properly initial-
-    // ised (eg zeroed-out) before calling this function.
-    // NB: "pos" and "acc" are in the BodyCentricRotatingCOS (which is embedded
-    // in the Body is and rotating with it):
-    //
-    static void GravAcc
-    (
-      Time                     a_t,                  // For info only
-      PosVRot<BodyName> const& a_pos,
-      AccVRot<BodyName>*       a_acc,
-      int                      a_n          = N,     // Max order used
-      bool                     a_zonal_only = false  // Zonal Harmonics only?
-    )
+    //-----------------------------------------------------------------------//
+    // "Degree": Checks the requested Degree and resolves "FullDeg":         //
+    //-----------------------------------------------------------------------//
+    int Degree(int a_n) const
     {
-      //---------------------------------------------------------------------//
-      // Checks:                                                             //
-      //---------------------------------------------------------------------//
-      static_assert(N >= 0 && IsPos(K) && IsPos(Re));
-      assert(a_acc != nullptr);
+      if (a_n == FullDeg)
+        return m_N;
 
       if (UNLIKELY(a_n < 0 || a_n == 1))
         throw std::invalid_argument
               ("GravAcc: Invalid Order (must be 0 or >= 2");
 
-      if (UNLIKELY(a_n > N))
+      if (UNLIKELY(a_n > m_N))
         throw std::invalid_argument("GravAcc: Requested Order too high");
+      return a_n;
+    }
 
-      //---------------------------------------------------------------------//
-      // The Rectangular and Spherical CoOrds:                               //
-      //---------------------------------------------------------------------//
-      // (In BodyCentricRotatingCOS):
-      Len  x       = a_pos[0];
-      Len  y       = a_pos[1];
-      Len  z       = a_pos[2];
-      Len2 r2xy    = Sqr(x) + Sqr(y);
-      Len2 r2      = r2xy   + Sqr(z);
-      Len  r       = SqRt(r2);
+    //-----------------------------------------------------------------------//
+    // "Col": Column "m" of the coeffs, indexed by "l" (from "m"):           //
+    //-----------------------------------------------------------------------//
+    PackedSHCoeffs const* Col(int a_m) const
+    {
+      assert(0 <= a_m && a_m <= m_N);
+      return m_coeffs + (GravityModel::ColIdx(a_m, m_NS) - a_m);
+    }
+
+    //-----------------------------------------------------------------------//
+    // "Impact":                                                             //
+    //-----------------------------------------------------------------------//
+    // Points below the impact radius are not allowed: Divergence may occur.
+    // We treat this as a "surface impact" event, though it might not be a
+    // physical impact yet (we are under the impact sphere, possibly not under
+    // the local terrain):
+    //
+    [[noreturn]] void Impact(Time a_t, Len a_x, Len a_y, Len a_z) const
+    {
+      Len2 r2xy   = Sqr(a_x) + Sqr(a_y);
+      Len  r      = SqRt(r2xy  + Sqr(a_z));
+      double const phi     = ASin (double(a_z/r));
+      double const lambda  =
+        IsZero(r2xy) ? 0.0 : ATan2(a_x.Magnitude(), a_y.Magnitude());
 
-      if (UNLIKELY(r <= Re))
+      throw ImpactExn{ a_t, r - m_Re, Angle(lambda), Angle(phi) };
+    }
+
+    //-----------------------------------------------------------------------//
+    // "MkDegreeBounds":                                                     //
+    //-----------------------------------------------------------------------//
+    // For each degree "l", the contribution of all terms of that degree to the
+    // acceleration is bounded by
+    //   K/r^2 * (Re/r)^l * w(l),  w(l) = (2l+1) * SqRt(l+1) * sigma(l),
+    //   sigma(l) = SqRt(Sum_m (C(l,m)^2 + S(l,m)^2)).
+    // This follows from the Cauchy-Schwarz inequality and the addition theorem
+    // for the 4*Pi-normalised harmonics,  which gives Sum_m {Y^2} = 2l+1  and
+    // Sum_m {|grad_S Y|^2} = l(l+1)(2l+1) at any point of the unit sphere;  the
+    // radial derivative brings the factor (l+1). The bound is rigorous, though
+    // usually pessimistic (by a factor ~ SqRt(l)).  The table "w" is computed
+    // from the model coeffs by the Ctor:
+    //
+    void MkDegreeBounds()
+    {
+      m_degBounds.assign(size_t(m_N+1), 0.0);
+      for (int l = 2; l <= m_N; ++l)
       {
-        // Inner points are not allowed: Divergence may occur. We treat this as
-        // a "surface impact" event,   though it might not be a physical impact
-        // yet (we are under the Equatorial Radius, possibly not the local one):
-        double const phi     = ASin (double(z/r));
-        double const lambda  =
-          IsZero(r2xy) ? 0.0 : ATan2(x.Magnitude(), y.Magnitude());
+        double sigma2 = 0.0;
+        for (int m = 0; m <= l; ++m)
+        {
+          PackedSHCoeffs const& SHC = Col(m)[l];
+          sigma2 += Sqr(SHC.m_Clm) + Sqr(SHC.m_Slm);
+        }
+        m_degBounds[size_t(l)] =
+          double(2*l+1) * SqRt(double(l+1)) * SqRt(sigma2);
+      }
+    }
+
+    //=======================================================================//
+    // Recursion Coeffs for the Normalised Associated Legendre Functions:    //
+    //=======================================================================//
+    // For the fully-normalised (to 4*Pi) functions P(l,m) (without the Condon-
+    // Shortley phase), the "column" (fixed "m") recursion in "l" is
+    //   P(l,m) = a(l,m) * t * P(l-1,m) - b(l,m) * P(l-2,m),    t = sin(phi),
+    //   a(l,m) = SqRt((2l-1)(2l+1) / ((l-m)(l+m))),
+    //   b(l,m) = a(l,m) / a(l-1,m),
+    // and the latitude derivative is given by
+    //   u * dP(l,m)/d(phi) = f(l,m) * P(l-1,m) - l * t * P(l,m),
+    //   u = cos(phi),            f(l,m) = (2l+1) / a(l,m).
+    // All those coeffs are products of tabulated SqRts of integers (see the
+    // Data Flds below), so we do not need to store them for every (l,m).
+    // NB: The recursion is stable for all degrees of practical interest; the
+    // sectoral terms P(m,m) ~ cos(phi)^m may underflow near the poles, while
+    // the column is still significant (for degrees above ~1900), so they are
+    // kept in the extended range (see "Sectoral"):
+    //
+    //=======================================================================//
+    // "SumSH": Lane-Generic Summation of the Spherical Harmonics:           //
+    //=======================================================================//
+    // Computes the dimension-less sums "F" such that the acceleration is
+    // K/r^2 * (F - A), where "A" is the unit radius-vector and "ir" = Re/r.
+    // "V" is either "double" or a SIMD vector type; in the latter case, each
+    // lane corresponds to a separate position, and the model coeffs are loaded
+    // only once for all lanes.
+    // The Legendre functions (with the (Re/r)^l factors absorbed) are generated
+    // by the column recursion (with the coeffs tabulated in "m_sq", "m_isq",
+    // "m_p" and "m_ip", see the Ctor) and consumed immediately,  so no arrays
+    // are required. For each column "m", the sums are first accumulated
+    // separately for the Cos and Sin coeffs, and only then combined with
+    // Cos(m*lambda) and Sin(m*lambda).
+    // If "FixedN" is non-0, it is the compile-time degree which overrides the
+    // "a_n" arg (see "SumSHFixed"):
+    //
+    template<typename V, int FixedN = 0>
+    void SumSH
+    (
+      V const a_A[3],
+      V       a_ir,
+      int     a_n,
+      bool    a_zonal_only,
+      V       a_F[3]
+    )
+    const
+    {
+      V S[3];
+      if constexpr (FixedN != 0)
+        SumSHFixed<V, FixedN>(a_A, a_ir, a_zonal_only, S);
+      else
+        SumSHCols<V>(a_A, a_ir, a_n, 0, a_zonal_only ? 0 : a_n, S);
+      SHToF(a_A, S, a_F);
+    }
+
+    //-----------------------------------------------------------------------//
+    // "SumSHFixed": "SumSHCols" over all Columns, for a Compile-Time Degree://
+    //-----------------------------------------------------------------------//
+    // Both the column index "M" and the degree "L" are compile-time consts
+    // (the loops are folds over them), and so are the recursion coeffs (see
+    // "FixedRec"), so the whole summation is unrolled into straight-line code
+    // with the coeffs as immediate operands. Only the model coeffs are loaded
+    // at run time (the compiled-in ones are defined in a separate TU,  and a
+    // run-time model may be used as well), from the offsets which are consts
+    // as well.
+    // For such low degrees, the column values are within a factor of 2^100 of
+    // the sectoral term, so if the latter underflows in "double",  the whole
+    // column is negligible, and the extended range (see "Sectoral") is not
+    // required:
+    //
+    constexpr static int MaxFixedDeg = 36;
+
+    template<typename V, int Deg>
+    void SumSHFixed
+    (
+      V const a_A[3],
+      V       a_ir,
+      bool    a_zonal_only,
+      V       a_S[3]
+    )
+    const
+    {
+      static_assert(2 <= Deg && Deg <= MaxFixedDeg);
+      assert(Deg <= m_N);
+
+      V const t   = a_A[2];
+      V u, iu, cl, sl;
+      Angles(a_A, &u, &iu, &cl, &sl);
+      V const iru = a_ir * u;
 
-        throw ImpactExn{ a_t, r - Re, Angle(lambda), Angle(phi) };
+      // As in "SumSHCols":
+      V S1 = Splat<V>(0.0);
+      V S2 = S1;
+      V S3 = S1;
+      V cm  = Splat<V>(1.0);
+      V sm  = Splat<V>(0.0);
+      V Qmm = Splat<V>(1.0);
+
+      // Columns M = 0 .. Deg (only M = 0 if "a_zonal_only"):
+      [&]<int... Ms>(std::integer_sequence<int, Ms...>)
+      {
+        (void) (... &&
+          ColFixed<V, Deg, Ms>
+            (t, a_ir, cl, sl, iru, &cm, &sm, &Qmm, &S1, &S2, &S3,
+             a_zonal_only));
       }
+      (std::make_integer_sequence<int, Deg+1>());
 
-      // If OK: Main part of the Gravitational Acceleration:
-      Acc  mainAcc = K / r2;
+      a_S[0] = S1;
+      a_S[1] = S2;
+      a_S[2] = S3;
+    }
 
-      if (a_n == 0)
+    //-----------------------------------------------------------------------//
+    // "FixedRec": Compile-Time Recursion Coeffs for "SumSHFixed":           //
+    //-----------------------------------------------------------------------//
+    // m_a[l][m] = a(l,m),  m_b[l][m] = b(l,m)  (see above),  m_f[l][m] = f(l,m)
+    // (0 for l=m), and the sectoral step m_s[m] = (Re/r)^(m+1) * P(m+1,m+1) /
+    // ((Re/r)^m * P(m,m) * iru). They are computed from the SqRts of integers
+    // in the same way as in "ColSumsFrom" and "NextOrder", so the results are
+    // the same as those of the generic path:
+    //
+    template<int Deg>
+    struct FixedRecCoeffs
+    {
+      double m_a[Deg+1][Deg+1] {};
+      double m_b[Deg+1][Deg+1] {};
+      double m_f[Deg+1][Deg+1] {};
+      double m_s[Deg+1]        {};
+    };
+
+    template<int Deg>
+    constexpr static FixedRecCoeffs<Deg> FixedRec = []()
+    {
+      FixedRecCoeffs<Deg> rc;
+      auto sq  = [](int a_k) { return SqRt(double(a_k)); };
+      auto isq = [&](int a_k) { return 1.0 / sq(a_k); };
+      for (int m = 0; m <= Deg; ++m)
       {
-        // Trivial Case: Spherically-Symmetric Gravitational Field:
-        for (size_t i = 0; i < 3; ++i)
-          (*a_acc)[i] = - mainAcc * a_pos[i] / r;
-        return;
+        rc.m_s[m] = (m == 0) ? sq(3) : sq(2*m+3) * isq(2*m+2);
+        double ia = 0.0;    // 1/a(l,m), as in "ColSumsFrom"
+        for (int l = m+1; l <= Deg; ++l)
+        {
+          double const p = sq(2*l-1) * sq(2*l+1);
+          rc.m_a[l][m]   = p * isq(l-m) * isq(l+m);
+          rc.m_b[l][m]   = rc.m_a[l][m] * ia;
+          ia             = (1.0 / p) * sq(l-m) * sq(l+m);
+          rc.m_f[l][m]   = double(2*l+1) * ia;
+        }
       }
-      //---------------------------------------------------------------------//
-      // GENERAL CASE: Will sum up the Spherical Harmonics:                  //
-      //---------------------------------------------------------------------//
-      constexpr double SqRt4Pi = 2.0 * SqRt(Pi<double>);
+      return rc;
+    }();
 
-      // Re / r:
-      double const ir = double(Re / r);
-      assert(ir < 1.0);
+    //-----------------------------------------------------------------------//
+    // "ColFixed": The Column "M" for "SumSHFixed":                          //
+    //-----------------------------------------------------------------------//
+    // Adds the contribution of the column to "S", and advances the sectoral
+    // term and Cos/Sin(m*lambda) to M+1. Returns "false" iff the subsequent
+    // columns are not required:
+    //
+    template<typename V, int Deg, int M>
+    bool ColFixed
+    (
+      V a_t, V a_ir, V a_cl, V a_sl, V a_iru, V* a_cm, V* a_sm, V* a_Qmm,
+      V* a_S1, V* a_S2, V* a_S3, bool a_zonal_only
+    )
+    const
+    {
+      constexpr FixedRecCoeffs<Deg> const& RC = FixedRec<Deg>;
+      PackedSHCoeffs const* col = Col(M);
 
-      // The Latitude (via its Sin):
-      double const sinPhi  = double(z / r);
+      V const irt = a_ir * a_t;
+      V const ir2 = a_ir * a_ir;
+      V       Q   = *a_Qmm;
+      V       Q1  = Splat<V>(0.0);
+      V a1 = Splat<V>(0.0), b1 = a1, a2 = a1, b2 = a1, a3 = a1, b3 = a1;
 
-      // The Longitude: Undefined if rXY=0, assume Lambda=0 in that case:
-      double const lambda  =
-        IsZero(r2xy) ? 0.0 : ATan2(x.Magnitude(), y.Magnitude());
+      // Degrees L = M .. Deg, as in "ColSumsFrom":
+      [&]<int... Ks>(std::integer_sequence<int, Ks...>)
+      {
+        ([&]()
+        {
+          constexpr int L = M + Ks;
+          if constexpr (L >= 2)
+          {
+            PackedSHCoeffs const& SHC = col[L];
 
-      // Pre-compute Cos(m*lambda), Sin(m*lambda) for m = 0..a_n:
-      assert(2 <= a_n && a_n <= N);
+            V uDQ = RC.m_f[L][M] * a_ir * Q1 - double(L) * a_t * Q;
+            V lQ  = double(L+1) * Q;
 
-      double cosMLambda[N+1];
-      double sinMLambda[N+1];
-      for (int m = 0; m <= a_n; ++m)
+            a1 += uDQ * SHC.m_Clm;
+            b1 += uDQ * SHC.m_Slm;
+            a2 += lQ  * SHC.m_Clm;
+            b2 += lQ  * SHC.m_Slm;
+            a3 += Q   * SHC.m_Clm;
+            b3 += Q   * SHC.m_Slm;
+          }
+          if constexpr (L < Deg)
+          {
+            V Qn = RC.m_a[L+1][M] * irt * Q - RC.m_b[L+1][M] * ir2 * Q1;
+            Q1   = Q;
+            Q    = Qn;
+          }
+        }(), ...);
+      }
+      (std::make_integer_sequence<int, Deg-M+1>());
+
+      *a_S1 += *a_cm * a1 + *a_sm * b1;
+      *a_S2 += *a_cm * a2 + *a_sm * b2;
+      *a_S3 += double(M) * (*a_cm * b3 - *a_sm * a3);
+
+      if (a_zonal_only)
+        return false;
+      if constexpr (M < Deg)
       {
-        double ml = double(m) * lambda;
-        cosMLambda[m] = Cos(ml);
-        sinMLambda[m] = Sin(ml);
+        *a_Qmm *= RC.m_s[M] * a_iru;
+        V cn  = *a_cm * a_cl - *a_sm * a_sl;
+        *a_sm = *a_sm * a_cl + *a_cm * a_sl;
+        *a_cm = cn;
       }
-      // Buffers for Legendre Polynomials and Derivatives computation, as per
-      // GSL requirements. XXX: Is stack overflow possible here?
-      constexpr int NP = ((N+6)*(N+1))/2;
-      assert(gsl_sf_legendre_array_n(size_t(N)) == size_t(NP));
-      double Ps    [NP];
-      double DerPs [NP];
+      return true;
+    }
 
-      // Pre-Compute the Legendre Polynomials and their Derivatives up to order
-      // l_max = a_n <= N:
-      DEBUG_ONLY(int rc =)
-        gsl_sf_legendre_deriv_array
-          (GSL_SF_LEGENDRE_SPHARM, size_t(a_n), sinPhi, Ps, DerPs) ;
-      assert(rc == 0);
+    //-----------------------------------------------------------------------//
+    // "Angles": sin(phi), cos(phi), and cos(lambda), sin(lambda):           //
+    //-----------------------------------------------------------------------//
+    // On the polar axis, lambda is undefined, so we assume lambda=0 there:
+    //
+    template<typename V>
+    static void Angles(V const a_A[3], V* a_u, V* a_iu, V* a_cl, V* a_sl)
+    {
+      *a_u  = SqRtV(a_A[0] * a_A[0] + a_A[1] * a_A[1]);
+      *a_iu = 1.0 / *a_u;
+      *a_cl = a_A[0] * *a_iu;
+      *a_sl = a_A[1] * *a_iu;
+      for (int k = 0; k < SIMDTraits<V>::Lanes; ++k)
+        if (UNLIKELY(GetLane(*a_u, k) == 0.0))
+        {
+          SetLane(a_cl, k, 1.0);
+          SetLane(a_sl, k, 0.0);
+        }
+    }
 
-      // dr/d{x,y,z}:
-      double const A[3]       { double(x/r),   double(y/r),     double(z/r)  };
+    //-----------------------------------------------------------------------//
+    // "SumSHCols": The Sums over the Columns "m0..m1" only:                  //
+    //-----------------------------------------------------------------------//
+    // Returns the partial sums "S" (see below) which are linear in the coeffs,
+    // so the sums over disjoint column ranges can be added up, and then conv-
+    // erted into "F" by "SHToF". The starting values for the column "m0" are
+    // obtained by the same recursion as in the sequential case, so the terms
+    // themselves do not depend on the partitioning of the columns:
+    //
+    template<typename V>
+    void SumSHCols
+    (
+      V const a_A[3],
+      V       a_ir,
+      int     a_n,
+      int     a_m0,
+      int     a_m1,
+      V       a_S[3]
+    )
+    const
+    {
+      int const n = a_n;
+      assert(2 <= n && n <= m_N && 0 <= a_m0 && a_m1 <= n);
 
-      // r * d(phi)/d{x,y,z}:
-      double const B[3]
-        { double(- x*z / r2),   double(- y*z / r2),   1.0 - Sqr(double(z/r)) };
+      V const t   = a_A[2];
+      V u, iu, cl, sl;
+      Angles(a_A, &u, &iu, &cl, &sl);
+      V const iru = a_ir * u;
 
-      // r * d(lambda)/d{x,y,z}:
-      double const C[3]
-        { double(- r*y / r2xy), double(  r*x / r2xy), 0.0 };
+      // Sums over (l,m) of (Re/r)^l * {u * dP/d(phi), (l+1) * P, m * P},  with
+      // the corresp coeffs and Cos/Sin(m*lambda) factors:
+      V S1 = Splat<V>(0.0);
+      V S2 = S1;
+      V S3 = S1;
 
-      //---------------------------------------------------------------------//
-      // Sum over the Spherical Harmonics (l,m):                             //
-      //---------------------------------------------------------------------//
-      double F[3]  {0.0, 0.0, 0.0};
-      double irl = Sqr(ir);
+      // Running Cos(m*lambda), Sin(m*lambda) and (Re/r)^m * P(m,m):
+      V           cm  = Splat<V>(1.0);
+      V           sm  = Splat<V>(0.0);
+      Sectoral<V> Qmm;
 
-      for (int l = 2; l <= a_n; ++l)
+      for (int m = 0; m < a_m0; ++m)
+        NextOrder(m, cl, sl, iru, &cm, &sm, &Qmm);
+
+      for (int m = a_m0; m <= a_m1; ++m)
       {
-        double mSum[3] {0.0, 0.0, 0.0};
-        double l1   =  double(l+1);
-        double Al1 [3] {A[0]*l1, A[1]*l1, A[2]*l1};
-        int    j    =  (l*(l+1))/2;
-        int    maxM =  a_zonal_only ? 0 : l;
+        // Column sums for the Cos (a*) and Sin (b*) coeffs:
+        V ab[6];
+        ColSumsAny
+        (
+          m, n, t, a_ir, Qmm, ab,
+          [&](V a_Q, V a_abD[6]) { ColSums(m, n, t, a_ir, a_Q, a_abD); }
+        );
+
+        S1 += cm * ab[0] + sm * ab[1];
+        S2 += cm * ab[2] + sm * ab[3];
+        S3 += double(m) * (cm * ab[5] - sm * ab[4]);
+
+        if (m == a_m1)
+          break;
+        NextOrder(m, cl, sl, iru, &cm, &sm, &Qmm);
+      }
+      a_S[0] = S1;
+      a_S[1] = S2;
+      a_S[2] = S3;
+    }
+
+    //-----------------------------------------------------------------------//
+    // "ColSums": The Sums over the Column "m":                              //
+    //-----------------------------------------------------------------------//
+    // Sums over l = max(m,2) .. n of (Re/r)^l * {u * dP/d(phi), (l+1) * P, P}
+    // with the C(l,m) and S(l,m) coeffs, in the order
+    //   {a1, b1, a2, b2, a3, b3}, "a" for C(l,m), "b" for S(l,m).
+    // "a_Qmm" is (Re/r)^m * P(m,m):
+    //
+    template<typename V>
+    void ColSums(int a_m, int a_n, V a_t, V a_ir, V a_Qmm, V a_ab[6]) const
+    {
+      ColSumsFrom
+        (a_m, 1, &a_n, a_m, a_t, a_ir, a_Qmm, Splat<V>(0.0), 0.0, a_ab);
+    }
+
+    //-----------------------------------------------------------------------//
+    // "ColSumsFrom": Same as "ColSums", Starting from the Degree "l0":      //
+    //-----------------------------------------------------------------------//
+    // (The terms of degrees below "l0" are omitted). "a_Q" and "a_Q1" are the
+    // scaled Legendre functions of degrees "l0" and "l0-1", and "a_ia" is
+    // 1/a(l0,m) (0 if l0=m).
+    // The sums are returned for "a_ns" max degrees "a_degs" (in the ascending
+    // order), 6 per degree, in "a_ab" (of size 6*a_ns);  each set contains all
+    // terms up to the corresp degree. As the column is traversed only once,
+    // the extra sets are almost free (see "SumSHMulti"):
+    //
+    template<typename V>
+    void ColSumsFrom
+    (
+      int a_m, int a_ns, int const* a_degs, int a_l0, V a_t, V a_ir, V a_Q,
+      V a_Q1, double a_ia, V* a_ab
+    )
+    const
+    {
+      assert(0 < a_ns && a_degs != nullptr && a_degs[a_ns-1] <= m_N);
+      double const* sq  = m_sq .data();
+      double const* isq = m_isq.data();
+      double const* p   = m_p  .data();
+      double const* ip  = m_ip .data();
 
-        for (int  m = 0; m <= maxM; ++m)
+      V const irt = a_ir * a_t;
+      V const ir2 = a_ir * a_ir;
+      int const m = a_m;
+      int const n = a_degs[a_ns-1];
+
+      V a1 = Splat<V>(0.0), b1 = a1, a2 = a1, b2 = a1, a3 = a1, b3 = a1;
+
+      V      Q   = a_Q;             // (Re/r)^l     * P(l,  m), from l=l0
+      V      Q1  = a_Q1;            // (Re/r)^(l-1) * P(l-1,m); P(m-1,m)=0
+      double ia  = a_ia;            // 1/a(l,m);  0 for l=m, so b(m+1,m)=0
+
+      // Column "m" of the coeffs, indexed by "l":
+      PackedSHCoeffs const* col = Col(m);
+
+      int l = a_l0;
+      for (int j = 0; j < a_ns; ++j)
+      {
+        while (l <= a_degs[j])
         {
-          assert(m <= a_n);
-          double c  = cosMLambda[m];
-          double s  = sinMLambda[m];
+          if (l >= 2)
+          {
+            PackedSHCoeffs const& SHC = col[l];
+
+            V uDQ = double(2*l+1) * ia * a_ir * Q1 - double(l) * a_t * Q;
+            V lQ  = double(l+1) * Q;
 
-          // Index for accessing Legendre Polys and Model Coeffs:
-          int    jm = j + m;
-          assert(jm < ((a_n+1)*(a_n+2))/2);
+            a1 += uDQ * SHC.m_Clm;
+            b1 += uDQ * SHC.m_Slm;
+            a2 += lQ  * SHC.m_Clm;
+            b2 += lQ  * SHC.m_Slm;
+            a3 += Q   * SHC.m_Clm;
+            b3 += Q   * SHC.m_Slm;
+          }
+          if (++l > n)
+            break;
 
-          SpherHarmonicCoeffs SHC = s_coeffs[jm];
-          assert(SHC.m_l == l && SHC.m_m == m);
-          double P  = Ps   [jm];
-          double P1 = DerPs[jm];
+          // Next degree:
+          double a = p [l] * isq[l-m] * isq[l+m];
+          double b = a * ia;        // "ia" is still 1/a(l-1,m) here
+          ia       = ip[l] * sq [l-m] * sq [l+m];
 
-          for (int i = 0; i < 3; ++i)
-            mSum[i] +=
-              (B[i] * P1 - Al1[i] * P) * (SHC.m_Clm * c + SHC.m_Slm * s) +
-              double(m)  * C[i]   * P  * (SHC.m_Slm * c - SHC.m_Clm * s);
+          V Qn = a * irt * Q - b * ir2 * Q1;
+          Q1   = Q;
+          Q    = Qn;
         }
-        for (int i = 0; i < 3; ++i)
-          F[i] += mSum[i] * irl;
-        irl *= ir;
+        V* ab = a_ab + 6 * j;
+        ab[0] = a1;
+        ab[1] = b1;
+        ab[2] = a2;
+        ab[3] = b2;
+        ab[4] = a3;
+        ab[5] = b3;
       }
-      //---------------------------------------------------------------------//
-      // Finally:                                                            //
-      //---------------------------------------------------------------------//
-      for (size_t i = 0; i < 3; ++i)
+    }
+
+    //-----------------------------------------------------------------------//
+    // "Sectoral": (Re/r)^m * P(m,m) in the Extended Range:                  //
+    //-----------------------------------------------------------------------//
+    // The sectoral terms decrease as cos(phi)^m, so near the poles and for
+    // high degrees, they underflow in "double"  (eg cos(phi)^m < 1e-308 for
+    // phi=89 deg and m > 175),  whereas the column recursion may bring the
+    // subsequent terms back into the significant range. So in each lane, the
+    // value is kept as an "XNum" (see "XNumber.hpp"):  m_Q * XBig^m_e.  The
+    // lanes with m_e=0 (ie values >= 2^-480) are processed by the "double"
+    // column recursion, the others by "ColSumsX":
+    //
+    template<typename V>
+    struct Sectoral
+    {
+      V   m_Q = Splat<V>(1.0);
+      int m_e[SIMDTraits<V>::Lanes] {};
+
+      XNum Lane(int a_k) const
+        { return XNum{ double(GetLane(m_Q, a_k)), m_e[a_k] }; }
+    };
+
+    //-----------------------------------------------------------------------//
+    // "NextOrder": (Re/r)^(m+1) * P(m+1,m+1), Cos/Sin((m+1)*lambda):         //
+    //-----------------------------------------------------------------------//
+    template<typename V>
+    void NextOrder
+    (
+      int a_m, V a_cl, V a_sl, V a_iru, V* a_cm, V* a_sm, Sectoral<V>* a_Qmm
+    )
+    const
+    {
+      a_Qmm->m_Q *=
+        ((a_m == 0) ? m_sq[3] : m_sq[size_t(2*a_m+3)] * m_isq[size_t(2*a_m+2)])
+        * a_iru;
+      for (int k = 0; k < SIMDTraits<V>::Lanes; ++k)
+        if (UNLIKELY(Abs(GetLane(a_Qmm->m_Q, k)) < XBigSI))
+        {
+          XNum x = a_Qmm->Lane(k);
+          XNorm(&x);
+          SetLane(&a_Qmm->m_Q, k, x.m_f);
+          a_Qmm->m_e[k] = x.m_e;
+        }
+      V cn  = *a_cm * a_cl - *a_sm * a_sl;
+      *a_sm = *a_sm * a_cl + *a_cm * a_sl;
+      *a_cm = cn;
+    }
+
+    //-----------------------------------------------------------------------//
+    // "ColSumsAny": Column Sums for Sectoral Terms of Any Magnitude:        //
+    //-----------------------------------------------------------------------//
+    // The lanes with the sectoral terms in the "double" range are processed by
+    // the kernel "a_kern" (invoked as a_kern(Qmm, ab), with the other lanes of
+    // "Qmm" zeroed-out), and the others (normally, none) one-by-one by "Col-
+    // SumsX", unless the whole column is negligible in them (see "ColGrowth").
+    // As in "ColSumsFrom", the sums may be requested for several max degrees
+    // "a_degs" at once, then "a_ab" is of size 6*a_ns:
+    //
+    template<typename V, typename Kernel>
+    void ColSumsAny
+    (
+      int                a_m,
+      int                a_ns,
+      int const*         a_degs,
+      V                  a_t,
+      V                  a_ir,
+      Sectoral<V> const& a_Qmm,
+      V*                 a_ab,
+      Kernel const&      a_kern
+    )
+    const
+    {
+      constexpr int NL = SIMDTraits<V>::Lanes;
+      bool ext = false;
+      for (int k = 0; k < NL; ++k)
+        ext = ext || (a_Qmm.m_e[k] != 0);
+
+      if (LIKELY(!ext))
       {
-        // NB: In GSL, the Spherical Harmonics are normalised to 1, not to 4*Pi
-        // as assumed in the "s_coeffs", so compensate for that:
-        F[i] *= SqRt4Pi;
+        a_kern(a_Qmm.m_Q, a_ab);
+        return;
+      }
+      V    Q      = a_Qmm.m_Q;
+      bool normal = false;
+      for (int k = 0; k < NL; ++k)
+        if (a_Qmm.m_e[k] != 0)
+          SetLane(&Q, k, 0.0);
+        else
+          normal = true;
 
-        // And the Main Term:
-        (*a_acc)[i] += mainAcc * (F[i] - A[i]);
+      if (normal)
+        a_kern(Q, a_ab);
+      else
+        for (int j = 0; j < 6 * a_ns; ++j)
+          a_ab[j] = Splat<V>(0.0);
+
+      int const n = a_degs[a_ns-1];
+      for (int k = 0; k < NL; ++k)
+      {
+        XNum const   Qk  = a_Qmm.Lane(k);
+        double const irk = double(GetLane(a_ir, k));
+        if (Qk.m_e == 0 ||
+            XLog2(Qk) + ColGrowth(a_m, n, irk) < NegligibleLog2)
+          continue;
+
+        double abk[6 * MaxSnaps];
+        assert(a_ns <= MaxSnaps);
+        ColSumsX
+          (a_m, a_ns, a_degs, double(GetLane(a_t, k)), irk, Qk, abk);
+        for (int j = 0; j < 6 * a_ns; ++j)
+          SetLane(&a_ab[j], k, GetLane(a_ab[j], k) + abk[j]);
+      }
+    }
+
+    // Same for a single max degree "a_n":
+    template<typename V, typename Kernel>
+    void ColSumsAny
+    (
+      int                a_m,
+      int                a_n,
+      V                  a_t,
+      V                  a_ir,
+      Sectoral<V> const& a_Qmm,
+      V                  a_ab[6],
+      Kernel const&      a_kern
+    )
+    const
+    { ColSumsAny(a_m, 1, &a_n, a_t, a_ir, a_Qmm, a_ab, a_kern); }
+
+    //-----------------------------------------------------------------------//
+    // "ColSumsX": Same as "ColSums", with "a_Qmm" in the Extended Range:     //
+    //-----------------------------------------------------------------------//
+    // (For a single lane, and for "a_ns" max degrees as in "ColSumsFrom"). The
+    // column recursion is performed on "XNum"s  (see "ColStartX") until the
+    // scaled Legendre function gets into the "double" range, and then it con-
+    // tinues as usual:
+    //
+    void ColSumsX
+    (
+      int a_m, int a_ns, int const* a_degs, double a_t, double a_ir,
+      XNum a_Qmm, double* a_ab
+    )
+    const
+    {
+      double Q, Q1, ia;
+      int const l =
+        ColStartX(a_m, a_degs[a_ns-1], a_t, a_ir, a_Qmm, &Q, &Q1, &ia);
+      if (l < 0)
+        std::fill_n(a_ab, 6 * a_ns, 0.0);
+      else
+        ColSumsFrom(a_m, a_ns, a_degs, l, a_t, a_ir, Q, Q1, ia, a_ab);
+    }
+
+    //-----------------------------------------------------------------------//
+    // "ColStartX": Column Recursion in the Extended Range:                  //
+    //-----------------------------------------------------------------------//
+    // Starting from "a_Qmm" (in the extended range), returns the 1st degree
+    // "l" in which the scaled Legendre function is in the "double" range, and
+    // the state of the recursion there (as required by "ColSumsFrom"), or -1
+    // if there is no such l <= n. The terms of degrees below "l" are < 2^-480,
+    // so they are negligible and are not summed up by the callers:
+    //
+    int ColStartX
+    (
+      int a_m, int a_n, double a_t, double a_ir, XNum a_Qmm,
+      double* a_Q, double* a_Q1, double* a_ia
+    )
+    const
+    {
+      double const* sq  = m_sq .data();
+      double const* isq = m_isq.data();
+      double const* p   = m_p  .data();
+      double const* ip  = m_ip .data();
+
+      double const irt = a_ir * a_t;
+      double const ir2 = a_ir * a_ir;
+      int    const m   = a_m;
+
+      // NB: The initial 0 must have the same exponent as "Q" (see "XLinComb"):
+      XNum   Q  = a_Qmm;
+      XNum   Q1 { 0.0, a_Qmm.m_e };
+      double ia = 0.0;
+      int    l  = m;
+      while (Q.m_e < 0)
+      {
+        if (++l > a_n)
+          return -1;
+
+        double a = p [l] * isq[l-m] * isq[l+m];
+        double b = a * ia;
+        ia       = ip[l] * sq [l-m] * sq [l+m];
+
+        XNum Qn  = XLinComb(a * irt, Q, - b * ir2, Q1);
+        Q1       = Q;
+        Q        = Qn;
+      }
+      *a_Q  = XToF(Q);
+      *a_Q1 = XToF(Q1);
+      *a_ia = ia;
+      return l;
+    }
+
+    //-----------------------------------------------------------------------//
+    // "ColGrowth": Bound on the Growth of the Column "m":                   //
+    //-----------------------------------------------------------------------//
+    // Returns log2 of an upper bound of
+    //   |(Re/r)^l * P(l,m)| / ((Re/r)^m * P(m,m)),  m <= l <= n.
+    // As the derivatives of the Legendre polynomials attain their max abs
+    // values on [-1,1] at the end points,
+    //   |P(l,m)| <= P(m,m) * R(l,m),
+    //   R(l,m)^2  = (2l+1)/(2m+1) * (l+m)! / ((l-m)! * (2m)!).
+    // The 1st factor is bounded by its value at l=n,  and the remaining part
+    // multiplied by (Re/r)^(l-m) is unimodal in "l", with the max at the
+    // smallest "l" such that (Re/r)^2 * (l+m+1) <= (l-m+1) (or at l=n if
+    // r <= Re, which is allowed above the impact radius):
+    //
+    double ColGrowth(int a_m, int a_n, double a_ir) const
+    {
+      assert(0 <= a_m && a_m <= a_n && a_n <= m_N && 0.0 < a_ir);
+      double const ir2 = a_ir * a_ir;
+      double const lx  =
+        (ir2 >= 1.0)
+        ? double(a_n)
+        : std::ceil((ir2 * double(a_m + 1) + double(a_m - 1)) / (1.0 - ir2));
+      int    const l   =
+        (lx >= double(a_n)) ? a_n : std::max(a_m, int(lx));
+      double const* lf = m_log2f.data();
+      return
+        0.5 * (std::log2(double(2*a_n+1) / double(2*a_m+1)) +
+               lf[l+a_m] - lf[l-a_m] - lf[2*a_m])
+        + double(l - a_m) * std::log2(a_ir);
+    }
+
+    // The terms below 2^NegligibleLog2 (relative to the central field) are
+    // omitted in the extended-range computations:
+    constexpr static double NegligibleLog2 = -480.0;
+
+    //-----------------------------------------------------------------------//
+    // "SHToF":                                                              //
+    //-----------------------------------------------------------------------//
+    // Finally, apply the derivatives of (phi, lambda) wrt (x, y, z):
+    //   r * grad(phi)    = (-t * cl, -t * sl, u),
+    //   r * grad(lambda) = (-sl / u,  cl / u, 0):
+    //
+    template<typename V>
+    static void SHToF(V const a_A[3], V const a_S[3], V a_F[3])
+    {
+      V const t = a_A[2];
+      V u, iu, cl, sl;
+      Angles(a_A, &u, &iu, &cl, &sl);
+      a_F[0] = - (t * cl * a_S[0] + sl * a_S[2]) * iu - a_A[0] * a_S[1];
+      a_F[1] = - (t * sl * a_S[0] - cl * a_S[2]) * iu - a_A[1] * a_S[1];
+      a_F[2] =    a_S[0]                              - a_A[2] * a_S[1];
+    }
+
+    //-----------------------------------------------------------------------//
+    // "SumSHPar": Same as "SumSH", with the columns split across threads:    //
+    //-----------------------------------------------------------------------//
+    // The columns are partitioned into "NThreads" contiguous chunks of (appr-
+    // oximately) equal work; the number of terms in the column "m" is n-m+1.
+    // The partition depends on "n" and the number of threads only, and the
+    // partial sums are added up in the chunk order, so the result is bitwise
+    // reproducible for a given number of threads (but, in general, differs
+    // from the sequential one by rounding errors).  The partial sums are on
+    // the stack of the calling thread, and the model data are read-only, so
+    // the evaluator is still used by one thread only:
+    //
+    void SumSHPar
+    (
+      double const a_A[3],
+      double       a_ir,
+      int          a_n,
+      bool         a_zonal_only,
+      double       a_F[3],
+      ThreadPool&  a_pool
+    )
+    const
+    {
+      int const nt = a_zonal_only ? 1 : std::min(a_pool.NThreads(), a_n + 1);
+      if (nt == 1)
+      {
+        SumSH<double>(a_A, a_ir, a_n, a_zonal_only, a_F);
+        return;
+      }
+      // Chunk "k" consists of the columns m0[k] .. m0[k+1]-1:
+      std::vector<int>                   m0(static_cast<size_t>(nt + 1), 0);
+      std::vector<std::array<double, 3>> S (static_cast<size_t>(nt));
+      double const total = 0.5 * double(a_n + 1) * double(a_n + 2);
+      double       work  = 0.0;
+      int          k     = 1;
+      for (int m = 0; m <= a_n && k < nt; ++m)
+      {
+        work += double(a_n - m + 1);
+        if (work >= total * double(k) / double(nt))
+          m0[size_t(k++)] = m + 1;
+      }
+      for (; k <= nt; ++k)
+        m0[size_t(k)] = a_n + 1;
+
+      a_pool.ParallelFor
+      (
+        nt,
+        [&](int a_k)
+        {
+          std::array<double, 3>& Sk  = S[size_t(a_k)];
+          int const              beg = m0[size_t(a_k)];
+          int const              end = m0[size_t(a_k + 1)];
+          if (beg < end)
+            SumSHCols<double>(a_A, a_ir, a_n, beg, end - 1, Sk.data());
+          else
+            Sk.fill(0.0);
+        }
+      );
+      // Deterministic reduction:
+      double Sum[3] { 0.0, 0.0, 0.0 };
+      for (std::array<double, 3> const& Sk: S)
+        for (size_t i = 0; i < 3; ++i)
+          Sum[i] += Sk[i];
+      SHToF(a_A, Sum, a_F);
+    }
+
+    //=======================================================================//
+    // "SumSHMulti": Same as "SumSH", for Several Max Degrees at Once:       //
+    //=======================================================================//
+    // Computes "F" for each of the "a_nd" max degrees "a_degs" (in the strict-
+    // ly ascending order, 0 or >= 2), in "a_F" (of size 3*a_nd).  The sums for
+    // the lower degrees are partial sums of those for the higher ones, so all
+    // of them are obtained in one traversal of the columns (see "ColSumsFrom"),
+    // at the cost of the max degree only. The column "m" only contributes to
+    // the degrees >= m. The terms are summed up in the same order as in "Sum-
+    // SH", so the results are the same as those for each degree separately
+    // (up to rounding errors). "V" may be a SIMD type, then each lane is an
+    // independent position (see "MultiAt"):
+    //
+    template<typename V>
+    void SumSHMulti
+    (
+      V const    a_A[3],
+      V          a_ir,
+      int        a_nd,
+      int const* a_degs,
+      V*         a_F
+    )
+    const
+    {
+      assert(0 < a_nd && a_nd <= MaxSnaps && a_degs != nullptr);
+      int const n = a_degs[a_nd-1];
+      assert(2 <= n && n <= m_N);
+
+      V const t = a_A[2];
+      V u, iu, cl, sl;
+      Angles(a_A, &u, &iu, &cl, &sl);
+      V const iru = a_ir * u;
+
+      // The sums "S" (see "SumSHCols") for each degree:
+      V S[3 * MaxSnaps];
+      std::fill_n(S, 3 * a_nd, Splat<V>(0.0));
+
+      V           cm = Splat<V>(1.0);
+      V           sm = Splat<V>(0.0);
+      Sectoral<V> Qmm;
+
+      // "j0" is the index of the lowest degree >= m:
+      int j0 = 0;
+      for (int m = 0; m <= n; ++m)
+      {
+        while (a_degs[j0] < m)
+          ++j0;
+        int const  ns   = a_nd - j0;
+        int const* degs = a_degs + j0;
+
+        V ab[6 * MaxSnaps];
+        ColSumsAny
+        (
+          m, ns, degs, t, a_ir, Qmm, ab,
+          [&](V a_Q, V* a_abD)
+          {
+            ColSumsFrom
+              (m, ns, degs, m, t, a_ir, a_Q, Splat<V>(0.0), 0.0, a_abD);
+          }
+        );
+        for (int j = 0; j < ns; ++j)
+        {
+          V const* abj = ab + 6 * j;
+          V*       Sj  = S  + 3 * (j0 + j);
+          Sj[0] += cm * abj[0] + sm * abj[1];
+          Sj[1] += cm * abj[2] + sm * abj[3];
+          Sj[2] += double(m) * (cm * abj[5] - sm * abj[4]);
+        }
+        if (m == n)
+          break;
+        NextOrder(m, cl, sl, iru, &cm, &sm, &Qmm);
+      }
+      for (int j = 0; j < a_nd; ++j)
+        SHToF(a_A, S + 3 * j, a_F + 3 * j);
+    }
+
+    //=======================================================================//
+    // "PartialsAt": Partials of the Acceleration wrt the Coeffs:            //
+    //=======================================================================//
+    // For a single position (see "Partials" for the layout of the output rows
+    // "a_D0", "a_D1", "a_D2"). As the sums "S" are linear in the coeffs, the
+    // partials wrt C(l,m) and S(l,m) are the individual terms of "SumSHCols"
+    // (with "ab" replaced by the Legendre factors), mapped by "SHToF" (which
+    // is linear in "S" as well) and scaled by K/r^2:
+    //
+    void PartialsAt
+    (
+      Time    a_t,
+      Len     a_x,
+      Len     a_y,
+      Len     a_z,
+      int     a_n,
+      double* a_D0,
+      double* a_D1,
+      double* a_D2
+    )
+    const
+    {
+      Len2 r2 = Sqr(a_x) + Sqr(a_y) + Sqr(a_z);
+      Len  r  = SqRt(r2);
+      if (UNLIKELY(r <= m_rImpact))
+        Impact(a_t, a_x, a_y, a_z);
+
+      size_t const np = size_t(2 * GravityModel::NCoeffs(a_n));
+      std::fill_n(a_D0, np, 0.0);
+      std::fill_n(a_D1, np, 0.0);
+      std::fill_n(a_D2, np, 0.0);
+      if (a_n == 0)
+        return;
+
+      double const A[3] { double(a_x/r), double(a_y/r), double(a_z/r) };
+      double const ir  = double(m_Re / r);
+      double const t   = A[2];
+      double u, iu, cl, sl;
+      Angles(A, &u, &iu, &cl, &sl);
+      double const iru = ir * u;
+      double const irt = ir * t;
+      double const ir2 = ir * ir;
+
+      // "SHToF" as a 3x3 matrix, with the K/r^2 factor:
+      double const KR2 = (m_K / r2).Magnitude();
+      double const T00 = - KR2 * t * cl * iu;
+      double const T01 = - KR2 * A[0];
+      double const T02 = - KR2 * sl * iu;
+      double const T10 = - KR2 * t * sl * iu;
+      double const T11 = - KR2 * A[1];
+      double const T12 =   KR2 * cl * iu;
+      double const T21 = - KR2 * A[2];
+
+      double const* sq  = m_sq .data();
+      double const* isq = m_isq.data();
+      double const* p   = m_p  .data();
+      double const* ip  = m_ip .data();
+
+      double           cm  = 1.0;
+      double           sm  = 0.0;
+      Sectoral<double> Qmm;
+
+      for (int m = 0; m <= a_n; ++m)
+      {
+        // The recursion state at the 1st non-negligible degree "l":
+        double Q   = Qmm.m_Q;
+        double Q1  = 0.0;
+        double ia  = 0.0;
+        int    l   = m;
+        if (UNLIKELY(Qmm.m_e[0] != 0))
+          l = (XLog2(Qmm.Lane(0)) + ColGrowth(m, a_n, ir) < NegligibleLog2)
+              ? -1
+              : ColStartX(m, a_n, t, ir, Qmm.Lane(0), &Q, &Q1, &ia);
+
+        // The output columns of C(l,m) and S(l,m):
+        size_t k = size_t(2 * GravityModel::CoeffIdx(std::max(l, m), m, a_n));
+        double const dm = double(m);
+
+        for (; 0 <= l && l <= a_n; k += 2)
+        {
+          if (l >= 2)
+          {
+            double uDQ = double(2*l+1) * ia * ir * Q1 - double(l) * t * Q;
+            double lQ  = double(l+1) * Q;
+
+            // The terms of "S" for C(l,m) and S(l,m):
+            double const SC[3] { cm * uDQ, cm * lQ, - dm * sm * Q };
+            double const SS[3] { sm * uDQ, sm * lQ,   dm * cm * Q };
+
+            a_D0[k]   = T00 * SC[0] + T01 * SC[1] + T02 * SC[2];
+            a_D1[k]   = T10 * SC[0] + T11 * SC[1] + T12 * SC[2];
+            a_D2[k]   = KR2 * SC[0] + T21 * SC[1];
+            a_D0[k+1] = T00 * SS[0] + T01 * SS[1] + T02 * SS[2];
+            a_D1[k+1] = T10 * SS[0] + T11 * SS[1] + T12 * SS[2];
+            a_D2[k+1] = KR2 * SS[0] + T21 * SS[1];
+          }
+          if (++l > a_n)
+            break;
+
+          // Next degree (as in "ColSumsFrom"):
+          double a = p [l] * isq[l-m] * isq[l+m];
+          double b = a * ia;
+          ia       = ip[l] * sq [l-m] * sq [l+m];
+
+          double Qn = a * irt * Q - b * ir2 * Q1;
+          Q1        = Q;
+          Q         = Qn;
+        }
+        if (m < a_n)
+          NextOrder(m, cl, sl, iru, &cm, &sm, &Qmm);
+      }
+    }
+
+    //=======================================================================//
+    // "SumSHMixed": Mixed-Precision Version of "SumSH":                     //
+    //=======================================================================//
+    // The terms of degrees up to "a_L" are summed up exactly as in "SumSH"
+    // (in "VD", ie "double" lanes), and the tail (degrees a_L+1 .. n) is summ-
+    // ed up in "VF" ("float" lanes, the same number of them), using the float
+    // copy of the coeffs (see "MkCoeffsF"). "VD" is "double" or "DoubleV8",
+    // "VF" is "float" or "FloatV8" resp.
+    // The scaled Legendre functions Q(l,m) = P(l,m) * (Re/r)^l are very small
+    // in the "evanescent" part of a column (before it starts to oscillate) and
+    // at high degrees, so in "float", they are carried with the exact scale
+    // factor 2^100; the switch to "float" in each column is delayed until
+    // Q(l,m) in all lanes is above 2^-200 (otherwise, the column could be lost
+    // to underflow), and the "float" recursion is stopped once the column falls
+    // below that level again (which also avoids the very slow denormal arith-
+    // metic). The scaled values can not overflow,  as |P(l,m)| <=
+    // SqRt(2(2l+1)). See "MixedErrEst" for the resulting error:
+    //
+    template<typename VD, typename VF>
+    void SumSHMixed
+    (
+      VD const a_A[3],
+      VD       a_ir,
+      int      a_n,
+      int      a_L,
+      VD       a_F[3]
+    )
+    const
+    {
+      static_assert(SIMDTraits<VD>::Lanes == SIMDTraits<VF>::Lanes);
+      assert(2 <= a_n && a_n <= m_N && a_L >= 0 &&
+             m_coeffsF.size() == size_t(GravityModel::NCoeffs(m_N)));
+      VD const t   = a_A[2];
+      VD u, iu, cl, sl;
+      Angles(a_A, &u, &iu, &cl, &sl);
+      VD const iru = a_ir * u;
+
+      VD S[3] { Splat<VD>(0.0), Splat<VD>(0.0), Splat<VD>(0.0) };
+      VD           cm  = Splat<VD>(1.0);
+      VD           sm  = Splat<VD>(0.0);
+      Sectoral<VD> Qmm;
+
+      for (int m = 0; m <= a_n; ++m)
+      {
+        // (The extended-range lanes, if any, are processed in "double"):
+        VD ab[6];
+        ColSumsAny
+        (
+          m, a_n, t, a_ir, Qmm, ab,
+          [&](VD a_Q, VD a_abD[6])
+            { ColSumsMixed<VD, VF>(m, a_n, a_L, t, a_ir, a_Q, a_abD); }
+        );
+
+        S[0] += cm * ab[0] + sm * ab[1];
+        S[1] += cm * ab[2] + sm * ab[3];
+        S[2] += double(m) * (cm * ab[5] - sm * ab[4]);
+
+        NextOrder(m, cl, sl, iru, &cm, &sm, &Qmm);
+      }
+      SHToF(a_A, S, a_F);
+    }
+
+    //-----------------------------------------------------------------------//
+    // "ColSumsMixed": Mixed-Precision Version of "ColSums":                 //
+    //-----------------------------------------------------------------------//
+    template<typename VD, typename VF>
+    void ColSumsMixed
+    (
+      int a_m, int a_n, int a_L, VD a_t, VD a_ir, VD a_Qmm, VD a_ab[6]
+    )
+    const
+    {
+      double const* sq  = m_sq .data();
+      double const* isq = m_isq.data();
+      double const* p   = m_p  .data();
+      double const* ip  = m_ip .data();
+      int    const  m   = a_m;
+
+      //---------------------------------------------------------------------//
+      // "double" part:                                                      //
+      //---------------------------------------------------------------------//
+      VD const irt = a_ir * a_t;
+      VD const ir2 = a_ir * a_ir;
+
+      VD a1 = Splat<VD>(0.0), b1 = a1, a2 = a1, b2 = a1, a3 = a1, b3 = a1;
+      VD     Q   = a_Qmm;
+      VD     Q1  = Splat<VD>(0.0);
+      double ia  = 0.0;
+
+      PackedSHCoeffs const* col = Col(m);
+
+      int  l    = m;
+      bool done = false;
+      for (; ; )
+      {
+        if (l >= 2)
+        {
+          PackedSHCoeffs const& SHC = col[l];
+
+          VD uDQ = double(2*l+1) * ia * a_ir * Q1 - double(l) * a_t * Q;
+          VD lQ  = double(l+1) * Q;
+
+          a1 += uDQ * SHC.m_Clm;
+          b1 += uDQ * SHC.m_Slm;
+          a2 += lQ  * SHC.m_Clm;
+          b2 += lQ  * SHC.m_Slm;
+          a3 += Q   * SHC.m_Clm;
+          b3 += Q   * SHC.m_Slm;
+        }
+        if (++l > a_n)
+        {
+          done = true;
+          break;
+        }
+        double a = p [l] * isq[l-m] * isq[l+m];
+        double b = a * ia;
+        ia       = ip[l] * sq [l-m] * sq [l+m];
+
+        VD Qn = a * irt * Q - b * ir2 * Q1;
+        Q1    = Q;
+        Q     = Qn;
+
+        // Switch to "float" from the degree "l" (not summed up yet)? (Checked
+        // at every 4th degree only, as the check is not vectorised):
+        if (l > a_L && l >= 2 && (l & 3) == 0 && FloatSafe(Q))
+          break;
+      }
+      a_ab[0] = a1;
+      a_ab[1] = b1;
+      a_ab[2] = a2;
+      a_ab[3] = b2;
+      a_ab[4] = a3;
+      a_ab[5] = b3;
+      if (done)
+        return;
+
+      //---------------------------------------------------------------------//
+      // "float" part, from the degree "l":                                  //
+      //---------------------------------------------------------------------//
+      VF const t   = ConvertV<VF>(a_t);
+      VF const ir  = ConvertV<VF>(a_ir);
+      VF const fir = ConvertV<VF>(irt);
+      VF const fr2 = ConvertV<VF>(ir2);
+
+      VF c1 = Splat<VF>(0.0f), d1 = c1, c2 = c1, d2 = c1, c3 = c1, d3 = c1;
+      VF Qf  = ConvertV<VF>(Q  * FScale);
+      VF Q1f = ConvertV<VF>(Q1 * FScale);
+
+      PackedSHCoeffsF const* colF =
+        m_coeffsF.data() + (GravityModel::ColIdx(m, m_N) - m);
+
+      for (; ; )
+      {
+        PackedSHCoeffsF const& SHC = colF[l];
+
+        VF uDQ = float(double(2*l+1) * ia) * ir * Q1f - float(l) * t * Qf;
+        VF lQ  = float(l+1) * Qf;
+
+        c1 += uDQ * SHC.m_Clm;
+        d1 += uDQ * SHC.m_Slm;
+        c2 += lQ  * SHC.m_Clm;
+        d2 += lQ  * SHC.m_Slm;
+        c3 += Qf  * SHC.m_Clm;
+        d3 += Qf  * SHC.m_Slm;
+
+        if (++l > a_n)
+          break;
+        double a = p [l] * isq[l-m] * isq[l+m];
+        double b = a * ia;
+        ia       = ip[l] * sq [l-m] * sq [l+m];
+
+        VF Qn = float(a) * fir * Qf - float(b) * fr2 * Q1f;
+        Q1f   = Qf;
+        Qf    = Qn;
+
+        // The rest of the column is negligible in all lanes? (Once decreasing,
+        // the envelope of Q(l,m) does not grow again with "l", see above):
+        if ((l & 7) == 0 && FloatTiny(Qf, FScale) && FloatTiny(Q1f, FScale))
+          break;
+      }
+      a_ab[0] += ConvertV<VD>(c1) * FInvScale;
+      a_ab[1] += ConvertV<VD>(d1) * FInvScale;
+      a_ab[2] += ConvertV<VD>(c2) * FInvScale;
+      a_ab[3] += ConvertV<VD>(d2) * FInvScale;
+      a_ab[4] += ConvertV<VD>(c3) * FInvScale;
+      a_ab[5] += ConvertV<VD>(d3) * FInvScale;
+    }
+
+    // The scale factor of the "float" recursion (exact in both precisions):
+    constexpr static double FScale    = 0x1p100;
+    constexpr static double FInvScale = 0x1p-100;
+
+    // Whether Q(l,m) is above 2^-200 in all lanes  ("FloatSafe"), or below it
+    // in all lanes ("FloatTiny"; "a_scale" is the scale factor already applied
+    // to "a_Q"):
+    template<typename V>
+    static bool FloatSafe(V a_Q)
+    {
+      bool safe = true;
+      for (int k = 0; k < SIMDTraits<V>::Lanes; ++k)
+        safe = safe && (Abs(GetLane(a_Q, k)) >= 0x1p-200);
+      return safe;
+    }
+
+    template<typename V>
+    static bool FloatTiny(V a_Q, double a_scale)
+    {
+      double const thr  = a_scale * 0x1p-200;
+      bool         tiny = true;
+      for (int k = 0; k < SIMDTraits<V>::Lanes; ++k)
+        tiny = tiny && (Abs(double(GetLane(a_Q, k))) < thr);
+      return tiny;
+    }
+
+    //=======================================================================//
+    // "SumPines": Non-Singular (Cartesian) Summation:                       //
+    //=======================================================================//
+    // Same interface and result as "SumSH",  but uses the Pines formulation:
+    // with (s, t, u) = (x, y, z) / r, the terms are expanded via
+    //   P(l,m)(u) * Cos|Sin(m*lambda) = Q(l,m)(u) * Re|Im((s + i*t)^m),
+    // where Q(l,m) = P(l,m) / cos(phi)^m are polynomials in "u", satisfying
+    // the same column recursion as P(l,m) (but with the sectoral seeds not
+    // containing cos(phi)), and
+    //   dQ(l,m)/du = e(l,m) * Q(l,m+1),
+    //   e(l,m)     = SqRt((l-m)(l+m+1) / (m==0 ? 2 : 1)).
+    // Thus, no trig functions are required, and there are no singularities on
+    // the polar axis. While summing over column "m", column "m+D" is generated
+    // and saved in a work buffer for the subsequent iterations;  D=1 normally
+    // (for dQ/du), and D=2 if "WithGrad" is set (for d2Q/du2 as well).
+    // If "WithGrad" is set, we also compute
+    //   "U": the dimension-less sum such that the potential is K/r * (1 + U);
+    //   "G": the dimension-less sums such that the Gravity-Gradient Tensor is
+    //        K/r^3 * (G + 3 * A * A^T - I), stored as (xx,yy,zz,xy,xz,yz).
+    // They are obtained by differentiating each term
+    //   (Re/r)^l / r * Q(l,m)(u) * Re((C - i*S) * (s + i*t)^m)
+    // twice in (x,y,z), which gives the sums over (l,m) of Q, dQ/du, d2Q/du2
+    // (and their combinations with the degree-dependent factors) multiplied by
+    // Re|Im((s + i*t)^k), k = m, m-1, m-2.
+    // If "a_l_min" > 2,  the terms of degrees 2 .. a_l_min-1 are omitted (the
+    // recursions still run over them,  but the coeffs are not touched), which
+    // gives the high-degree residual in one pass (see "ResAccGrad"):
+    //
+    template<typename V, bool WithGrad = false>
+    void SumPines
+    (
+      V const a_A[3],
+      V       a_ir,
+      int     a_n,
+      bool    a_zonal_only,
+      V       a_F[3],
+      V*      a_U     = nullptr,   // Only if "WithGrad"
+      V       a_G[6]  = nullptr,   // ditto
+      int     a_l_min = 2
+    )
+    {
+      assert(2 <= a_n && a_n <= m_N && 2 <= a_l_min && a_l_min <= a_n);
+      assert(!WithGrad || (a_U != nullptr && a_G != nullptr));
+      static_assert(sizeof(V) <= MaxLanes * sizeof(double));
+      double const* sq  = m_sq .data();
+      double const* isq = m_isq.data();
+      double const* p   = m_p  .data();
+      double const* ip  = m_ip .data();
+
+      V const s   = a_A[0];
+      V const t   = a_A[1];
+      V const u   = a_A[2];
+      V const iru = a_ir * u;
+      V const ir2 = a_ir * a_ir;
+
+      // Columns "m" .. "m+D" of (Re/r)^l * Q(l,.), l = 0 .. a_n:
+      constexpr int D = WithGrad ? 2 : 1;
+      V* qc[D+1];
+      for (int k = 0; k <= D; ++k)
+        qc[k] = reinterpret_cast<V*>(m_pinesQ[k].data());
+
+      // Columns 0 .. D-1, by the recursion from the sectoral terms
+      // (Re/r)^k * Q(k,k):
+      V qkk = Splat<V>(1.0);
+      for (int k = 0; k < D; ++k)
+      {
+        if (k != 0)
+          qkk *= ((k == 1) ? sq[3] : sq[2*k+1] * isq[2*k]) * a_ir;
+        V* qk = qc[k];
+        if (k <= a_n)
+          qk[k] = qkk;
+        if (k + 1 <= a_n)
+          qk[k+1] = sq[2*k+3] * iru * qkk;
+        double ia = ip[k+1] * sq[1] * sq[2*k+1];    // 1/a(k+1,k)
+        for (int l = k+2; l <= a_n; ++l)
+        {
+          double a = p[l] * isq[l-k] * isq[l+k];
+          double b = a * ia;
+          ia       = ip[l] * sq [l-k] * sq [l+k];
+          qk[l]    = a * iru * qk[l-1] - b * ir2 * qk[l-2];
+        }
+      }
+      // Running Re|Im((s + i*t)^k), k = m, m-1, m-2:
+      V rm  = Splat<V>(1.0);
+      V im  = Splat<V>(0.0);
+      V rm1 = Splat<V>(0.0);
+      V im1 = Splat<V>(0.0);
+      V rm2 = Splat<V>(0.0);
+      V im2 = Splat<V>(0.0);
+
+      // Sums producing the Pines "a1" .. "a4":
+      V a1 = Splat<V>(0.0), a2 = a1, a3 = a1, a4 = a1;
+
+      // Extra sums for the potential and the gradient (see below):
+      V gU  = a1, gDD = a1, gM  = a1, gX  = a1, gEd = a1, gFd = a1, gEL = a1,
+        gFL = a1, gH1 = a1, gH2 = a1;
+
+      int maxM = a_zonal_only ? 0 : a_n;
+      for (int m = 0; m <= maxM; ++m)
+      {
+        // Column "g" is to be generated now, from (Re/r)^g * Q(g,g) (no
+        // cos(phi) factor here):
+        int const g   = m + D;
+        qkk          *= ((g == 1) ? sq[3] : sq[2*g+1] * isq[2*g]) * a_ir;
+        V*  const qm  = qc[0];
+        V*  const qm1 = qc[1];
+        V*  const qg  = qc[D];
+
+        // Column sums for the Cos (c*) and Sin (s*) coeffs:
+        V c0  = Splat<V>(0.0), s0  = c0, cD = c0, sD = c0, cL = c0, sL = c0;
+        V cDD = c0, sDD = c0, cM  = c0, sM  = c0, cX = c0, sX = c0;
+
+        V      Q   = qkk;             // (Re/r)^l * Q(l,g), from l=g
+        V      Q1  = Splat<V>(0.0);   // Previous one
+        double ia  = 0.0;             // 1/a(l,g)
+        double em  = (m == 0) ? SqRt(0.5) : 1.0;
+
+        // Column "m" of the coeffs, indexed by "l":
+        PackedSHCoeffs const* col = Col(m);
+
+        for (int l = m; l <= a_n; ++l)
+        {
+          if (l > g)
+          {
+            double a = p [l] * isq[l-g] * isq[l+g];
+            double b = a * ia;
+            ia       = ip[l] * sq [l-g] * sq [l+g];
+            V Qn     = a * iru * Q - b * ir2 * Q1;
+            Q1       = Q;
+            Q        = Qn;
+          }
+          if (l >= g)
+            qg[l] = Q;
+
+          if (l < a_l_min)
+            continue;
+
+          PackedSHCoeffs const& SHC = col[l];
+
+          // (Re/r)^l * {Q, dQ/du} for (l,m); Q(l,m+1) = 0 for l <= m:
+          V q  = qm[l];
+          V dq = (l > m) ? em * sq[l-m] * sq[l+m+1] * qm1[l] : Splat<V>(0.0);
+          V lq = double(l+m+1) * q + u * dq;
+
+          c0 += q  * SHC.m_Clm;
+          s0 += q  * SHC.m_Slm;
+          cD += dq * SHC.m_Clm;
+          sD += dq * SHC.m_Slm;
+          cL += lq * SHC.m_Clm;
+          sL += lq * SHC.m_Slm;
+
+          if constexpr (WithGrad)
+          {
+            // d2Q/du2 = e(l,m) * e(l,m+1) * Q(l,m+2):
+            V ddq =
+              (l > m+1)
+              ? em * sq[l-m] * sq[l+m+1] * sq[l-m-1] * sq[l+m+2] * qg[l]
+              : Splat<V>(0.0);
+            V mq  = double(l+m+2) * dq + u * ddq;
+            V xq  = double(l+m+3) * lq + u * mq;
+
+            cDD += ddq * SHC.m_Clm;
+            sDD += ddq * SHC.m_Slm;
+            cM  += mq  * SHC.m_Clm;
+            sM  += mq  * SHC.m_Slm;
+            cX  += xq  * SHC.m_Clm;
+            sX  += xq  * SHC.m_Slm;
+          }
+        }
+        // Apply the Cos/Sin factors:
+        //   a1 += m * Sum(q  * (C * r(m-1) + S * i(m-1))),
+        //   a2 += m * Sum(q  * (S * r(m-1) - C * i(m-1))),
+        //   a3 +=     Sum(dq * (C * r(m)   + S * i(m))),
+        //   a4 -=     Sum(lq * (C * r(m)   + S * i(m))):
+        double const dm = double(m);
+        a1 += dm * (c0 * rm1 + s0 * im1);
+        a2 += dm * (s0 * rm1 - c0 * im1);
+        a3 += cD * rm + sD * im;
+        a4 -= cL * rm + sL * im;
+
+        if constexpr (WithGrad)
+        {
+          double const dm2 = dm * double(m-1);
+          gU  += c0  * rm  + s0  * im;
+          gDD += cDD * rm  + sDD * im;
+          gM  += cM  * rm  + sM  * im;
+          gX  += cX  * rm  + sX  * im;
+          gEd += dm  * (cD * rm1 + sD * im1);
+          gFd += dm  * (sD * rm1 - cD * im1);
+          gEL += dm  * (cL * rm1 + sL * im1);
+          gFL += dm  * (sL * rm1 - cL * im1);
+          gH1 += dm2 * (c0 * rm2 + s0 * im2);
+          gH2 += dm2 * (s0 * rm2 - c0 * im2);
+        }
+        if (m == maxM)
+          break;
+
+        // Next order: rotate the column buffers and the powers of (s + i*t):
+        V* q0 = qc[0];
+        for (int k = 0; k < D; ++k)
+          qc[k] = qc[k+1];
+        qc[D] = q0;
+
+        rm2 = rm1;
+        im2 = im1;
+        rm1 = rm;
+        im1 = im;
+        rm  = rm1 * s - im1 * t;
+        im  = rm1 * t + im1 * s;
+      }
+      a_F[0] = a1 + s * a4;
+      a_F[1] = a2 + t * a4;
+      a_F[2] = a3 + u * a4;
+
+      if constexpr (WithGrad)
+      {
+        // With "A" = (s,t,u), "Ek" = (gE*,gF*,0) and "e3" = (0,0,1),
+        //   G = gDD * e3*e3^T - gM * (A*e3^T + e3*A^T) + gX * A*A^T + a4 * I
+        //     + (e3*EkD^T + EkD*e3^T) - (A*EkL^T + EkL*A^T)
+        //     + gH1 * (e1*e1^T - e2*e2^T) + gH2 * (e1*e2^T + e2*e1^T):
+        *a_U   = gU;
+        a_G[0] = gX * s * s + a4 - 2.0 * s * gEL + gH1;
+        a_G[1] = gX * t * t + a4 - 2.0 * t * gFL - gH1;
+        a_G[2] = gX * u * u + a4 - 2.0 * u * gM  + gDD;
+        a_G[3] = gX * s * t - s * gFL - t * gEL  + gH2;
+        a_G[4] = gX * s * u - s * gM  - u * gEL  + gEd;
+        a_G[5] = gX * t * u - t * gM  - u * gFL  + gFd;
+      }
+    }
+
+    //=======================================================================//
+    // "Eval": Common Implementation of the Single-Position Evaluators:      //
+    //=======================================================================//
+    // If "WithGrad" is set (only with the Pines formulation), the potential
+    // and the Gravity-Gradient Tensor are computed as well, in the same pass.
+    // "FixedN" is the optional compile-time degree (see "SumSH"). If "a_pool"
+    // is given (only with the Spherical formulation), the columns are summed
+    // up in parallel (see "SumSHPar"):
+    //
+    template<bool IsPines, bool WithGrad = false, int FixedN = 0>
+    void Eval
+    (
+      Time                      a_t,                 // For info only
+      PosVRot<BodyName> const&  a_pos,
+      AccVRot<BodyName>*        a_acc,
+      int                       a_n          = FullDeg, // Max order used
+      bool                      a_zonal_only = false,// Zonal Harmonics only?
+      GravPot*                  a_pot        = nullptr,
+      GravGradTRot<BodyName>*   a_grad       = nullptr,
+      ThreadPool*               a_pool       = nullptr
+    )
+    {
+      //---------------------------------------------------------------------//
+      // Checks:                                                             //
+      //---------------------------------------------------------------------//
+      static_assert(IsPines || !WithGrad);
+      assert(a_acc != nullptr && (!IsPines || a_pool == nullptr));
+      assert(!WithGrad || (a_pot != nullptr && a_grad != nullptr));
+      int const n = Degree(a_n);
+
+      //---------------------------------------------------------------------//
+      // The Rectangular CoOrds:                                             //
+      //---------------------------------------------------------------------//
+      // (In BodyCentricRotatingCOS):
+      Len  x       = a_pos[0];
+      Len  y       = a_pos[1];
+      Len  z       = a_pos[2];
+      Len2 r2      = Sqr(x) + Sqr(y) + Sqr(z);
+      Len  r       = SqRt(r2);
+
+      if (UNLIKELY(r <= m_rImpact))
+        Impact(a_t, x, y, z);
+
+      // If OK: Main part of the Gravitational Acceleration:
+      Acc  mainAcc = m_K / r2;
+
+      // dr/d{x,y,z}:
+      double const A[3] { double(x/r), double(y/r), double(z/r) };
+
+      //---------------------------------------------------------------------//
+      // Sum up the Spherical Harmonics (unless n==0, which is the Spherical- //
+      // ly-Symmetric Gravitational Field):                                  //
+      //---------------------------------------------------------------------//
+      double F[3] {0.0, 0.0, 0.0};
+      double U     = 0.0;
+      double G[6] {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+      if constexpr (IsPines)
+        if (UNLIKELY(n > MaxPinesDeg))
+          throw std::invalid_argument("GravAccPines: Degree too high");
+      if (n != 0)
+      {
+        double const ir = double(m_Re / r);
+        if constexpr (IsPines)
+          SumPines<double, WithGrad>(A, ir, n, a_zonal_only, F, &U, G);
+        else
+        if (a_pool != nullptr)
+          SumSHPar                  (A, ir, n, a_zonal_only, F, *a_pool);
+        else
+          SumSH   <double, FixedN>  (A, ir, n, a_zonal_only, F);
+      }
+      //---------------------------------------------------------------------//
+      // Finally:                                                            //
+      //---------------------------------------------------------------------//
+      for (size_t i = 0; i < 3; ++i)
+        (*a_acc)[i] += mainAcc * (F[i] - A[i]);
+
+      if constexpr (WithGrad)
+      {
+        *a_pot += m_K / r * (1.0 + U);
+
+        // The main term of the tensor is K/r^3 * (3 * A * A^T - I):
+        GravGrad mainGrad = mainAcc / r;
+        constexpr int IJ[3][3] { { 0, 3, 4 }, { 3, 1, 5 }, { 4, 5, 2 } };
+        for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+          (*a_grad)[size_t(i)][size_t(j)] +=
+            mainGrad * (G[IJ[i][j]] + 3.0 * A[i] * A[j] - double(i == j));
+      }
+    }
+
+    //=======================================================================//
+    // "EvalZonal": Closed-Form Low-Degree Zonal Field:                      //
+    //=======================================================================//
+    // With u = sin(phi) = z/r, the potential is
+    //   K/r * (1 - Sum_{l=2}^{MaxJ} J(l) * (Re/r)^l * P(l)(u)),
+    // where P(l) are the (un-normalised) Legendre polynomials,  and  J(l) =
+    // -SqRt(2l+1) * C(l,0). Differentiating each term in (x,y,z), we get
+    //   acc = K/r^2 * ((SA - 1) * A - SZ * e3),
+    //   SA  = Sum J(l) * (Re/r)^l * ((l+1) * P(l) + u * P'(l)),
+    //   SZ  = Sum J(l) * (Re/r)^l * P'(l),
+    // where the polynomials are written out explicitly, so there are no loops
+    // and no recursions at all:
+    //
+    template<int MaxJ>
+    void EvalZonal
+    (
+      Time                     a_t,                  // For info only
+      PosVRot<BodyName> const& a_pos,
+      AccVRot<BodyName>*       a_acc
+    )
+    const
+    {
+      static_assert(2 <= MaxJ && MaxJ <= MaxZonalJ);
+      assert(a_acc != nullptr);
+
+      Len  x       = a_pos[0];
+      Len  y       = a_pos[1];
+      Len  z       = a_pos[2];
+      Len2 r2      = Sqr(x) + Sqr(y) + Sqr(z);
+      Len  r       = SqRt(r2);
+
+      if (UNLIKELY(r <= m_rImpact))
+        Impact(a_t, x, y, z);
+
+      Acc  mainAcc = m_K / r2;
+      double const A[3] { double(x/r), double(y/r), double(z/r) };
+      double const u   = A[2];
+      double const u2  = u * u;
+      double const ir  = double(m_Re / r);
+
+      // l=2:
+      double irl = ir * ir;
+      double P   = 0.5 * (3.0 * u2 - 1.0);
+      double dP  = 3.0 * u;
+      double SA  = m_J[2] * irl * (3.0 * P + u * dP);
+      double SZ  = m_J[2] * irl * dP;
+
+      if constexpr (MaxJ >= 3)
+      {
+        irl *= ir;
+        P    = 0.5 * u * (5.0 * u2 - 3.0);
+        dP   = 1.5 * (5.0 * u2 - 1.0);
+        SA  += m_J[3] * irl * (4.0 * P + u * dP);
+        SZ  += m_J[3] * irl * dP;
+      }
+      if constexpr (MaxJ >= 4)
+      {
+        irl *= ir;
+        P    = 0.125 * ((35.0 * u2 - 30.0) * u2 + 3.0);
+        dP   = 0.5   * u * (35.0 * u2 - 15.0);
+        SA  += m_J[4] * irl * (5.0 * P + u * dP);
+        SZ  += m_J[4] * irl * dP;
+      }
+      if constexpr (MaxJ >= 5)
+      {
+        irl *= ir;
+        P    = 0.125 * u * ((63.0 * u2 - 70.0) * u2 + 15.0);
+        dP   = 0.125 * ((315.0 * u2 - 210.0) * u2 + 15.0);
+        SA  += m_J[5] * irl * (6.0 * P + u * dP);
+        SZ  += m_J[5] * irl * dP;
+      }
+      if constexpr (MaxJ >= 6)
+      {
+        irl *= ir;
+        P    = 0.0625 * (((231.0 * u2 - 315.0) * u2 + 105.0) * u2 - 5.0);
+        dP   = 0.125  * u * ((693.0 * u2 - 630.0) * u2 + 105.0);
+        SA  += m_J[6] * irl * (7.0 * P + u * dP);
+        SZ  += m_J[6] * irl * dP;
+      }
+      (*a_acc)[0] += mainAcc * ((SA - 1.0) * A[0]);
+      (*a_acc)[1] += mainAcc * ((SA - 1.0) * A[1]);
+      (*a_acc)[2] += mainAcc * ((SA - 1.0) * A[2] - SZ);
+    }
+
+    //=======================================================================//
+    // Data Flds:                                                            //
+    //=======================================================================//
+    // The Model (either the compiled-in one, or a "GravityModel"). The coeffs
+    // are stored for the degrees up to "m_NS" (which determines their layout),
+    // and used up to "m_N" <= m_NS (see the Ctors):
+    PackedSHCoeffs const* m_coeffs;
+    int                   m_NS;
+    int                   m_N;
+    Len                   m_Re;
+    GM                    m_K;
+    Len                   m_rImpact;  // See "SetImpactRadius"
+
+    // Un-normalised zonal coeffs J(l) = -SqRt(2l+1) * C(l,0), l = 0..MaxZonalJ
+    // (0 if not available in the model), for "EvalZonal":
+    constexpr static int  MaxZonalJ = 6;
+    double                m_J[MaxZonalJ+1];
+
+    // Work Buffers: Aligned on the cache line boundary:
+    using AlignedBuff =
+      std::vector<double, boost::alignment::aligned_allocator<double, 64>>;
+
+    // Tabulated SqRts for the Legendre recursion coeffs (see above):
+    AlignedBuff  m_sq;       // SqRt(k),              k = 0 .. 2*N+1
+    AlignedBuff  m_isq;      // 1/SqRt(k) (0 for k=0)
+    AlignedBuff  m_p;        // SqRt((2l-1)(2l+1)),   l = 0 .. N
+    AlignedBuff  m_ip;       // 1/m_p[l]  (0 for l=0)
+    AlignedBuff  m_log2f;    // log2(k!),             k = 0 .. 2*N+1
+
+    // NB: All the above buffers are sized by the max degree of the evaluator,
+    // so there are no compile-time limits on the degree (for the run-time
+    // models): eg the full 1200x1200 lunar model requires ~0.2 MB of buffers
+    // per evaluator (plus the shared coeffs, ~11.5 MB):
+
+    // Up to 3 columns of the Pines "Q(l,m)",  for up to "MaxLanes" SIMD lanes
+    // (see "SumPines"):
+    constexpr static int MaxLanes = SIMDTraits<DoubleV4>::Lanes;
+    AlignedBuff  m_pinesQ[3];
+
+    // Per-Degree Bounds (see "MkDegreeBounds") and a buffer for "TruncDegree":
+    AlignedBuff  m_degBounds;
+    AlignedBuff  m_degTerms;
+
+    // The "float" copy of the coeffs, for the mixed-precision evaluators (see
+    // "SumSHMixed"); created on first use:
+    struct PackedSHCoeffsF
+    {
+      float m_Clm;
+      float m_Slm;
+    };
+    std::vector<PackedSHCoeffsF> m_coeffsF;
+
+    //=======================================================================//
+    // Ctors, Dtor:                                                          //
+    //=======================================================================//
+    // Common Ctor: Allocates and fills in the buffers for the max degree "a_N"
+    // of the evaluator (the coeffs are stored up to the degree "a_NS"; FullDeg
+    // for "a_N" means the same as "a_NS"):
+    //
+    GravityField
+    (
+      PackedSHCoeffs const* a_coeffs,
+      int                   a_NS,
+      int                   a_N,
+      Len                   a_Re,
+      GM                    a_K
+    )
+    : m_coeffs  (a_coeffs),
+      m_NS      (a_NS),
+      m_N       ((a_N == FullDeg) ? a_NS : a_N),
+      m_Re      (a_Re),
+      m_K       (a_K),
+      m_rImpact (a_Re),
+      m_sq      (size_t(2*m_N+2)),
+      m_isq     (size_t(2*m_N+2)),
+      m_p       (size_t(m_N+1)),
+      m_ip      (size_t(m_N+1)),
+      m_log2f   (size_t(2*m_N+2)),
+      m_degTerms(size_t(m_N+1))
+    {
+      if (UNLIKELY(a_NS < 0 || a_NS == 1 || !IsPos(a_Re) || !IsPos(a_K) ||
+                  (a_NS != 0 && a_coeffs == nullptr)))
+        throw std::invalid_argument("GravityField: Invalid Model");
+
+      if (UNLIKELY(m_N < 0 || m_N == 1 || m_N > a_NS))
+        throw std::invalid_argument("GravityField: Invalid Max Degree");
+
+      for (AlignedBuff& q: m_pinesQ)
+        q.resize(size_t((m_N+1) * MaxLanes));
+
+      for (size_t k = 0; k < m_sq.size(); ++k)
+      {
+        m_sq   [k] = SqRt(double(k));
+        m_isq  [k] = (k == 0) ? 0.0 : 1.0 / m_sq[k];
+        m_log2f[k] = (k <= 1) ? 0.0 : m_log2f[k-1] + std::log2(double(k));
+      }
+      m_p [0] = 0.0;
+      m_ip[0] = 0.0;
+      for (size_t l = 1; l < m_p.size(); ++l)
+      {
+        m_p [l] = m_sq[2*l-1] * m_sq[2*l+1];
+        m_ip[l] = 1.0 / m_p[l];
+      }
+      MkDegreeBounds();
+
+      for (int l = 0; l <= MaxZonalJ; ++l)
+        m_J[l] = (2 <= l && l <= m_N) ? - SqRt(double(2*l+1)) * Col(0)[l].m_Clm
+                                      : 0.0;
+    }
+
+  public:
+    // Default Ctor: Uses the compiled-in model:
+    GravityField()
+    : GravityField(Packed(), N, FullDeg, Re, K)
+    {}
+
+    // Using the compiled-in model up to the degree "a_max_deg" (0 or 2 .. N):
+    explicit GravityField(int a_max_deg)
+    : GravityField(Packed(), N, a_max_deg, Re, K)
+    {}
+
+    // Using a run-time model (which must outlive this evaluator). The max deg-
+    // ree of the evaluator may be reduced at run time (by "a_max_deg", which
+    // must be 0 or 2 .. a_model.N()), to save memory if the full degree of the
+    // model is not required:
+    explicit GravityField
+    (
+      GravityModel const& a_model,
+      int                 a_max_deg = FullDeg
+    )
+    : GravityField(a_model.Coeffs(), a_model.N(), a_max_deg,
+                   a_model.Re(),     a_model.K())
+    {}
+
+    // Evaluators are not copyable (no point in that), but are movable:
+    GravityField(GravityField const&)            = delete;
+    GravityField& operator=(GravityField const&) = delete;
+    GravityField(GravityField&&)                 = default;
+    GravityField& operator=(GravityField&&)      = default;
+    ~GravityField()                              = default;
+
+    //=======================================================================//
+    // "ThisThread": The Evaluator for the calling thread:                   //
+    //=======================================================================//
+    // Created on first use in each thread:
+    //
+    static GravityField& ThisThread()
+    {
+      thread_local GravityField gf;
+      return gf;
+    }
+
+    //=======================================================================//
+    // Altitude-Adaptive Truncation:                                         //
+    //=======================================================================//
+    // Returns the smallest degree "n" (0 or 2 .. N) such that the acceleration
+    // terms of all degrees above "n" at the radius "r" are guaranteed to sum
+    // up to at most "tol" in magnitude (see "MkDegreeBounds"). The result can
+    // be passed as "a_n" to any of the evaluators below. The cost is O(N), ie
+    // negligible compared to the evaluation itself (O(n^2)):
+    //
+    int TruncDegree(Len a_r, Acc a_tol)
+    {
+      if (m_N == 0 || !IsPos(a_tol))
+        return m_N;
+
+      // The tolerance relative to the main term, and the terms of the bound
+      // by degree (as the powers of "ir" may underflow, they are computed in
+      // the ascending order of degrees, and then summed up in the descending
+      // one):
+      double const  eps   = double(a_tol / (m_K / Sqr(a_r)));
+      double const  ir    = double(m_Re / a_r);
+      double const* w     = m_degBounds.data();
+      double*       terms = m_degTerms .data();
+      double        irl   = ir;
+      for (int l = 2; l <= m_N; ++l)
+      {
+        irl     *= ir;
+        terms[l] = irl * w[l];
+      }
+      double tail = 0.0;
+      for (int l = m_N; l >= 2; --l)
+      {
+        tail += terms[l];
+        if (tail > eps)
+          return l;
+      }
+      return 0;
+    }
+
+    // The bound "w(l)" on the acceleration terms of degree "l" (see "MkDegree-
+    // Bounds"), 0 for l < 2:
+    double DegreeBound(int a_l) const
+    {
+      assert(0 <= a_l && a_l <= m_N);
+      return m_degBounds[size_t(a_l)];
+    }
+
+    // Accessors for the model actually used:
+    int MaxDeg() const { return m_N;  }
+    Len GetRe()  const { return m_Re; }
+    GM  GetK()   const { return m_K;  }
+
+    //=======================================================================//
+    // Impact Radius:                                                        //
+    //=======================================================================//
+    // All evaluators throw "ImpactExn" at r <= ImpactRadius(), which is Re by
+    // default. Much of the actual terrain may lie below Re (eg the lunar ba-
+    // sins), so with a terrain model, the radius should be lowered to that of
+    // the lowest terrain (eg "TerrainModel::MinRadius()"), and the impacts de-
+    // tected via the terrain (eg by a "TerrainEvent"); then "ImpactExn" is only
+    // a backstop. The series are still evaluated as usual slightly below Re
+    // (where they converge in practice, although it is not guaranteed):
+    //
+    Len ImpactRadius() const { return m_rImpact; }
+
+    void SetImpactRadius(Len a_r)
+    {
+      if (UNLIKELY(!IsPos(a_r)))
+        throw std::invalid_argument("GravityField: Invalid Impact Radius");
+      m_rImpact = a_r;
+    }
+
+    //=======================================================================//
+    // "LatRowSums": Longitude-Independent Sums for a Latitude Row:          //
+    //=======================================================================//
+    // For the given latitude "phi" and radius "r", returns the column sums (see
+    // "ColSums") for m = 0 .. n, 6 per column, in "a_ab" (of size >= 6*(n+1)).
+    // Along the parallel,  every quantity computed by "SumSH" is then a trig
+    // polynomial in "lambda" with those coeffs, so it can be synthesised on a
+    // whole row of longitudes at once (see "GravityMap::Synthesise" in "Gravi-
+    // tyMap.h"). Only reads the model data, so may be invoked on a shared
+    // evaluator concurrently:
+    //
+    void LatRowSums(Angle a_phi, Len a_r, int a_n, double* a_ab) const
+    {
+      assert(a_ab != nullptr);
+      int    const n   = Degree(a_n);
+      double const t   = Sin(double(a_phi));
+      double const u   = Cos(double(a_phi));
+      double const ir  = double(m_Re / a_r);
+      double const iru = ir * u;
+
+      // Cos(m*lambda) and Sin(m*lambda) are not used (lambda=0 here):
+      double           cm  = 1.0;
+      double           sm  = 0.0;
+      Sectoral<double> Qmm;
+      for (int m = 0; m <= n; ++m)
+      {
+        double* ab = a_ab + 6 * m;
+        if (n >= 2)
+          ColSumsAny
+          (
+            m, n, t, ir, Qmm, ab,
+            [&](double a_Q, double* a_abD) { ColSums(m, n, t, ir, a_Q, a_abD); }
+          );
+        else
+          std::fill_n(ab, 6, 0.0);
+        NextOrder(m, 1.0, 0.0, iru, &cm, &sm, &Qmm);
+      }
+    }
+
+    //=======================================================================//
+    // Gravitational Acceleration Computation:                               //
+    //=======================================================================//
+    // The function ADDS the components of the gravitational  acceleration vec-
+    // tor to the output vector "acc",  so the latter must be properly initial-
+    // ised (eg zeroed-out) before calling this function.
+    // NB: "pos" and "acc" are in the BodyCentricRotatingCOS (which is embedded
+    // in the Body is and rotating with it).
+    // The static version uses the Evaluator of the calling thread:
+    //
+    static void GravAcc
+    (
+      Time                     a_t,                  // For info only
+      PosVRot<BodyName> const& a_pos,
+      AccVRot<BodyName>*       a_acc,
+      int                      a_n          = FullDeg, // Max order used
+      bool                     a_zonal_only = false  // Zonal Harmonics only?
+    )
+    { ThisThread()(a_t, a_pos, a_acc, a_n, a_zonal_only); }
+
+    void operator()
+    (
+      Time                     a_t,                  // For info only
+      PosVRot<BodyName> const& a_pos,
+      AccVRot<BodyName>*       a_acc,
+      int                      a_n          = FullDeg, // Max order used
+      bool                     a_zonal_only = false  // Zonal Harmonics only?
+    )
+    { Eval<false>(a_t, a_pos, a_acc, a_n, a_zonal_only); }
+
+    //-----------------------------------------------------------------------//
+    // Same as above, with the degree selected automatically:                //
+    //-----------------------------------------------------------------------//
+    // The truncation error of the result is at most "a_tol" (see "TruncDegree"
+    // and "MkDegreeBounds"). On high orbits, this is much faster than using the
+    // full degree "N":
+    //
+    static void GravAccTol
+    (
+      Time                     a_t,                  // For info only
+      PosVRot<BodyName> const& a_pos,
+      AccVRot<BodyName>*       a_acc,
+      Acc                      a_tol,                // Truncation Tolerance
+      bool                     a_zonal_only = false  // Zonal Harmonics only?
+    )
+    { ThisThread().WithTol(a_t, a_pos, a_acc, a_tol, a_zonal_only); }
+
+    void WithTol
+    (
+      Time                     a_t,                  // For info only
+      PosVRot<BodyName> const& a_pos,
+      AccVRot<BodyName>*       a_acc,
+      Acc                      a_tol,                // Truncation Tolerance
+      bool                     a_zonal_only = false  // Zonal Harmonics only?
+    )
+    {
+      Len r = SqRt(Sqr(a_pos[0]) + Sqr(a_pos[1]) + Sqr(a_pos[2]));
+      Eval<false>(a_t, a_pos, a_acc, TruncDegree(r, a_tol), a_zonal_only);
+    }
+
+    //-----------------------------------------------------------------------//
+    // Same as above, Multi-Threaded:                                        //
+    //-----------------------------------------------------------------------//
+    // For one-off evaluations at very high degrees (in propagation, it is more
+    // efficient to parallelise over the trajectories). The columns of the sum
+    // are split across the threads of "a_pool" (see "SumSHPar"); the result is
+    // bitwise reproducible for a given number of threads in the pool:
+    //
+    static void GravAccMT
+    (
+      Time                     a_t,                  // For info only
+      PosVRot<BodyName> const& a_pos,
+      AccVRot<BodyName>*       a_acc,
+      ThreadPool&              a_pool,
+      int                      a_n          = FullDeg, // Max order used
+      bool                     a_zonal_only = false  // Zonal Harmonics only?
+    )
+    { ThisThread().Parallel(a_t, a_pos, a_acc, a_pool, a_n, a_zonal_only); }
+
+    void Parallel
+    (
+      Time                     a_t,                  // For info only
+      PosVRot<BodyName> const& a_pos,
+      AccVRot<BodyName>*       a_acc,
+      ThreadPool&              a_pool,
+      int                      a_n          = FullDeg, // Max order used
+      bool                     a_zonal_only = false  // Zonal Harmonics only?
+    )
+    {
+      Eval<false>
+        (a_t, a_pos, a_acc, a_n, a_zonal_only, nullptr, nullptr, &a_pool);
+    }
+
+    //=======================================================================//
+    // Accelerations for Several Max Degrees in One Pass:                    //
+    //=======================================================================//
+    // For the studies of convergence wrt the degree (eg 20, 50, 100, 300 and
+    // 600): the acceleration at "a_pos" is computed for each of the "a_nd"
+    // max degrees "a_degs" (0 or 2 .. N, or "FullDeg",  in the strictly asc-
+    // ending order; at most "MaxSnaps" of them) and ADDED to "a_accs[j]" resp.
+    // The cost is about that of a single "GravAcc" call with the max degree,
+    // and the results are the same as those of the separate calls, up to
+    // rounding errors (see "SumSHMulti"):
+    //
+    constexpr static int MaxSnaps = 8;
+
+    static void GravAccMulti
+    (
+      Time                     a_t,                  // For info only
+      PosVRot<BodyName> const& a_pos,
+      int                      a_nd,                 // Number of degrees
+      int const                a_degs [],            // Max orders used
+      AccVRot<BodyName>        a_accs []             // Same size
+    )
+    { ThisThread().Multi(a_t, a_pos, a_nd, a_degs, a_accs); }
+
+    void Multi
+    (
+      Time                     a_t,                  // For info only
+      PosVRot<BodyName> const& a_pos,
+      int                      a_nd,                 // Number of degrees
+      int const                a_degs [],            // Max orders used
+      AccVRot<BodyName>        a_accs []             // Same size
+    )
+    {
+      assert(a_degs != nullptr && a_accs != nullptr);
+      if (UNLIKELY(a_nd <= 0 || a_nd > MaxSnaps))
+        throw std::invalid_argument("GravAccMulti: Invalid Number of Degrees");
+
+      int degs[MaxSnaps];
+      for (int j = 0; j < a_nd; ++j)
+      {
+        degs[j] = Degree(a_degs[j]);
+        if (UNLIKELY(j > 0 && degs[j] <= degs[j-1]))
+          throw std::invalid_argument("GravAccMulti: Degrees not Ascending");
+      }
+      Len  x       = a_pos[0];
+      Len  y       = a_pos[1];
+      Len  z       = a_pos[2];
+      Len2 r2      = Sqr(x) + Sqr(y) + Sqr(z);
+      Len  r       = SqRt(r2);
+
+      if (UNLIKELY(r <= m_rImpact))
+        Impact(a_t, x, y, z);
+
+      Acc  mainAcc = m_K / r2;
+      double const A[3] { double(x/r), double(y/r), double(z/r) };
+
+      double F[3 * MaxSnaps];
+      std::fill_n(F, 3 * a_nd, 0.0);
+      if (degs[a_nd-1] != 0)
+        SumSHMulti<double>(A, double(m_Re / r), a_nd, degs, F);
+
+      for (int j = 0; j < a_nd; ++j)
+      for (size_t i = 0; i < 3; ++i)
+        a_accs[j][i] += mainAcc * (F[3 * j + int(i)] - A[i]);
+    }
+
+    //-----------------------------------------------------------------------//
+    // Several Max Degrees, Each at Its Own Position:                        //
+    //-----------------------------------------------------------------------//
+    // The acceleration of the degree "a_degs[j]" (as in "Multi") at "a_pos[j]"
+    // is ADDED to "a_accs[j]", for j = 0 .. a_nd-1 (eg for trajectories of dif-
+    // ferent degrees propagated together, see "MultiDegreeGravity.hpp"). The
+    // positions are processed in groups of 4 AVX2 lanes, each group in one
+    // pass of "SumSHMulti" up to its max degree, so the cost is about that of
+    // one or two "GravAcc" calls with the max degree. Like the batched evalua-
+    // tor, does not use the work buffers, so it is "const":
+    //
+    static void GravAccMultiAt
+    (
+      Time                    a_t,                   // For info only
+      int                     a_nd,                  // Number of degrees
+      int const               a_degs[],              // Max orders used
+      PosVRot<BodyName> const a_pos [],              // Same size
+      AccVRot<BodyName>       a_accs[]               // Ditto
+    )
+    { ThisThread().MultiAt(a_t, a_nd, a_degs, a_pos, a_accs); }
+
+    void MultiAt
+    (
+      Time                    a_t,                   // For info only
+      int                     a_nd,                  // Number of degrees
+      int const               a_degs[],              // Max orders used
+      PosVRot<BodyName> const a_pos [],              // Same size
+      AccVRot<BodyName>       a_accs[]               // Ditto
+    )
+    const
+    {
+      assert(a_degs != nullptr && a_pos != nullptr && a_accs != nullptr);
+      if (UNLIKELY(a_nd <= 0 || a_nd > MaxSnaps))
+        throw std::invalid_argument
+              ("GravAccMultiAt: Invalid Number of Degrees");
+
+      int degs[MaxSnaps];
+      for (int j = 0; j < a_nd; ++j)
+      {
+        degs[j] = Degree(a_degs[j]);
+        if (UNLIKELY(j > 0 && degs[j] <= degs[j-1]))
+          throw std::invalid_argument("GravAccMultiAt: Degrees not Ascending");
+      }
+      constexpr int L = SIMDTraits<DoubleV4>::Lanes;
+
+      for (int j0 = 0; j0 < a_nd; j0 += L)
+      {
+        // The lane "k" is the position "j0+k"; the unused lanes of the last
+        // group replicate the last position, and their results are discarded:
+        int const ns = std::min(L, a_nd - j0);
+        DoubleV4  A[3];
+        DoubleV4  ir;
+        Acc       mainAcc[L];
+
+        for (int k = 0; k < L; ++k)
+        {
+          PosVRot<BodyName> const& pos = a_pos[j0 + std::min(k, ns - 1)];
+          Len x = pos[0];
+          Len y = pos[1];
+          Len z = pos[2];
+          Len r = SqRt(Sqr(x) + Sqr(y) + Sqr(z));
+
+          if (UNLIKELY(r <= m_rImpact))
+            Impact(a_t, x, y, z);
+
+          SetLane(&A[0], k, double(x  / r));
+          SetLane(&A[1], k, double(y  / r));
+          SetLane(&A[2], k, double(z  / r));
+          SetLane(&ir,   k, double(m_Re / r));
+          mainAcc[k] = m_K / Sqr(r);
+        }
+
+        // All degrees of the group at all its positions; the lane "k" of the
+        // result for the degree "j0+k" is used:
+        DoubleV4 F[3 * L];
+        std::fill_n(F, 3 * L, Splat<DoubleV4>(0.0));
+        if (degs[j0 + ns - 1] != 0)
+          SumSHMulti<DoubleV4>(A, ir, ns, degs + j0, F);
+
+        for (int k = 0; k < ns; ++k)
+        for (int i = 0; i < 3; ++i)
+          a_accs[j0 + k][size_t(i)] +=
+            mainAcc[k] * (GetLane(F[3 * k + i], k) - GetLane(A[i], k));
+      }
+    }
+
+    //=======================================================================//
+    // Low-Degree Fast Paths:                                                //
+    //=======================================================================//
+    //-----------------------------------------------------------------------//
+    // "GravAcc<Deg>": Same as "GravAcc" above, with a compile-time degree:  //
+    //-----------------------------------------------------------------------//
+    // For low degrees (eg 8 for quick screening, up to "MaxFixedDeg"),  the
+    // summation is fully unrolled, with the recursion coeffs folded in as
+    // consts (see "SumSHFixed"). The model coeffs are still read from the
+    // model, but they are few and stay in L1:
+    //
+    template<int Deg>
+    static void GravAcc
+    (
+      Time                     a_t,                  // For info only
+      PosVRot<BodyName> const& a_pos,
+      AccVRot<BodyName>*       a_acc,
+      bool                     a_zonal_only = false  // Zonal Harmonics only?
+    )
+    { ThisThread().template Fixed<Deg>(a_t, a_pos, a_acc, a_zonal_only); }
+
+    template<int Deg>
+    void Fixed
+    (
+      Time                     a_t,                  // For info only
+      PosVRot<BodyName> const& a_pos,
+      AccVRot<BodyName>*       a_acc,
+      bool                     a_zonal_only = false  // Zonal Harmonics only?
+    )
+    {
+      static_assert(Deg >= 2, "For Deg=0, use GravAcc(..., 0)");
+      Eval<false, false, Deg>(a_t, a_pos, a_acc, Deg, a_zonal_only);
+    }
+
+    //-----------------------------------------------------------------------//
+    // "GravAccJ<MaxJ>": Closed-Form Zonal Field (J2 .. J<MaxJ>, MaxJ <= 6):  //
+    //-----------------------------------------------------------------------//
+    // The J coeffs are taken from the model (see "EvalZonal"); the result is
+    // the same as that of "GravAcc(..., MaxJ, true)", up to rounding errors:
+    //
+    template<int MaxJ>
+    static void GravAccJ
+    (
+      Time                     a_t,                  // For info only
+      PosVRot<BodyName> const& a_pos,
+      AccVRot<BodyName>*       a_acc
+    )
+    { ThisThread().template EvalZonal<MaxJ>(a_t, a_pos, a_acc); }
+
+    template<int MaxJ>
+    void Zonal
+    (
+      Time                     a_t,                  // For info only
+      PosVRot<BodyName> const& a_pos,
+      AccVRot<BodyName>*       a_acc
+    )
+    const
+    { EvalZonal<MaxJ>(a_t, a_pos, a_acc); }
+
+    //=======================================================================//
+    // Gravitational Acceleration: Non-Singular Cartesian Formulation:       //
+    //=======================================================================//
+    // Same as "GravAcc" / "operator()" above, but uses the Pines formulation
+    // (see "SumPines") which requires no trig functions and is regular on the
+    // polar axis; recommended for polar orbits.
+    // NB: The Pines functions Q(l,m) = P(l,m) / cos(phi)^m are not bounded by
+    // the sectoral terms: near the poles, they grow up to ~10^(0.21*l), so
+    // they overflow in "double" for degrees above "MaxPinesDeg"; then the Sph-
+    // erical formulation must be used:
+    //
+    constexpr static int MaxPinesDeg = 1400;
+
+    static void GravAccPines
+    (
+      Time                     a_t,                  // For info only
+      PosVRot<BodyName> const& a_pos,
+      AccVRot<BodyName>*       a_acc,
+      int                      a_n          = FullDeg, // Max order used
+      bool                     a_zonal_only = false  // Zonal Harmonics only?
+    )
+    { ThisThread().Pines(a_t, a_pos, a_acc, a_n, a_zonal_only); }
+
+    void Pines
+    (
+      Time                     a_t,                  // For info only
+      PosVRot<BodyName> const& a_pos,
+      AccVRot<BodyName>*       a_acc,
+      int                      a_n          = FullDeg, // Max order used
+      bool                     a_zonal_only = false  // Zonal Harmonics only?
+    )
+    { Eval<true>(a_t, a_pos, a_acc, a_n, a_zonal_only); }
+
+    //=======================================================================//
+    // Acceleration, Potential and Gravity-Gradient Tensor in One Pass:      //
+    //=======================================================================//
+    // The Gravity-Gradient Tensor is d(acc)/d(pos) (as required by implicit
+    // integrators and the variational equations); it is symmetric and, apart
+    // from rounding errors, traceless. As with "GravAcc", all results are
+    // ADDED to the outputs, which must be properly initialised beforehand.
+    // Uses the Pines formulation, so it is regular on the polar axis. The cost
+    // is only moderately higher than that of "GravAccPines" (the coeffs are
+    // streamed once), vs 7 times for a central-differences tensor:
+    //
+    static void GravAccGrad
+    (
+      Time                     a_t,                  // For info only
+      PosVRot<BodyName> const& a_pos,
+      AccVRot<BodyName>*       a_acc,
+      GravPot*                 a_pot,
+      GravGradTRot<BodyName>*  a_grad,
+      int                      a_n          = FullDeg, // Max order used
+      bool                     a_zonal_only = false  // Zonal Harmonics only?
+    )
+    {
+      ThisThread().AccGrad(a_t, a_pos, a_acc, a_pot, a_grad, a_n,
+                           a_zonal_only);
+    }
+
+    void AccGrad
+    (
+      Time                     a_t,                  // For info only
+      PosVRot<BodyName> const& a_pos,
+      AccVRot<BodyName>*       a_acc,
+      GravPot*                 a_pot,
+      GravGradTRot<BodyName>*  a_grad,
+      int                      a_n          = FullDeg, // Max order used
+      bool                     a_zonal_only = false  // Zonal Harmonics only?
+    )
+    { Eval<true, true>(a_t, a_pos, a_acc, a_n, a_zonal_only, a_pot, a_grad); }
+
+    //-----------------------------------------------------------------------//
+    // "ResAccGrad": Same as above, for the Degrees a_n_low+1 .. a_n Only:   //
+    //-----------------------------------------------------------------------//
+    // The residual of the field of degree "a_n" wrt that of degree "a_n_low"
+    // (0 or 2 .. a_n), and its Gravity-Gradient Tensor, are ADDED to "a_acc"
+    // and "a_grad" (the potential is not computed). The result is the same as
+    // the difference of two "AccGrad" calls (up to rounding errors), but the
+    // coeffs are streamed only once, so the cost is that of one such call:
+    //
+    void ResAccGrad
+    (
+      Time                     a_t,                  // For info only
+      PosVRot<BodyName> const& a_pos,
+      AccVRot<BodyName>*       a_acc,
+      GravGradTRot<BodyName>*  a_grad,
+      int                      a_n_low,
+      int                      a_n          = FullDeg // Max order used
+    )
+    {
+      assert(a_acc != nullptr && a_grad != nullptr);
+      int const n = Degree(a_n);
+      if (UNLIKELY(a_n_low < 0 || a_n_low == 1 || a_n_low > n))
+        throw std::invalid_argument("ResAccGrad: Invalid Low Degree");
+      if (UNLIKELY(n > MaxPinesDeg))
+        throw std::invalid_argument("ResAccGrad: Degree too high");
+      if (n == a_n_low)
+        return;
+
+      Len  x       = a_pos[0];
+      Len  y       = a_pos[1];
+      Len  z       = a_pos[2];
+      Len2 r2      = Sqr(x) + Sqr(y) + Sqr(z);
+      Len  r       = SqRt(r2);
+
+      if (UNLIKELY(r <= m_rImpact))
+        Impact(a_t, x, y, z);
+
+      double const A[3] { double(x/r), double(y/r), double(z/r) };
+      double       F[3] {0.0, 0.0, 0.0};
+      double       U     = 0.0;
+      double       G[6] {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+      SumPines<double, true>
+        (A, double(m_Re / r), n, false, F, &U, G, std::max(a_n_low + 1, 2));
+
+      // Unlike "Eval", there are no central terms here:
+      Acc      mainAcc  = m_K / r2;
+      GravGrad mainGrad = mainAcc / r;
+      constexpr int IJ[3][3] { { 0, 3, 4 }, { 3, 1, 5 }, { 4, 5, 2 } };
+      for (int i = 0; i < 3; ++i)
+      {
+        (*a_acc)[size_t(i)] += mainAcc * F[i];
+        for (int j = 0; j < 3; ++j)
+          (*a_grad)[size_t(i)][size_t(j)] += mainGrad * G[IJ[i][j]];
+      }
+    }
+
+    //=======================================================================//
+    // Batched Gravitational Acceleration Computation:                       //
+    //=======================================================================//
+    // Same as "GravAcc" above, but for "a_np" positions given as a Structure-
+    // of-Arrays.  The positions are processed in groups of 4 (one AVX2 lane
+    // per position), so the model coeffs are streamed once per group, rather
+    // than once per position.  The accelerations are ADDED to the output ar-
+    // rays. If any position is an "impact" one, "ImpactExn" is thrown for the
+    // first such position, and the output is left in an unspecified state.
+    // The batched evaluator does not use the work buffers, so (unlike all the
+    // others) it is "const" and may be invoked on a shared evaluator from any
+    // number of threads:
+    //
+    static void GravAccBatch
+    (
+      Time       a_t,                    // For info only
+      int        a_np,                   // Number of positions
+      Len const  a_x    [],              // Positions (in the BodyCentric-
+      Len const  a_y    [],              //   RotatingCOS)
+      Len const  a_z    [],              //
+      Acc        a_acc_x[],              // Accelerations (ditto)
+      Acc        a_acc_y[],              //
+      Acc        a_acc_z[],              //
+      int        a_n          = FullDeg, // Max order used
+      bool       a_zonal_only = false    // Zonal Harmonics only?
+    )
+    {
+      ThisThread()(a_t, a_np, a_x, a_y, a_z, a_acc_x, a_acc_y, a_acc_z, a_n,
+                   a_zonal_only);
+    }
+
+    void operator()
+    (
+      Time       a_t,                    // For info only
+      int        a_np,                   // Number of positions
+      Len const  a_x    [],              // Positions (in the BodyCentric-
+      Len const  a_y    [],              //   RotatingCOS)
+      Len const  a_z    [],              //
+      Acc        a_acc_x[],              // Accelerations (ditto)
+      Acc        a_acc_y[],              //
+      Acc        a_acc_z[],              //
+      int        a_n          = FullDeg, // Max order used
+      bool       a_zonal_only = false    // Zonal Harmonics only?
+    )
+    const
+    {
+      EvalBatch<DoubleV4, void>
+        (a_t, a_np, a_x, a_y, a_z, a_acc_x, a_acc_y, a_acc_z, a_n,
+         a_zonal_only, 0);
+    }
+
+    //=======================================================================//
+    // Mixed-Precision Evaluation:                                           //
+    //=======================================================================//
+    // The terms of degrees above "a_L" (which contribute to the acceleration
+    // at the relative level of ~1e-9 for L=100 in low orbits) are summed up
+    // in "float" arithmetic, using the "float" copy of the coeffs (which halves
+    // the memory traffic), see "SumSHMixed"; the batched version processes 8
+    // positions at once in AVX2 "float" lanes. The error is estimated a-priori
+    // by "MixedErrEst" below, which allows to select "a_L" for the required
+    // accuracy and the range of altitudes of the given mission.
+    // NB: On the first call, the "float" copy of the coeffs is created,  so
+    // (unlike the "double" batched evaluator) these methods are not "const",
+    // and the evaluator must not be shared between threads; the static ver-
+    // sions use the Evaluator of the calling thread:
+    //
+    constexpr static int MixedDeg = 100;
+
+    static void GravAccMixed
+    (
+      Time                     a_t,                  // For info only
+      PosVRot<BodyName> const& a_pos,
+      AccVRot<BodyName>*       a_acc,
+      int                      a_L = MixedDeg,       // Max "double" degree
+      int                      a_n = FullDeg         // Max order used
+    )
+    { ThisThread().Mixed(a_t, a_pos, a_acc, a_L, a_n); }
+
+    void Mixed
+    (
+      Time                     a_t,                  // For info only
+      PosVRot<BodyName> const& a_pos,
+      AccVRot<BodyName>*       a_acc,
+      int                      a_L = MixedDeg,       // Max "double" degree
+      int                      a_n = FullDeg         // Max order used
+    )
+    {
+      assert(a_acc != nullptr);
+      MkCoeffsF();
+      // A single position is a batch of 1 with scalar "lanes":
+      Acc* acc = a_acc->data();
+      EvalBatch<double, float>
+        (a_t, 1, a_pos.data(), a_pos.data() + 1, a_pos.data() + 2,
+         acc, acc + 1, acc + 2, a_n, false, a_L);
+    }
+
+    static void GravAccMixedBatch
+    (
+      Time       a_t,                    // For info only
+      int        a_np,                   // Number of positions
+      Len const  a_x    [],              // Positions (in the BodyCentric-
+      Len const  a_y    [],              //   RotatingCOS)
+      Len const  a_z    [],              //
+      Acc        a_acc_x[],              // Accelerations (ditto)
+      Acc        a_acc_y[],              //
+      Acc        a_acc_z[],              //
+      int        a_L = MixedDeg,         // Max "double" degree
+      int        a_n = FullDeg           // Max order used
+    )
+    {
+      ThisThread().MixedBatch(a_t, a_np, a_x, a_y, a_z, a_acc_x, a_acc_y,
+                              a_acc_z, a_L, a_n);
+    }
+
+    void MixedBatch
+    (
+      Time       a_t,                    // For info only
+      int        a_np,                   // Number of positions
+      Len const  a_x    [],              // Positions (in the BodyCentric-
+      Len const  a_y    [],              //   RotatingCOS)
+      Len const  a_z    [],              //
+      Acc        a_acc_x[],              // Accelerations (ditto)
+      Acc        a_acc_y[],              //
+      Acc        a_acc_z[],              //
+      int        a_L = MixedDeg,         // Max "double" degree
+      int        a_n = FullDeg           // Max order used
+    )
+    {
+      MkCoeffsF();
+      EvalBatch<DoubleV8, FloatV8>
+        (a_t, a_np, a_x, a_y, a_z, a_acc_x, a_acc_y, a_acc_z, a_n, false,
+         a_L);
+    }
+
+    //-----------------------------------------------------------------------//
+    // "MixedErrEst": A-Priori Error Estimate for the Mixed Precision:      //
+    //-----------------------------------------------------------------------//
+    // The magnitude of the difference between the mixed-precision and the
+    // "double" accelerations at the radius "r" is estimated as
+    //   K/r^2 * eps * Sum_{l=L+1}^n (Re/r)^l * w(l) * (1 + l/8),
+    // where eps = 2^-24 is the "float" unit round-off and "w(l)" are the
+    // per-degree bounds (see "MkDegreeBounds"). The "1" accounts for the
+    // rounding of the coeffs, and the "l/8" for the accumulated rounding of
+    // the Legendre recursion and the summation in each column (which is lin-
+    // ear in the length of the column, as the recursion is stable).  This is
+    // a 1st-order forward error estimate rather than a strict bound;  as the
+    // "w(l)" are themselves pessimistic, it over-estimates the actual errors
+    // (by a factor of 5..50 in our tests):
+    //
+    Acc MixedErrEst(Len a_r, int a_L = MixedDeg, int a_n = FullDeg) const
+    {
+      int const n = Degree(a_n);
+      if (UNLIKELY(a_L < 0 || !IsPos(a_r)))
+        throw std::invalid_argument("MixedErrEst: Invalid Param(s)");
+
+      constexpr double eps = 1.0 / double(1 << 24);
+      double const ir  = double(m_Re / a_r);
+      double       irl = 1.0;
+      double       sum = 0.0;
+      for (int l = 1; l <= n; ++l)
+      {
+        irl *= ir;
+        if (l > a_L)
+          sum += irl * m_degBounds[size_t(l)] * (1.0 + double(l) / 8.0);
+      }
+      return m_K / Sqr(a_r) * (eps * sum);
+    }
+
+    //=======================================================================//
+    // Partials of the Acceleration wrt the Model Coeffs:                    //
+    //=======================================================================//
+    // For orbit determination and gravity recovery: for each of the "a_ne"
+    // epochs (with the positions in the BodyCentricRotatingCOS given as a
+    // Structure-of-Arrays, as in "GravAccBatch"), the partials of the accel-
+    // eration (in m/sec^2) wrt the coeffs C(l,m) and S(l,m) of all degrees up
+    // to "n" are WRITTEN into the rows 3*e .. 3*e+2 (for the "x", "y", "z"
+    // components resp) of the row-major matrix "a_D", with the row stride
+    // "a_ld" >= NPartials(n). The column of C(l,m) is
+    //   2 * GravityModel::CoeffIdx(l, m, n),
+    // followed by that of S(l,m) (ie the same order-major layout as that of
+    // the coeffs themselves); the columns for l < 2 and for S(l,0) are 0. As
+    // the acceleration is linear in the coeffs, the product of the 3 rows and
+    // the vector of the coeffs in this layout is the non-central acceleration.
+    // The Legendre functions and Cos/Sin(m*lambda) are computed once per epoch
+    // (as in "GravAcc"), so the cost is 2..3 times that of "GravAcc" (mostly
+    // the memory bandwidth for the output: 6*NCoeffs(n) doubles per epoch). The
+    // epochs are processed in parallel using "a_pool";  this method is "const"
+    // and does not use the work buffers,  so the evaluator may be shared. If
+    // any position is an "impact" one, "ImpactExn" is thrown:
+    //
+    int NPartials(int a_n = FullDeg) const
+      { return 2 * GravityModel::NCoeffs(Degree(a_n)); }
+
+    static void GravAccPartials
+    (
+      int         a_ne,                  // Number of epochs
+      Time const  a_t[],                 // For info only
+      Len  const  a_x[],                 // Positions (in the BodyCentric-
+      Len  const  a_y[],                 //   RotatingCOS)
+      Len  const  a_z[],                 //
+      double*     a_D,                   // Output: (3*a_ne) x NPartials(n)
+      size_t      a_ld,                  // Row stride of "a_D"
+      ThreadPool& a_pool,
+      int         a_n = FullDeg          // Max order used
+    )
+    { ThisThread().Partials(a_ne, a_t, a_x, a_y, a_z, a_D, a_ld, a_pool, a_n); }
+
+    void Partials
+    (
+      int         a_ne,                  // Number of epochs
+      Time const  a_t[],                 // For info only
+      Len  const  a_x[],                 // Positions (in the BodyCentric-
+      Len  const  a_y[],                 //   RotatingCOS)
+      Len  const  a_z[],                 //
+      double*     a_D,                   // Output: (3*a_ne) x NPartials(n)
+      size_t      a_ld,                  // Row stride of "a_D"
+      ThreadPool& a_pool,
+      int         a_n = FullDeg          // Max order used
+    )
+    const
+    {
+      int const n = Degree(a_n);
+      if (UNLIKELY(a_ne < 0 || a_D == nullptr ||
+                   a_ld < size_t(NPartials(n))))
+        throw std::invalid_argument("GravAccPartials: Invalid Param(s)");
+      assert(a_t != nullptr && a_x != nullptr && a_y != nullptr &&
+             a_z != nullptr);
+
+      a_pool.ParallelFor
+      (
+        a_ne,
+        [&](int a_e)
+        {
+          size_t const e  = size_t(a_e);
+          double*      D0 = a_D + 3 * e * a_ld;
+          PartialsAt(a_t[e], a_x[e], a_y[e], a_z[e], n, D0, D0 + a_ld,
+                     D0 + 2 * a_ld);
+        }
+      );
+    }
+
+  private:
+    //=======================================================================//
+    // "EvalBatch": Common Implementation of the Batched Evaluators:         //
+    //=======================================================================//
+    // "VD" is the "double" lanes type; if "VF" is not "void", it is the corr-
+    // esp "float" type, and the tail of degrees above "a_L" is summed up in
+    // "float" (see "SumSHMixed"):
+    //
+    template<typename VD, typename VF>
+    void EvalBatch
+    (
+      Time       a_t,
+      int        a_np,
+      Len const  a_x    [],
+      Len const  a_y    [],
+      Len const  a_z    [],
+      Acc        a_acc_x[],
+      Acc        a_acc_y[],
+      Acc        a_acc_z[],
+      int        a_n,
+      bool       a_zonal_only,
+      int        a_L
+    )
+    const
+    {
+      //---------------------------------------------------------------------//
+      // Checks:                                                             //
+      //---------------------------------------------------------------------//
+      assert(a_np >= 0      && a_x     != nullptr && a_y     != nullptr &&
+             a_z != nullptr && a_acc_x != nullptr && a_acc_y != nullptr &&
+             a_acc_z != nullptr);
+      int const n = Degree(a_n);
+      if (UNLIKELY(a_L < 0))
+        throw std::invalid_argument("GravAccMixed: Invalid Degree");
+
+      constexpr int L = SIMDTraits<VD>::Lanes;
+
+      for (int i = 0; i < a_np; i += L)
+      {
+        //-------------------------------------------------------------------//
+        // Load the lanes:                                                   //
+        //-------------------------------------------------------------------//
+        // The unused lanes of the last group replicate the last position, and
+        // their results are discarded:
+        VD  A[3];
+        VD  ir;
+        Acc mainAcc[L];
+
+        for (int k = 0; k < L; ++k)
+        {
+          int j  = std::min(i + k, a_np - 1);
+          Len x  = a_x[j];
+          Len y  = a_y[j];
+          Len z  = a_z[j];
+          Len r  = SqRt(Sqr(x) + Sqr(y) + Sqr(z));
+
+          if (UNLIKELY(r <= m_rImpact))
+            Impact(a_t, x, y, z);
+
+          SetLane(&A[0], k, double(x  / r));
+          SetLane(&A[1], k, double(y  / r));
+          SetLane(&A[2], k, double(z  / r));
+          SetLane(&ir,   k, double(m_Re / r));
+          mainAcc[k] = m_K / Sqr(r);
+        }
+        //-------------------------------------------------------------------//
+        // Sum up the Spherical Harmonics (unless n==0):                     //
+        //-------------------------------------------------------------------//
+        VD F[3] { Splat<VD>(0.0), Splat<VD>(0.0), Splat<VD>(0.0) };
+        if (n != 0)
+        {
+          if constexpr (std::is_void_v<VF>)
+            SumSH<VD>(A, ir, n, a_zonal_only, F);
+          else
+            SumSHMixed<VD, VF>(A, ir, n, a_L, F);
+        }
+        //-------------------------------------------------------------------//
+        // Store the results:                                                //
+        //-------------------------------------------------------------------//
+        for (int k = 0; k < L && i + k < a_np; ++k)
+        {
+          a_acc_x[i+k] += mainAcc[k] * (GetLane(F[0], k) - GetLane(A[0], k));
+          a_acc_y[i+k] += mainAcc[k] * (GetLane(F[1], k) - GetLane(A[1], k));
+          a_acc_z[i+k] += mainAcc[k] * (GetLane(F[2], k) - GetLane(A[2], k));
+        }
+      }
+    }
+
+    //-----------------------------------------------------------------------//
+    // "MkCoeffsF": Creates the "float" Copy of the Coeffs (once):           //
+    //-----------------------------------------------------------------------//
+    // (In the layout for the degree "m_N", which may be lower than that of the
+    // "double" coeffs):
+    //
+    void MkCoeffsF()
+    {
+      if (m_N == 0 || !m_coeffsF.empty())
+        return;
+      m_coeffsF.resize(size_t(GravityModel::NCoeffs(m_N)));
+      for (int m = 0; m <= m_N; ++m)
+      {
+        PackedSHCoeffs const* col  = Col(m);
+        PackedSHCoeffsF*      colF =
+          m_coeffsF.data() + (GravityModel::ColIdx(m, m_N) - m);
+        for (int l = m; l <= m_N; ++l)
+          colF[l] = PackedSHCoeffsF
+                    { float(col[l].m_Clm), float(col[l].m_Slm) };
       }
     }
   };
@@ -0,0 +1,439 @@
+// vim:ts=2:et
+//===========================================================================//
+//                "SpaceBallistics/PhysForces/GravityGrid.h":                //
+//      Pre-Computed Gravitational Acceleration on a Spherical-Shell Grid    //
+//===========================================================================//
+#pragma once
+#include "SpaceBallistics/PhysForces/GravityField.hpp"
+#include "SpaceBallistics/SIMD.hpp"
+#include "SpaceBallistics/ThreadPool.hpp"
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace SpaceBallistics
+{
+  //=========================================================================//
+  // "GravityGridBase" Class:                                                //
+  //=========================================================================//
+  // The Body-independent part of "GravityGrid" (see below): the grid file
+  // I/O, the error bound and the interpolation itself:
+  //
+  class GravityGridBase
+  {
+  protected:
+    //=======================================================================//
+    // Data Flds:                                                            //
+    //=======================================================================//
+    Body          m_body;
+    int           m_n;         // Degree used in the pre-computation
+    int           m_NR;        // Number of radial    nodes (>= 4)
+    int           m_NLat;      // Number of latitude  intervals (>= 4)
+    int           m_NLon;      // Number of longitude intervals (>= 4, even)
+    Len           m_rMin;
+    Len           m_rMax;
+    GM            m_K;
+    Acc           m_errBound;  // Interpolation Error Bound (see "MkErrBound")
+
+    // Derived consts for the look-ups (in SI units):
+    double        m_r0;        // = m_rMin
+    double        m_idr;       // 1 / radial  step
+    double        m_idPhi;     // 1 / latitude  step
+    double        m_idLambda;  // 1 / longitude step
+    size_t        m_rowLen;    // Nodes per row   (m_NLon + 3)
+    size_t        m_shellLen;  // Nodes per shell (m_rowLen * (m_NLat + 3))
+
+    // The "mmap"ed file and the node data: 4 doubles (the non-central accele-
+    // ration components in m/sec^2, and 0) per node, in the (r, phi, lambda)
+    // order:
+    double const* m_data;
+    void*         m_map;
+    size_t        m_mapLen;
+
+    //=======================================================================//
+    // Ctors, Dtor:                                                          //
+    //=======================================================================//
+    // Loads ("mmap"s) the grid from "a_file" created by "GravityGrid::Build".
+    // Throws "std::runtime_error" if the file does not exist or is invalid
+    // (format, checksum), or if it was created for a different Body:
+    //
+    GravityGridBase(std::string const& a_file, Body a_body);
+
+  public:
+    // Move-only:
+    GravityGridBase(GravityGridBase const&)            = delete;
+    GravityGridBase& operator=(GravityGridBase const&) = delete;
+    GravityGridBase(GravityGridBase&& a_right)         noexcept;
+    GravityGridBase& operator=(GravityGridBase&&)      = delete;
+    ~GravityGridBase();
+
+    //=======================================================================//
+    // Accessors:                                                            //
+    //=======================================================================//
+    Body GetBody()  const { return m_body;     }
+    int  Degree()   const { return m_n;        }
+    int  NR()       const { return m_NR;       }
+    int  NLat()     const { return m_NLat;     }
+    int  NLon()     const { return m_NLon;     }
+    Len  RMin()     const { return m_rMin;     }
+    Len  RMax()     const { return m_rMax;     }
+
+    // Upper bound on the magnitude of the interpolation error, valid for all
+    // positions in the band (see "MkErrBound" below):
+    Acc  ErrBound() const { return m_errBound; }
+
+    //=======================================================================//
+    // "MkErrBound":                                                         //
+    //=======================================================================//
+    // A rigorous bound on the interpolation error, from the per-degree bounds
+    // "w(l)" of the field (see "GravityField::MkDegreeBounds").  For a fixed
+    // "r", the acceleration terms of degree "l" are spherical harmonics of de-
+    // gree l+1, so along any meridian or parallel they are trig polynomials of
+    // degree <= l+1,  and by the Bernstein inequality, their 4th derivatives
+    // are bounded by (l+1)^4 times the terms themselves; the radial 4th deri-
+    // vative brings the factor (l+2)(l+3)(l+4)(l+5)/r^4. This is combined with
+    // the 4-point Lagrange remainder and Lebesgue consts for each dimension:
+    //
+    static Acc MkErrBound
+    (
+      GM            a_K,
+      Len           a_Re,
+      double const* a_w,        // w(l), l = 0 .. a_n
+      int           a_n,
+      Len           a_rmin,
+      Len           a_rmax,
+      int           a_NR,
+      int           a_NLat,
+      int           a_NLon
+    );
+
+  protected:
+    //=======================================================================//
+    // "Interp": Interpolated Acceleration (in SI units):                    //
+    //=======================================================================//
+    // See "GravityGrid::GravAcc":
+    //
+    bool Interp(double a_x, double a_y, double a_z, double a_acc[3]) const
+    {
+      assert(a_acc != nullptr);
+      double const x   = a_x;
+      double const y   = a_y;
+      double const z   = a_z;
+      double const rxy = std::sqrt(x * x + y * y);
+      double const r   = std::sqrt(x * x + y * y + z * z);
+
+      if (!(m_rMin.Magnitude() <= r && r <= m_rMax.Magnitude()))
+        return false;
+
+      double const phi    = std::atan2(z, rxy);
+      double       lambda = std::atan2(y, x);
+      if (lambda < 0.0)
+        lambda += 2.0 * Pi<double>;
+
+      // Stencil origins and Lagrange weights. Radially, the stencil is shift-
+      // ed inwards at the edges of the band; in (phi, lambda), it is always
+      // centred (due to the ghost nodes):
+      double wr[4], wp[4], wl[4];
+      int    i0 = 0, j0 = 0, k0 = 0;
+      StencilR(r,      &i0, wr);
+      Stencil ((phi + 0.5 * Pi<double>) * m_idPhi,    m_NLat, &j0, wp);
+      Stencil (lambda                   * m_idLambda, m_NLon, &k0, wl);
+
+      // Each node is 1 "DoubleV4" (the 4th component is 0), so the (x, y, z)
+      // components are interpolated at once:
+      DoubleV4 a = Splat<DoubleV4>(0.0);
+      for (int di = 0; di < 4; ++di)
+      {
+        DoubleV4 b = Splat<DoubleV4>(0.0);
+        for (int dj = 0; dj < 4; ++dj)
+        {
+          double const* v =
+            m_data + 4 * (size_t(i0 + di) * m_shellLen +
+                          size_t(j0 + dj) * m_rowLen   + size_t(k0));
+          DoubleV4 c = Splat<DoubleV4>(0.0);
+          for (int dk = 0; dk < 4; ++dk, v += 4)
+          {
+            DoubleV4 node;
+            memcpy(&node, v, sizeof(node));
+            c += wl[dk] * node;
+          }
+          b += wp[dj] * c;
+        }
+        a += wr[di] * b;
+      }
+      // Add the central term:
+      double const kr3 = m_K.Magnitude() / (r * r * r);
+      a_acc[0] = a[0] - kr3 * x;
+      a_acc[1] = a[1] - kr3 * y;
+      a_acc[2] = a[2] - kr3 * z;
+      return true;
+    }
+
+    //=======================================================================//
+    // Internal Utils:                                                       //
+    //=======================================================================//
+    // 4-point Lagrange weights for the nodes 0..3 at the point "s":
+    static void Weights(double a_s, double a_w[4])
+    {
+      double const s1 = a_s - 1.0;
+      double const s2 = a_s - 2.0;
+      double const s3 = a_s - 3.0;
+      // (Multiplications rather than divisions, as the latter are slow and
+      // cannot be replaced by the compiler for 1/6):
+      constexpr double I6 = 1.0 / 6.0;
+      a_w[0] = - I6  * s1  * s2 * s3;
+      a_w[1] =   0.5 * a_s * s2 * s3;
+      a_w[2] = - 0.5 * a_s * s1 * s3;
+      a_w[3] =   I6  * a_s * s1 * s2;
+    }
+
+    // Angular stencil: "a_s" is the CoOrd in steps, in [0, a_NI];  the stored
+    // node index is shifted by 1 (ghost), so the stencil origin "j0" for the
+    // interval [j, j+1] is "j" itself:
+    static void Stencil(double a_s, int a_NI, int* a_j0, double a_w[4])
+    {
+      int j = std::min(std::max(int(a_s), 0), a_NI - 1);
+      *a_j0 = j;
+      Weights(a_s - double(j) + 1.0, a_w);
+    }
+
+    void StencilR(double a_r, int* a_i0, double a_w[4]) const
+    {
+      double const s = (a_r - m_r0) * m_idr;
+      int    const i = std::min(std::max(int(s) - 1, 0), m_NR - 4);
+      *a_i0 = i;
+      Weights(s - double(i), a_w);
+    }
+
+    static void Save
+    (
+      std::string const& a_file,
+      Body               a_body,
+      int                a_n,
+      int                a_NR,
+      int                a_NLat,
+      int                a_NLon,
+      Len                a_rmin,
+      Len                a_rmax,
+      GM                 a_K,
+      Acc                a_err_bound,
+      double const*      a_data,
+      size_t             a_len
+    );
+  };
+
+  //=========================================================================//
+  // "GravityGrid" Class:                                                    //
+  //=========================================================================//
+  // For repeated evaluations of the same field within a narrow altitude band
+  // (eg Monte Carlo studies of low orbits):  the non-central part of the acce-
+  // leration is pre-computed (at the full or a given degree) on a grid of
+  // nodes uniform in (r, phi, lambda), and is then obtained by the tricubic
+  // (tensor-product 4-point Lagrange) interpolation. The central term K/r^2
+  // is added analytically.
+  // The grid is stored in a file which is "mmap"ed by all users, so concurr-
+  // ent processes share one copy of it in the OS page cache. The grid also
+  // has 1 row of ghost nodes beyond each Pole (continuing the meridians) and
+  // 3 ghost columns (periodicity in lambda), so the interpolation stencil is
+  // always contiguous in lambda and requires no index wrapping:
+  //
+  template<Body BodyName>
+  class GravityGrid: public GravityGridBase
+  {
+  public:
+    //=======================================================================//
+    // Ctor:                                                                 //
+    //=======================================================================//
+    // Loads the grid file created by "Build" below (see "GravityGridBase"):
+    //
+    explicit GravityGrid(std::string const& a_file)
+    : GravityGridBase(a_file, BodyName)
+    {}
+
+    //=======================================================================//
+    // "Build": Creates the Grid File:                                       //
+    //=======================================================================//
+    // The band is [a_rmin, a_rmax] (a_rmin > Re);  "a_NR" radial nodes and the
+    // steps Pi/a_NLat and 2*Pi/a_NLon in latitude and longitude are used. The
+    // node values are computed in parallel (by rows) using "a_pool"; the nodes
+    // on the polar axis are computed by the Pines formulation (the Spherical
+    // one is singular there). The file is written atomically (via a temporary
+    // file). The grid has 32 * a_NR * (a_NLat+3) * (a_NLon+3) bytes of data,
+    // and requires as many full evaluations of the field, so it is only worth
+    // building for long runs:
+    //
+    static void Build
+    (
+      GravityField<BodyName>& a_field,
+      std::string const&      a_file,
+      Len                     a_rmin,
+      Len                     a_rmax,
+      int                     a_NR,
+      int                     a_NLat,
+      int                     a_NLon,
+      ThreadPool&             a_pool,
+      int                     a_n = GravityField<BodyName>::FullDeg
+    )
+    {
+      if (UNLIKELY(!(a_field.GetRe() < a_rmin && a_rmin < a_rmax) ||
+                   a_NR < 4 || a_NLat < 4 || a_NLon < 4 || a_NLon % 2 != 0))
+        throw std::invalid_argument("GravityGrid::Build: Invalid Params");
+
+      int const n = (a_n == GravityField<BodyName>::FullDeg)
+                    ? a_field.MaxDeg() : a_n;
+      if (UNLIKELY(n < 0 || n == 1 || n > a_field.MaxDeg()))
+        throw std::invalid_argument("GravityGrid::Build: Invalid Degree");
+
+      size_t const rowLen   = size_t(a_NLon + 3);
+      size_t const shellLen = rowLen * size_t(a_NLat + 3);
+      std::vector<double> data(4 * shellLen * size_t(a_NR), 0.0);
+
+      double const dr      = (a_rmax - a_rmin).Magnitude() / double(a_NR - 1);
+      double const dPhi    = Pi<double>     / double(a_NLat);
+      double const dLambda = 2.0 * Pi<double> / double(a_NLon);
+      double const K       = a_field.GetK().Magnitude();
+
+      // Node (i, j, k) is at r = rmin + i*dr, phi = -Pi/2 + (j-1)*dPhi, lambda
+      // = (k-1)*dLambda:
+      auto node =
+        [&](int a_i, int a_j, int a_k) -> double*
+        {
+          return data.data() + 4 * (size_t(a_i) * shellLen +
+                                    size_t(a_j) * rowLen   + size_t(a_k));
+        };
+
+      //---------------------------------------------------------------------//
+      // The Poles (j = 1 and j = NLat+1):                                   //
+      //---------------------------------------------------------------------//
+      for (int i = 0; i < a_NR; ++i)
+      for (int j: { 1, a_NLat + 1 })
+      {
+        double const r = a_rmin.Magnitude() + double(i) * dr;
+        double const z = (j == 1) ? -r : r;
+        PosVRot<BodyName> pos {{ Len(0.0), Len(0.0), Len(z) }};
+        AccVRot<BodyName> acc {{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+        a_field.Pines(Time(0.0), pos, &acc, n);
+
+        // Subtract the central term, which is (0, 0, -K/z^2 * Sign(z)):
+        double const a[3]
+          { acc[0].Magnitude(), acc[1].Magnitude(),
+            acc[2].Magnitude() + K / (z * std::fabs(z)) };
+        for (int k = 1; k <= a_NLon; ++k)
+          std::copy(a, a + 3, node(i, j, k));
+      }
+
+      //---------------------------------------------------------------------//
+      // All other rows, in parallel (the batched evaluator is "const"):     //
+      //---------------------------------------------------------------------//
+      GravityField<BodyName> const& field = a_field;
+      int const nRows = a_NR * (a_NLat - 1);
+
+      a_pool.ParallelFor
+      (
+        nRows,
+        [&](int a_row)
+        {
+          int const    i   = a_row / (a_NLat - 1);
+          int const    j   = a_row % (a_NLat - 1) + 2;
+          double const r   = a_rmin.Magnitude() + double(i) * dr;
+          double const phi = - 0.5 * Pi<double> + double(j - 1) * dPhi;
+
+          size_t const     nl = size_t(a_NLon);
+          std::vector<Len> x (nl);
+          std::vector<Len> y (nl);
+          std::vector<Len> z (nl);
+          std::vector<Acc> ax(nl, Acc(0.0));
+          std::vector<Acc> ay(nl, Acc(0.0));
+          std::vector<Acc> az(nl, Acc(0.0));
+          for (size_t k = 0; k < nl; ++k)
+          {
+            double const lambda = double(k) * dLambda;
+            x[k] = Len(r * std::cos(phi) * std::cos(lambda));
+            y[k] = Len(r * std::cos(phi) * std::sin(lambda));
+            z[k] = Len(r * std::sin(phi));
+          }
+          field(Time(0.0), a_NLon, x.data(), y.data(), z.data(),
+                ax.data(), ay.data(), az.data(), n);
+
+          // Subtract the central term -K/r^3 * pos:
+          double const kr3 = K / (r * r * r);
+          for (size_t k = 0; k < nl; ++k)
+          {
+            double* v = node(i, j, int(k) + 1);
+            v[0] = ax[k].Magnitude() + kr3 * x[k].Magnitude();
+            v[1] = ay[k].Magnitude() + kr3 * y[k].Magnitude();
+            v[2] = az[k].Magnitude() + kr3 * z[k].Magnitude();
+          }
+        }
+      );
+
+      //---------------------------------------------------------------------//
+      // Ghost Nodes:                                                        //
+      //---------------------------------------------------------------------//
+      // Beyond the Poles: (phi, lambda) -> (+-Pi - phi, lambda + Pi), so the
+      // ghost row j=0 is the row j=2, and the row NLat+2 is the row NLat,
+      // shifted by NLon/2:
+      int const half = a_NLon / 2;
+      for (int i = 0; i < a_NR; ++i)
+      {
+        for (int k = 1; k <= a_NLon; ++k)
+        {
+          int const ks = (k - 1 + half) % a_NLon + 1;
+          std::copy_n(node(i, 2,      ks), 3, node(i, 0,          k));
+          std::copy_n(node(i, a_NLat, ks), 3, node(i, a_NLat + 2, k));
+        }
+        // Periodicity in lambda: k=0 is k=NLon, and k=NLon+1,NLon+2 are 1,2:
+        for (int j = 0; j <= a_NLat + 2; ++j)
+        {
+          std::copy_n(node(i, j, a_NLon), 3, node(i, j, 0));
+          std::copy_n(node(i, j, 1),      3, node(i, j, a_NLon + 1));
+          std::copy_n(node(i, j, 2),      3, node(i, j, a_NLon + 2));
+        }
+      }
+
+      //---------------------------------------------------------------------//
+      // Error Bound and Output:                                             //
+      //---------------------------------------------------------------------//
+      std::vector<double> w(size_t(n + 1), 0.0);
+      for (int l = 2; l <= n; ++l)
+        w[size_t(l)] = a_field.DegreeBound(l);
+
+      Acc errBound =
+        MkErrBound(a_field.GetK(), a_field.GetRe(), w.data(), n,
+                   a_rmin, a_rmax, a_NR, a_NLat, a_NLon);
+
+      Save(a_file, BodyName, n, a_NR, a_NLat, a_NLon, a_rmin, a_rmax,
+           a_field.GetK(), errBound, data.data(), data.size());
+    }
+
+    //=======================================================================//
+    // "GravAcc": Interpolated Acceleration:                                 //
+    //=======================================================================//
+    // ADDS the acceleration at "a_pos" to "a_acc", similar to "GravityField::
+    // GravAcc", and returns "true" if "a_pos" is within the band; otherwise,
+    // "a_acc" is unchanged and "false" is returned (so the caller can use the
+    // full evaluator instead). The cost is that of 2 "atan2"s and 84 (4-wide)
+    // FMAs:
+    //
+    bool GravAcc
+    (
+      Time,                                          // For info only
+      PosVRot<BodyName> const& a_pos,
+      AccVRot<BodyName>*       a_acc
+    )
+    const
+    {
+      assert(a_acc != nullptr);
+      double a[3];
+      if (!Interp(a_pos[0].Magnitude(), a_pos[1].Magnitude(),
+                  a_pos[2].Magnitude(), a))
+        return false;
+      for (size_t i = 0; i < 3; ++i)
+        (*a_acc)[i] += Acc(a[i]);
+      return true;
+    }
+  };
+}
+// End namespace SpaceBallistics
@@ -0,0 +1,266 @@
+// vim:ts=2:et
+//===========================================================================//
+//                 "SpaceBallistics/PhysForces/GravityMap.h":                //
+//     Global Maps of the Gravitational Field on Latitude/Longitude Grids    //
+//===========================================================================//
+#pragma once
+#include "SpaceBallistics/PhysForces/GravityField.hpp"
+#include "SpaceBallistics/FFT.hpp"
+#include "SpaceBallistics/ThreadPool.hpp"
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace SpaceBallistics
+{
+  //=========================================================================//
+  // "GravityMap" Class:                                                     //
+  //=========================================================================//
+  // The non-central part of the field (degrees 2 .. n) on the sphere of the
+  // radius "r", on a grid of "NLat" latitude rows by "NLon" longitude columns:
+  //   phi(i)    = Pi/2 - (i + 1/2) * Pi/NLat,  i = 0 .. NLat-1 (North to South;
+  //               the cell centres, so the poles are not included),
+  //   lambda(j) = 2*Pi * j/NLon,               j = 0 .. NLon-1.
+  // The quantities ("Fld"s) provided at each node are:
+  //   Pot:     the disturbing potential T (in m^2/sec^2, positive; the central
+  //            term K/r is excluded),
+  //   AccUp, AccNorth, AccEast: the local components of the disturbing accel-
+  //            eration grad(T) (in m/sec^2),
+  //   Anomaly: the gravity anomaly (spherical approximation, wrt the central
+  //            field):  -dT/dr - 2*T/r (in m/sec^2).
+  // The maps are synthesised (see "Synthesise") at the cost of O(n^2) per row
+  // and O(NLon * log(NLon)) per row for the FFTs, ie O(n^3) in total for the
+  // typical grids with NLat ~ n, rather than O(n^4) for the point-by-point
+  // evaluation:
+  //
+  class GravityMap
+  {
+  public:
+    enum class Fld: int
+    {
+      Pot      = 0,
+      AccUp    = 1,
+      AccNorth = 2,
+      AccEast  = 3,
+      Anomaly  = 4
+    };
+    constexpr static int NFlds = 5;
+
+  private:
+    //=======================================================================//
+    // Data Flds:                                                            //
+    //=======================================================================//
+    Body                m_body;
+    int                 m_n;
+    int                 m_NLat;
+    int                 m_NLon;
+    Len                 m_r;
+    GM                  m_K;
+    // The maps (in SI units): "NFlds" planes of NLat * NLon values, each one
+    // in the row-major order:
+    std::vector<double> m_data;
+
+    //=======================================================================//
+    // Non-Default Ctor (allocates the maps, the values are set later):      //
+    //=======================================================================//
+    GravityMap(Body a_body, int a_n, int a_NLat, int a_NLon, Len a_r, GM a_K)
+    : m_body(a_body),
+      m_n   (a_n),
+      m_NLat(a_NLat),
+      m_NLon(a_NLon),
+      m_r   (a_r),
+      m_K   (a_K),
+      m_data(size_t(NFlds) * size_t(a_NLat) * size_t(a_NLon), 0.0)
+    {}
+
+  public:
+    //=======================================================================//
+    // Accessors:                                                            //
+    //=======================================================================//
+    Body GetBody() const { return m_body; }
+    int  Degree()  const { return m_n;    }
+    int  NLat()    const { return m_NLat; }
+    int  NLon()    const { return m_NLon; }
+    Len  GetR()    const { return m_r;    }
+
+    Angle Phi   (int a_i) const
+    {
+      assert(0 <= a_i && a_i < m_NLat);
+      return Angle(Pi<double> * (0.5 - (double(a_i) + 0.5) / double(m_NLat)));
+    }
+
+    Angle Lambda(int a_j) const
+    {
+      assert(0 <= a_j && a_j < m_NLon);
+      return Angle(2.0 * Pi<double> * double(a_j) / double(m_NLon));
+    }
+
+    // The whole map of the given Fld (NLat rows of NLon values), in SI units:
+    double const* Map(Fld a_fld) const
+    {
+      return m_data.data() +
+             size_t(a_fld) * size_t(m_NLat) * size_t(m_NLon);
+    }
+
+    // A single value, in SI units:
+    double operator()(Fld a_fld, int a_i, int a_j) const
+    {
+      assert(0 <= a_i && a_i < m_NLat && 0 <= a_j && a_j < m_NLon);
+      return Map(a_fld)[size_t(a_i) * size_t(m_NLon) + size_t(a_j)];
+    }
+
+    //=======================================================================//
+    // "Save": Writes the Maps into a Flat Binary File:                      //
+    //=======================================================================//
+    // The 128-byte header (see "GravityMap.cpp") is followed by the "NFlds"
+    // maps as above, as doubles in the native byte order. The file is written
+    // atomically (via a temporary file); throws "std::runtime_error" on error:
+    //
+    void Save(std::string const& a_file) const;
+
+    //=======================================================================//
+    // "Synthesise":                                                         //
+    //=======================================================================//
+    // The Legendre part of the field is computed once per latitude row (see
+    // "GravityField::LatRowSums"); along the row, each Fld is a trig polynom-
+    // ial in "lambda", which is evaluated at all "NLon" nodes by the FFT  (2
+    // real Flds are packed into each complex transform). The coeffs of degree
+    // m >= NLon/2 are aliased onto the lower ones, which is exact for the node
+    // values, so "NLon" is not constrained by "n" (but should be > 2*n for the
+    // maps to resolve the field). The rows are computed in parallel using
+    // "a_pool"; "a_field" is shared by all threads (read-only):
+    //
+    template<Body BodyName>
+    static GravityMap Synthesise
+    (
+      GravityField<BodyName> const& a_field,
+      Len                           a_r,        // Must be >= Re
+      int                           a_NLat,
+      int                           a_NLon,
+      ThreadPool&                   a_pool,
+      int                           a_n = GravityField<BodyName>::FullDeg
+    )
+    {
+      if (UNLIKELY(a_r < a_field.GetRe() || a_NLat < 1 || a_NLon < 1))
+        throw std::invalid_argument("GravityMap::Synthesise: Invalid Params");
+
+      int const n = (a_n == GravityField<BodyName>::FullDeg)
+                    ? a_field.MaxDeg() : a_n;
+      if (UNLIKELY(n < 0 || n == 1 || n > a_field.MaxDeg()))
+        throw std::invalid_argument("GravityMap::Synthesise: Invalid Degree");
+
+      GravityMap res(BodyName, n, a_NLat, a_NLon, a_r, a_field.GetK());
+      FFT const  fft(a_NLon);
+
+      // Scale factors: K/r for the potential, K/r^2 for the accelerations:
+      double const KR  = (a_field.GetK() / a_r).Magnitude();
+      double const KR2 = KR / a_r.Magnitude();
+      double const ir  = 1.0 / a_r.Magnitude();
+
+      a_pool.ParallelFor
+      (
+        a_NLat,
+        [&](int a_i)
+        {
+          // Per-row work buffers:
+          std::vector<double>       ab(6 * size_t(n + 1));
+          std::vector<FFT::Complex> Z (static_cast<size_t>(a_NLon));
+          std::vector<FFT::Complex> z (static_cast<size_t>(a_NLon));
+          std::vector<FFT::Complex> ws(static_cast<size_t>(fft.ScratchSize()));
+
+          Angle  const phi = res.Phi(a_i);
+          double const iu  = 1.0 / Cos(double(phi));
+          a_field.LatRowSums(phi, a_r, n, ab.data());
+
+          // Pot + i * AccUp,  AccNorth + i * AccEast  (see "SHToF" for the
+          // local components):
+          for (int pass = 0; pass < 2; ++pass)
+          {
+            std::fill(Z.begin(), Z.end(), FFT::Complex(0.0, 0.0));
+            for (int m = 0; m <= n; ++m)
+            {
+              double const* abm = ab.data() + 6 * m;
+              if (pass == 0)
+              {
+                AddTerm(Z.data(), a_NLon, m, KR   * abm[4],  KR   * abm[5],
+                        false);
+                AddTerm(Z.data(), a_NLon, m, -KR2 * abm[2], -KR2 * abm[3],
+                        true);
+              }
+              else
+              {
+                double const s  = KR2 * iu;
+                double const sm = s   * double(m);
+                AddTerm(Z.data(), a_NLon, m, s  * abm[0],  s  * abm[1],
+                        false);
+                AddTerm(Z.data(), a_NLon, m, sm * abm[5], -sm * abm[4],
+                        true);
+              }
+            }
+            fft.Backward(Z.data(), z.data(), ws.data());
+
+            double* re = res.Row(pass == 0 ? Fld::Pot   : Fld::AccNorth, a_i);
+            double* im = res.Row(pass == 0 ? Fld::AccUp : Fld::AccEast,  a_i);
+            for (size_t j = 0; j < size_t(a_NLon); ++j)
+            {
+              re[j] = z[j].real();
+              im[j] = z[j].imag();
+            }
+          }
+          // The Anomaly:
+          double const* T  = res.Row(Fld::Pot,     a_i);
+          double const* gU = res.Row(Fld::AccUp,   a_i);
+          double*       dg = res.Row(Fld::Anomaly, a_i);
+          for (size_t j = 0; j < size_t(a_NLon); ++j)
+            dg[j] = - gU[j] - 2.0 * T[j] * ir;
+        }
+      );
+      return res;
+    }
+
+  private:
+    //=======================================================================//
+    // Internal Utils:                                                       //
+    //=======================================================================//
+    double* Row(Fld a_fld, int a_i)
+    {
+      return m_data.data() +
+             (size_t(a_fld) * size_t(m_NLat) + size_t(a_i)) * size_t(m_NLon);
+    }
+
+    //-----------------------------------------------------------------------//
+    // "AddTerm":                                                            //
+    //-----------------------------------------------------------------------//
+    // Adds the term A * Cos(m*lambda) + B * Sin(m*lambda) of a real function
+    // to the spectrum "a_Z" of size "a_N" (so that the "FFT::Backward" of the
+    // latter gives the function values at the nodes); if "a_imag" is set, the
+    // function goes into the imaginary part of the result. Since
+    //   A * Cos(m*lambda) + B * Sin(m*lambda) =
+    //   c * exp(i*m*lambda) + conj(c) * exp(-i*m*lambda),  c = (A - i*B)/2,
+    // and exp(i*m*lambda(j)) only depends on (m mod N), the terms of m >= N
+    // (or m >= N/2) are exactly aliased onto the lower ones:
+    //
+    static void AddTerm
+      (FFT::Complex* a_Z, int a_N, int a_m, double a_A, double a_B,
+       bool a_imag)
+    {
+      if (a_m == 0)
+      {
+        a_Z[0] += a_imag ? FFT::Complex(0.0, a_A) : FFT::Complex(a_A, 0.0);
+        return;
+      }
+      FFT::Complex c (0.5 * a_A, -0.5 * a_B);
+      FFT::Complex cc(std::conj(c));
+      if (a_imag)
+      {
+        c  *= FFT::Complex(0.0, 1.0);
+        cc *= FFT::Complex(0.0, 1.0);
+      }
+      int const k = a_m % a_N;
+      a_Z[k]               += c;
+      a_Z[(a_N - k) % a_N] += cc;
+    }
+  };
+}
+// End namespace SpaceBallistics
@@ -0,0 +1,171 @@
+// vim:ts=2:et
+//===========================================================================//
+//                "SpaceBallistics/PhysForces/GravityModel.h":               //
+//         Run-Time Gravity Field Models (ICGEM Files, Binary Cache)         //
+//===========================================================================//
+#pragma once
+#include "SpaceBallistics/Types.hpp"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace SpaceBallistics
+{
+  //=========================================================================//
+  // "PackedSHCoeffs":                                                       //
+  //=========================================================================//
+  // Dimension-Less Spherical Harmonics Coeffs representing the Gravitational
+  // Potential, with Geodesy-style normalisation (to 4*Pi). The (l,m) indices
+  // are implied by the position in the coeffs array (see "GravityModel::
+  // CoeffIdx"), so only the coeffs themselves are stored,  16-byte-aligned,
+  // to be loaded by a single SIMD instruction. (The compiled-in models are
+  // stored in the source format with explicit (l,m), and packed into this
+  // layout on first use, see "GravityModel::Pack"):
+  //
+  struct alignas(16) PackedSHCoeffs
+  {
+    // Data Flds:
+    double const m_Clm;    // Coeff at Cos
+    double const m_Slm;    // Coeff at Sin
+  };
+  static_assert(sizeof(PackedSHCoeffs) == 2 * sizeof(double));
+
+  //=========================================================================//
+  // "GravityModel" Class:                                                   //
+  //=========================================================================//
+  // A Spherical Harmonics model loaded at run time from a standard ICGEM
+  // ".gfc" file. The parsed model is stored in a (checksummed)  binary cache
+  // file; subsequent loads "mmap" the cache, so they require no parsing, and
+  // all processes using the same model share one copy of it in the OS page
+  // cache.
+  // The model can be used for any Body (the ".gfc" files do not identify the
+  // Body), via the corresp "GravityField" Ctor. The model object must outlive
+  // all "GravityField"s constructed from it:
+  //
+  class GravityModel
+  {
+  public:
+    //=======================================================================//
+    // Layout of the Coeffs:                                                 //
+    //=======================================================================//
+    // The coeffs are stored by order "m" ("column-major"): for each m = 0..N,
+    // the entries for l = m..N are contiguous. This is the order in which the
+    // column recursions of the Legendre functions consume them, so the coeffs
+    // are streamed sequentially.  The entries for l < 2 (ie (0,0), (1,0) and
+    // (1,1)) are present but unused (zeroed-out), so that the columns are not
+    // ragged:
+    //
+    constexpr static int ColIdx(int a_m, int a_N)
+      { return (a_m * (2*a_N + 3 - a_m)) / 2; }
+
+    constexpr static int CoeffIdx(int a_l, int a_m, int a_N)
+    {
+      assert(0 <= a_m && a_m <= a_l && a_l <= a_N);
+      return ColIdx(a_m, a_N) + (a_l - a_m);
+    }
+
+    constexpr static int NCoeffs(int a_N)
+      { return (a_N == 0) ? 0 : ((a_N+1) * (a_N+2)) / 2; }
+
+    //-----------------------------------------------------------------------//
+    // "Pack": (l,m)-Tagged Coeffs into the above Layout:                    //
+    //-----------------------------------------------------------------------//
+    // "a_recs" are "a_n" structs with the "m_l", "m_m", "m_Clm" and "m_Slm"
+    // flds (eg the compiled-in "GravityField::s_coeffs", in the format of the
+    // generated "GravityPotential-*.cpp" files), in any order,  with l <= a_N.
+    // The entries for l < 2, and any missing ones, are zeroed-out:
+    //
+    template<typename Rec>
+    static std::vector<PackedSHCoeffs> Pack
+      (Rec const* a_recs, size_t a_n, int a_N)
+    {
+      std::vector<double> cs(2 * size_t(NCoeffs(a_N)), 0.0);
+      for (size_t j = 0; j < a_n; ++j)
+      {
+        Rec const& rec = a_recs[j];
+        if (UNLIKELY(rec.m_m < 0 || rec.m_m > rec.m_l || rec.m_l > a_N))
+          throw std::invalid_argument
+                ("GravityModel::Pack: Invalid degree or order");
+        if (rec.m_l < 2)
+          continue;
+        size_t i  = size_t(CoeffIdx(rec.m_l, rec.m_m, a_N));
+        cs[2*i]   = rec.m_Clm;
+        cs[2*i+1] = rec.m_Slm;
+      }
+      std::vector<PackedSHCoeffs> res;
+      res.reserve(cs.size() / 2);
+      for (size_t i = 0; i < cs.size(); i += 2)
+        res.push_back(PackedSHCoeffs{ cs[i], cs[i+1] });
+      return res;
+    }
+
+  private:
+    //=======================================================================//
+    // Data Flds:                                                            //
+    //=======================================================================//
+    std::string                 m_name;     // "modelname" from the file
+    int                         m_N;        // Max Degree and Order
+    Len                         m_Re;       // Reference Radius
+    GM                          m_K;        // Gravitational Constant
+    PackedSHCoeffs const*       m_coeffs;   // Ptr into one of the below:
+    void*                       m_map;      // The "mmap"ed cache, or
+    size_t                      m_mapLen;   //
+    bool                        m_cached;   // Loaded from a valid cache?
+    std::vector<PackedSHCoeffs> m_own;      // The coeffs held in memory
+
+  public:
+    //=======================================================================//
+    // Ctors, Dtor:                                                          //
+    //=======================================================================//
+    // Loads the model from the ICGEM file "a_gfc_file", via the binary cache
+    // "a_cache_file" (by default, "a_gfc_file" with the ".sbgc" suffix added).
+    // The cache is used if it is valid (correct format, checksum, and the size
+    // and modification time of the source file); otherwise, it is (re-)created
+    // from the source file. If the cache cannot be written (eg the directory
+    // is read-only), the parsed model is held in memory instead. The source
+    // file may be absent if the cache is valid.
+    // Throws "std::runtime_error" on I/O or format errors:
+    //
+    explicit GravityModel
+    (
+      std::string const& a_gfc_file,
+      std::string const& a_cache_file = ""
+    );
+
+    // Move-only:
+    GravityModel(GravityModel const&)            = delete;
+    GravityModel& operator=(GravityModel const&) = delete;
+    GravityModel(GravityModel&&     a_right)     noexcept;
+    GravityModel& operator=(GravityModel&&)      = delete;
+    ~GravityModel();
+
+    //=======================================================================//
+    // Accessors:                                                            //
+    //=======================================================================//
+    std::string const&    Name()   const { return m_name;   }
+    int                   N()      const { return m_N;      }
+    Len                   Re()     const { return m_Re;     }
+    GM                    K()      const { return m_K;      }
+    bool                  IsMapped() const { return m_map != nullptr; }
+    PackedSHCoeffs const* Coeffs() const { return m_coeffs; }
+
+    // "true" iff the model was loaded from a pre-existing valid cache  (rather
+    // than parsed from the source file):
+    bool FromCache() const { return m_cached; }
+
+    PackedSHCoeffs const& Coeffs(int a_l, int a_m) const
+      { return m_coeffs[CoeffIdx(a_l, a_m, m_N)]; }
+
+  private:
+    // Internal Utils:
+    bool MapCache  (std::string const& a_cache_file,  bool a_check_src,
+                    uint64_t a_src_size, int64_t a_src_mtime);
+    void ParseGFC  (std::string const& a_gfc_file);
+    bool WriteCache(std::string const& a_cache_file,
+                    uint64_t a_src_size, int64_t a_src_mtime) const;
+  };
+}
+// End namespace SpaceBallistics
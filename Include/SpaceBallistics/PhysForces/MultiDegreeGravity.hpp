@@ -0,0 +1,105 @@
+// vim:ts=2:et
+//===========================================================================//
+//            "SpaceBallistics/PhysForces/MultiDegreeGravity.hpp":           //
+//     Gravitational Accelerations for Several Degrees, for the ODE RHS      //
+//===========================================================================//
+#pragma once
+#include "SpaceBallistics/PhysForces/GravityField.hpp"
+#include <cassert>
+#include <stdexcept>
+
+namespace SpaceBallistics
+{
+  //=========================================================================//
+  // "MultiDegreeGravity" Class:                                             //
+  //=========================================================================//
+  // For the studies of convergence of trajectories wrt the degree of the
+  // field: "NDegs" trajectories, one per degree n(0) < ... < n(NDegs-1), are
+  // propagated together (as one ODE system), starting from the same state.
+  // The field of each degree is evaluated at the actual position of the corr-
+  // esp trajectory, so every trajectory is exact (up to rounding errors, the
+  // same as if it were propagated on its own). The positions are processed
+  // as SIMD lanes of one pass over the coeffs ("GravityField::MultiAt"), so
+  // the cost is about that of one or two trajectories of the max degree
+  // (rather than of all of them).
+  // The object holds no state of the trajectories, but it uses the evaluator
+  // "a_field", so the same restrictions apply:
+  //
+  template<Body BodyName>
+  class MultiDegreeGravity
+  {
+  public:
+    constexpr static int MaxDegs = GravityField<BodyName>::MaxSnaps;
+
+  private:
+    //=======================================================================//
+    // Data Flds:                                                            //
+    //=======================================================================//
+    // The underlying evaluator (not owned) and the degrees (ascending):
+    GravityField<BodyName>* m_field;
+    int                     m_nd;
+    int                     m_degs[MaxDegs];
+
+  public:
+    //=======================================================================//
+    // Non-Default Ctor:                                                     //
+    //=======================================================================//
+    // "a_field" (by default, the evaluator of the calling thread) must outlive
+    // this obj. The "a_nd" degrees "a_degs" must be 0 or 2 .. N (or "FullDeg")
+    // in the strictly ascending order:
+    //
+    MultiDegreeGravity
+    (
+      int                     a_nd,
+      int const               a_degs[],
+      GravityField<BodyName>& a_field = GravityField<BodyName>::ThisThread()
+    )
+    : m_field(&a_field),
+      m_nd   (a_nd),
+      m_degs ()
+    {
+      if (UNLIKELY(a_nd <= 0 || a_nd > MaxDegs || a_degs == nullptr))
+        throw std::invalid_argument("MultiDegreeGravity: Invalid Degrees");
+
+      for (int j = 0; j < a_nd; ++j)
+      {
+        int const n = (a_degs[j] == GravityField<BodyName>::FullDeg)
+                      ? a_field.MaxDeg() : a_degs[j];
+        if (UNLIKELY(n < 0 || n == 1 || n > a_field.MaxDeg() ||
+                    (j > 0  && n <= m_degs[j-1])))
+          throw std::invalid_argument("MultiDegreeGravity: Invalid Degrees");
+        m_degs[j] = n;
+      }
+    }
+
+    //=======================================================================//
+    // "GravAccs":                                                           //
+    //=======================================================================//
+    // "a_pos[j]" is the position of the trajectory "j" (of the degree "Deg-
+    // ree(j)");  the accelerations are ADDED to "a_accs[j]" resp. "ImpactExn"
+    // is thrown if any of the positions is an impact one:
+    //
+    void GravAccs
+    (
+      Time                    a_t,                   // For info only
+      PosVRot<BodyName> const a_pos [],              // Of size NDegs()
+      AccVRot<BodyName>       a_accs[]               // Ditto
+    )
+    {
+      assert(a_pos != nullptr && a_accs != nullptr);
+      m_field->MultiAt(a_t, m_nd, m_degs, a_pos, a_accs);
+    }
+
+    //=======================================================================//
+    // Accessors:                                                            //
+    //=======================================================================//
+    int NDegs() const { return m_nd; }
+
+    int Degree(int a_j) const
+    {
+      assert(0 <= a_j && a_j < m_nd);
+      return m_degs[a_j];
+    }
+  };
+}
+// End namespace SpaceBallistics
@@ -0,0 +1,172 @@
+// vim:ts=2:et
+//===========================================================================//
+//             "SpaceBallistics/PhysForces/MultiRateGravity.hpp":            //
+//       Multi-Rate Gravitational Field Evaluation for the ODE RHS           //
+//===========================================================================//
+#pragma once
+#include "SpaceBallistics/PhysForces/GravityField.hpp"
+#include <cassert>
+#include <stdexcept>
+
+namespace SpaceBallistics
+{
+  //=========================================================================//
+  // "MultiRateGravity" Class:                                               //
+  //=========================================================================//
+  // Along a smooth trajectory, the high-degree part of the field varies much
+  // more slowly than the RHS is evaluated by the ODE integrator. So the field
+  // is split into the low-degree part (degrees 2 .. "nLow"), which is evalua-
+  // ted at every call, and the high-degree residual (degrees nLow+1 .. "nHigh")
+  // which is only evaluated ("refreshed") every "maxCalls" calls, or when the
+  // position has moved by more than "maxDist" since the last refresh, which-
+  // ever comes first. In between, the residual is extrapolated to the 1st or-
+  // der in the position, using its Gravity-Gradient Tensor:
+  //   res(pos) = res(pos0) + Grad(res)(pos0) * (pos - pos0),
+  // so the error is O(|pos - pos0|^2), and the result does not depend on the
+  // times at which the RHS is called (eg the intermediate stages of RK methods
+  // which are not monotonic in time).
+  // NB: With the "maxCalls" criterion,  the RHS depends on the history of the
+  // calls, and has small jumps at refreshes; for integrators with a step size
+  // control, the "maxDist" criterion alone is preferable, as the extrapolation
+  // error is then bounded uniformly. Also, "maxCalls" counts the RHS calls,
+  // not the integrator steps (which this object does not see): for a refresh
+  // every "k" steps of DOP853 (12 RHS calls per step with FSAL), use maxCalls
+  // = 12*k (rejected steps make the refreshes somewhat more frequent).
+  // The object holds the state of one trajectory, so it must NOT be shared
+  // between threads or trajectories; "Reset" must be invoked before it is re-
+  // used for another trajectory:
+  //
+  template<Body BodyName>
+  class MultiRateGravity
+  {
+  private:
+    //=======================================================================//
+    // Data Flds:                                                            //
+    //=======================================================================//
+    // The underlying evaluator (not owned) and the params:
+    GravityField<BodyName>* m_field;
+    int                     m_nLow;
+    int                     m_nHigh;
+    int                     m_maxCalls;  // 0: No limit
+    Len2                    m_maxDist2;  // 0: No limit
+
+    // The residual and its gradient at "m_pos0":
+    bool                    m_valid;
+    int                     m_calls;     // Since the last refresh
+    long                    m_refreshes; // Total
+    PosVRot<BodyName>       m_pos0;
+    AccVRot<BodyName>       m_res;
+    GravGradTRot<BodyName>  m_resGrad;
+
+  public:
+    //=======================================================================//
+    // Non-Default Ctor:                                                     //
+    //=======================================================================//
+    // "a_field" (by default, the evaluator of the calling thread) must outlive
+    // this obj. At least one of "a_max_calls", "a_max_dist" must be positive:
+    //
+    MultiRateGravity
+    (
+      int                     a_n_low     = 20,
+      int                     a_n_high    = GravityField<BodyName>::FullDeg,
+      int                     a_max_calls = 0,
+      Len                     a_max_dist  = To_Len(10.0_km),
+      GravityField<BodyName>& a_field     =
+                                GravityField<BodyName>::ThisThread()
+    )
+    : m_field    (&a_field),
+      m_nLow     (a_n_low),
+      m_nHigh    ((a_n_high == GravityField<BodyName>::FullDeg)
+                  ? a_field.MaxDeg() : a_n_high),
+      m_maxCalls (a_max_calls),
+      m_maxDist2 (Sqr(a_max_dist)),
+      m_valid    (false),
+      m_calls    (0),
+      m_refreshes(0),
+      m_pos0     (),
+      m_res      (),
+      m_resGrad  ()
+    {
+      if (UNLIKELY(m_nLow < 0 || m_nLow == 1 || m_nHigh < m_nLow ||
+                   m_nHigh > a_field.MaxDeg()))
+        throw std::invalid_argument("MultiRateGravity: Invalid Degree(s)");
+
+      if (UNLIKELY(a_max_calls < 0 || IsNeg(a_max_dist) ||
+                  (a_max_calls == 0 && IsZero(a_max_dist))))
+        throw std::invalid_argument
+              ("MultiRateGravity: Invalid Refresh Criteria");
+    }
+
+    //=======================================================================//
+    // "GravAcc":                                                            //
+    //=======================================================================//
+    // Same semantics as "GravityField::GravAcc": the acceleration is ADDED to
+    // "a_acc". "ImpactExn" is propagated from the underlying evaluator:
+    //
+    void GravAcc
+    (
+      Time                     a_t,                  // For info only
+      PosVRot<BodyName> const& a_pos,
+      AccVRot<BodyName>*       a_acc
+    )
+    {
+      assert(a_acc != nullptr);
+
+      // The low-degree part:
+      m_field->Pines(a_t, a_pos, a_acc, m_nLow);
+
+      // The high-degree residual:
+      if (m_nHigh == m_nLow)
+        return;
+
+      Len  const dp[3] { a_pos[0] - m_pos0[0], a_pos[1] - m_pos0[1],
+                         a_pos[2] - m_pos0[2] };
+      Len2 const d2 = Sqr(dp[0]) + Sqr(dp[1]) + Sqr(dp[2]);
+
+      if (!m_valid                                      ||
+          (m_maxCalls > 0      && m_calls >= m_maxCalls) ||
+          (IsPos(m_maxDist2)   && d2 > m_maxDist2))
+      {
+        Refresh(a_t, a_pos);
+        for (size_t i = 0; i < 3; ++i)
+          (*a_acc)[i] += m_res[i];
+      }
+      else
+        for (size_t i = 0; i < 3; ++i)
+          (*a_acc)[i] +=
+            m_res[i] + m_resGrad[i][0] * dp[0] + m_resGrad[i][1] * dp[1] +
+                       m_resGrad[i][2] * dp[2];
+      ++m_calls;
+    }
+
+    //=======================================================================//
+    // Other Methods:                                                        //
+    //=======================================================================//
+    // Forces the refresh at the next call (eg for a new trajectory, or after
+    // an impulsive manoeuvre):
+    void Reset() { m_valid = false; }
+
+    int  NLow()       const { return m_nLow;      }
+    int  NHigh()      const { return m_nHigh;     }
+    long NRefreshes() const { return m_refreshes; }
+
+  private:
+    //=======================================================================//
+    // "Refresh": Re-Computes the Residual and its Gradient at "a_pos":      //
+    //=======================================================================//
+    // In one pass over the coeffs (see "GravityField::ResAccGrad"), so the cost
+    // of a refresh is that of one "GravAccGrad" call of degree "nHigh":
+    //
+    void Refresh(Time a_t, PosVRot<BodyName> const& a_pos)
+    {
+      m_res.fill(Acc(0.0));
+      m_resGrad = GravGradTRot<BodyName>{};
+      m_field->ResAccGrad(a_t, a_pos, &m_res, &m_resGrad, m_nLow, m_nHigh);
+      m_pos0  = a_pos;
+      m_valid = true;
+      m_calls = 0;
+      ++m_refreshes;
+    }
+  };
+}
+// End namespace SpaceBallistics
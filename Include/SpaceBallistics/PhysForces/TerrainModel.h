@@ -0,0 +1,284 @@
+// vim:ts=2:et
+//===========================================================================//
+//                "SpaceBallistics/PhysForces/TerrainModel.h":               //
+//     Digital Elevation Models from "mmap"ed Tiles, Terrain-Aware Impacts   //
+//===========================================================================//
+#pragma once
+#include "SpaceBallistics/Types.hpp"
+#include "SpaceBallistics/CoOrds/Bodies.h"
+#include "SpaceBallistics/CoOrds/BodyCentricCOSes.h"
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SpaceBallistics
+{
+  //=========================================================================//
+  // "TerrainModel" Class:                                                   //
+  //=========================================================================//
+  // A global Digital Elevation Model (DEM) of a Body, stored in a directory
+  // of tile files (see "TileFile" and "SaveTile"). The tiles form a regular
+  // grid of "NTileRows" x "NTileCols" in (phi, lambda):  the tile (i, j) cov-
+  // ers the latitudes Pi/2 - [i, i+1] * Pi/NTileRows and the longitudes
+  // [j, j+1] * 2*Pi/NTileCols; the samples in each tile are node-registered
+  // (the boundary nodes are shared by the adjacent tiles), so the bilinear
+  // interpolation never needs more than one tile.  Tiles may be missing (eg
+  // for regional DEMs); then the "no-data" elevation is used there.
+  // The tiles are "mmap"ed on demand, and at most "a_cache_size" of them are
+  // kept mapped (the Least-Recently-Used ones are unmapped first); the pages
+  // of the mapped tiles are shared by all processes via the OS page cache.
+  // The elevations are over the reference sphere of the radius "R" (the same
+  // for all tiles, eg 1737.4 km for the LOLA products), which is NOT in gen-
+  // eral the equatorial radius of the gravity model.
+  // The look-ups are exception-free (so they can be polled by the integrator
+  // at every step), but they update the cache, so an obj must NOT be shared
+  // between threads (use one per thread; the tiles are still shared):
+  //
+  class TerrainModel
+  {
+  public:
+    //=======================================================================//
+    // Tile File Format:                                                     //
+    //=======================================================================//
+    // The 128-byte header is followed by NLat rows (North to South) of NLon
+    // "int16_t" samples (West to East), in the native byte order; the eleva-
+    // tion (in m) is  m_offset + m_scale * sample.  The node (0, 0) is at the
+    // NW corner of the tile:
+    //
+    struct TileHeader
+    {
+      char     m_magic[8];
+      uint32_t m_version;
+      int32_t  m_body;
+      int32_t  m_NLat;         // Nodes, >= 2
+      int32_t  m_NLon;         // Nodes, >= 2
+      double   m_phiN;         // Rad
+      double   m_lambdaW;      // Rad
+      double   m_dPhi;         // Node spacing, rad
+      double   m_dLambda;      // Node spacing, rad
+      double   m_R;            // Reference radius, m
+      double   m_scale;        // m
+      double   m_offset;       // m
+      double   m_hMin;         // Min elevation in the tile, m
+      double   m_hMax;         // Max elevation in the tile, m
+      char     m_reserved[32];
+    };
+    static_assert(sizeof(TileHeader) == 128);
+
+  private:
+    //=======================================================================//
+    // Data Flds:                                                            //
+    //=======================================================================//
+    // A mapped tile:
+    struct Slot
+    {
+      int            m_tile;   // Tile index (-1 if the slot is free)
+      uint64_t       m_used;   // "Time" of the last use (for the LRU)
+      void*          m_map;
+      size_t         m_mapLen;
+      int16_t const* m_data;
+      int            m_NLat;
+      int            m_NLon;
+      double         m_phiN;
+      double         m_lambdaW;
+      double         m_idPhi;  // 1 / node spacing
+      double         m_idLambda;
+      double         m_scale;
+      double         m_offset;
+    };
+
+    std::string       m_dir;
+    Body              m_body;
+    int               m_NTileRows;
+    int               m_NTileCols;
+    double            m_idTilePhi;     // 1 / tile size in "phi"
+    double            m_idTileLambda;  // 1 / tile size in "lambda"
+    Len               m_R;             // Reference radius
+    Len               m_hNoData;       // Elevation used where there are no
+                                       //   tiles, or they cannot be mapped
+    Len               m_hMin;          // Global min elevation (incl no-data)
+    Len               m_hMax;          // Global max elevation (incl no-data)
+    std::vector<bool> m_present;       // Tiles which exist (by tile index)
+    std::vector<int>  m_slotOf;        // Tile index -> Slot (-1 if unmapped)
+    std::vector<Slot> m_slots;         // The cache
+    int               m_last;          // Slot of the last look-up (or -1)
+    uint64_t          m_clock;         // For the LRU
+    long              m_nMaps;         // Total tile mappings (statistics)
+    long              m_nFailed;       // Failed mappings (no-data used)
+
+  public:
+    //=======================================================================//
+    // Non-Default Ctor, Dtor:                                               //
+    //=======================================================================//
+    // Scans the tile headers in "a_dir" (but does not map the tiles yet), and
+    // throws "std::runtime_error" if any of them is invalid,  or is not for
+    // the given Body and tile grid, or if the reference radii differ; throws
+    // "std::invalid_argument" for invalid params:
+    //
+    TerrainModel
+    (
+      std::string const& a_dir,
+      Body               a_body,
+      int                a_n_tile_rows,
+      int                a_n_tile_cols,
+      int                a_cache_size = 16,
+      Len                a_h_no_data  = Len(0.0)
+    );
+
+    // Move-only:
+    TerrainModel(TerrainModel const&)            = delete;
+    TerrainModel& operator=(TerrainModel const&) = delete;
+    TerrainModel(TerrainModel&&)                 noexcept;
+    TerrainModel& operator=(TerrainModel&&)      = delete;
+    ~TerrainModel();
+
+    //=======================================================================//
+    // Accessors:                                                            //
+    //=======================================================================//
+    Body GetBody()   const { return m_body;    }
+    Len  GetR()      const { return m_R;       }
+    Len  MinElev()   const { return m_hMin;    }
+    Len  MaxElev()   const { return m_hMax;    }
+
+    // The radius of the lowest terrain (eg for "GravityField::SetImpactRadius",
+    // so that "ImpactExn" is not thrown above the terrain):
+    Len  MinRadius() const { return m_R + m_hMin; }
+    long NMaps()     const { return m_nMaps;   }
+    long NFailed()   const { return m_nFailed; }
+
+    //=======================================================================//
+    // "Elevation": Bilinear Interpolation of the DEM:                       //
+    //=======================================================================//
+    // Over the reference sphere; "a_phi" in [-Pi/2, Pi/2], "a_lambda" is
+    // arbitrary (reduced modulo 2*Pi):
+    //
+    Len Elevation(Angle a_phi, Angle a_lambda) noexcept;
+
+    //=======================================================================//
+    // Terrain-Aware Impact Status:                                          //
+    //=======================================================================//
+    // "Altitude": The radial height of "a_pos" over the terrain (negative if
+    // below it). "IsImpact":  Whether "a_pos" is at or below the terrain;  it
+    // is cheap above the highest terrain (no look-up is done then),  so it can
+    // be polled by the integrator after every step, instead of relying on the
+    // "ImpactExn" thrown by "GravityField" (which only detects r <= its impact
+    // radius, see "GravityField::SetImpactRadius" and "MinRadius"). The
+    // impact site may be returned via "a_lambda" and "a_phi".
+    // NB: "a_pos" is a "PosVRot" of "GetBody()" (all "PosV"s are "std::array"s,
+    // so the Body cannot be checked at compile time):
+    //
+    Len Altitude
+    (
+      std::array<Len, 3> const& a_pos,
+      Angle*                    a_lambda = nullptr,
+      Angle*                    a_phi    = nullptr
+    )
+    noexcept
+    {
+      Len    const x   = a_pos[0];
+      Len    const y   = a_pos[1];
+      Len    const z   = a_pos[2];
+      Len    const rxy = SqRt(Sqr(x) + Sqr(y));
+      Len    const r   = SqRt(Sqr(rxy) + Sqr(z));
+      Angle  const phi(std::atan2(z.Magnitude(), rxy.Magnitude()));
+      Angle  const lambda(std::atan2(y.Magnitude(), x.Magnitude()));
+      if (a_lambda != nullptr)
+        *a_lambda = lambda;
+      if (a_phi    != nullptr)
+        *a_phi    = phi;
+      return r - m_R - Elevation(phi, lambda);
+    }
+
+    bool IsImpact
+    (
+      std::array<Len, 3> const& a_pos,
+      Angle*                    a_lambda = nullptr,
+      Angle*                    a_phi    = nullptr
+    )
+    noexcept
+    {
+      Len2 const r2 = Sqr(a_pos[0]) + Sqr(a_pos[1]) + Sqr(a_pos[2]);
+      if (LIKELY(r2 > Sqr(m_R + m_hMax)))
+        return false;
+      return !IsPos(Altitude(a_pos, a_lambda, a_phi));
+    }
+
+    //=======================================================================//
+    // Tile Files:                                                           //
+    //=======================================================================//
+    // The name of the tile (i, j) in "a_dir":
+    static std::string TileFile(std::string const& a_dir, int a_i, int a_j);
+
+    // Writes the tile (i, j) of the given tile grid (the node spacing is de-
+    // rived from "a_NLat" and "a_NLon"), with the elevations "a_h" (in m, NLat
+    // rows of NLon values, North to South and West to East), quantised with
+    // the step "a_scale" (in m). The file is written atomically (via a tempo-
+    // rary file); throws "std::runtime_error" on error, or "std::invalid_arg-
+    // ument" if the elevations cannot be represented with "a_scale":
+    //
+    static void SaveTile
+    (
+      std::string const& a_dir,
+      Body               a_body,
+      int                a_n_tile_rows,
+      int                a_n_tile_cols,
+      int                a_i,
+      int                a_j,
+      Len                a_R,
+      int                a_NLat,
+      int                a_NLon,
+      double const*      a_h,
+      double             a_scale = 0.5
+    );
+
+  private:
+    //=======================================================================//
+    // Internal Utils:                                                       //
+    //=======================================================================//
+    // Returns the slot of the mapped tile (mapping it if necessary), or -1 if
+    // the tile is missing or cannot be mapped:
+    int  GetSlot(int a_tile) noexcept;
+    void Unmap  (Slot* a_slot) noexcept;
+  };
+
+  //-------------------------------------------------------------------------//
+  // "TerrainEvent": Altitude over the Terrain (in m):                       //
+  //-------------------------------------------------------------------------//
+  // An event function for "PropagateToEvent" etc (see "ODE/Events.hpp"):
+  // "Falling" is an impact on the terrain given by a "TerrainModel" (see its
+  // "Altitude"). If "m_rotP" is 0, "COS" must be the BodyCentricRotatingCOS
+  // of the Body of the terrain; otherwise, "COS" is the BodyCentricFixedCOS,
+  // and "m_rotP" is the sidereal rotation period of the Body (the Rotating COS
+  // is assumed to coincide with the Fixed one at t=0, as in "LunarOrbiter-
+  // Test"). The "TerrainModel" (not owned) is updated by the look-ups, so the
+  // functor must NOT be shared between threads (eg by "Ensemble"):
+  //
+  template<typename COS>
+  struct TerrainEvent
+  {
+    TerrainModel* m_terrain;
+    Time          m_rotP = Time(0.0);
+
+    double operator()(Time a_t, PosV<COS> const& a_r, VelV<COS> const&) const
+    {
+      assert(m_terrain != nullptr);
+      if (IsZero(m_rotP))
+        return m_terrain->Altitude(a_r).Magnitude();
+
+      double const ra    = TwoPi<double> * double(a_t / m_rotP);
+      double const cosRA = Cos(ra);
+      double const sinRA = Sin(ra);
+      std::array<Len, 3> const posR
+      {{
+        cosRA * a_r[0] + sinRA * a_r[1],
+        cosRA * a_r[1] - sinRA * a_r[0],
+        a_r[2]
+      }};
+      return m_terrain->Altitude(posR).Magnitude();
+    }
+  };
+}
+// End namespace SpaceBallistics
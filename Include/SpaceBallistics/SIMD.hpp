@@ -0,0 +1,250 @@
+// vim:ts=2:et
+//===========================================================================//
+//                        "SpaceBallistics/SIMD.hpp":                        //
+//          SIMD Vector Types for Lane-Parallel ("Batched") Kernels          //
+//===========================================================================//
+#pragma once
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+namespace SpaceBallistics
+{
+  //=========================================================================//
+  // AVX2 Vector Types:                                                      //
+  //=========================================================================//
+  // We use the GCC/CLang "vector_size" extension rather than intrinsics: the
+  // arithmetic on these types (incl mixed Vector-Scalar ops, where the scalar
+  // is broadcast) is compiled directly into AVX2 instructions,  as we always
+  // build with "-mavx2 -march=native":
+  //
+  using DoubleV4 = double __attribute__((vector_size(32)));
+
+  // For the mixed-precision kernels, 8 lanes of "float" (1 AVX2 register) are
+  // paired with 8 lanes of "double" (2 AVX2 registers, see below):
+  using FloatV8  = float  __attribute__((vector_size(32)));
+  using FloatV4  = float  __attribute__((vector_size(16)));
+
+  //-------------------------------------------------------------------------//
+  // "DoubleV8":                                                             //
+  //-------------------------------------------------------------------------//
+  // NB: This is a pair of "DoubleV4"s rather than a 64-byte "vector_size" type:
+  // without AVX-512, GCC lowers the arithmetic on the latter very poorly (3-4
+  // times slower per lane than "DoubleV4"), whereas the arithmetic operators
+  // below are simply inlined into 2 AVX2 instructions each:
+  //
+  struct DoubleV8
+  {
+    DoubleV4 m_lo;
+    DoubleV4 m_hi;
+  };
+
+# define SB_V8_OP(Op) \
+  inline DoubleV8  operator Op(DoubleV8 a_x, DoubleV8 a_y) \
+    { return DoubleV8{ a_x.m_lo Op a_y.m_lo, a_x.m_hi Op a_y.m_hi }; } \
+  inline DoubleV8  operator Op(double   a_x, DoubleV8 a_y) \
+    { return DoubleV8{ a_x      Op a_y.m_lo, a_x      Op a_y.m_hi }; } \
+  inline DoubleV8  operator Op(DoubleV8 a_x, double   a_y) \
+    { return DoubleV8{ a_x.m_lo Op a_y,      a_x.m_hi Op a_y      }; } \
+  inline DoubleV8& operator Op##=(DoubleV8& a_x, DoubleV8 a_y) \
+    { a_x = a_x Op a_y; return a_x; } \
+  inline DoubleV8& operator Op##=(DoubleV8& a_x, double   a_y) \
+    { a_x = a_x Op a_y; return a_x; }
+
+  SB_V8_OP(+)
+  SB_V8_OP(-)
+  SB_V8_OP(*)
+  SB_V8_OP(/)
+# undef  SB_V8_OP
+
+  inline DoubleV8 operator-(DoubleV8 a_x)
+    { return DoubleV8{ -a_x.m_lo, -a_x.m_hi }; }
+
+  //=========================================================================//
+  // "SIMDTraits":                                                           //
+  //=========================================================================//
+  // Allows the same "lane-generic" kernel to be instantiated for both scalars
+  // (1 lane) and vectors:
+  //
+  template<typename V>
+  struct SIMDTraits
+  {
+    using Elem = V;
+    constexpr static int Lanes = 1;
+  };
+
+  template<>
+  struct SIMDTraits<DoubleV4>
+  {
+    using Elem = double;
+    constexpr static int Lanes = 4;
+  };
+
+  template<>
+  struct SIMDTraits<FloatV8>
+  {
+    using Elem = float;
+    constexpr static int Lanes = 8;
+  };
+
+  template<>
+  struct SIMDTraits<DoubleV8>
+  {
+    using Elem = double;
+    constexpr static int Lanes = 8;
+  };
+
+  //-------------------------------------------------------------------------//
+  // "DoubleLanes": The "double" Vector Type with the given Number of Lanes: //
+  //-------------------------------------------------------------------------//
+  template<int NL>
+  struct DoubleLanesT;
+
+  template<>
+  struct DoubleLanesT<4> { using type = DoubleV4; };
+
+  template<>
+  struct DoubleLanesT<8> { using type = DoubleV8; };
+
+  template<int NL>
+  using DoubleLanes = typename DoubleLanesT<NL>::type;
+
+  //=========================================================================//
+  // Lane-Generic Utils:                                                     //
+  //=========================================================================//
+  //-------------------------------------------------------------------------//
+  // "Splat": Broadcast a scalar into all lanes:                             //
+  //-------------------------------------------------------------------------//
+  template<typename V>
+  constexpr V Splat(typename SIMDTraits<V>::Elem a_x)
+  {
+    if constexpr (SIMDTraits<V>::Lanes == 1)
+      return a_x;
+    else
+    if constexpr (std::is_same_v<V, DoubleV8>)
+      return DoubleV8{ DoubleV4{} + a_x, DoubleV4{} + a_x };
+    else
+      return V{} + a_x;
+  }
+
+  //-------------------------------------------------------------------------//
+  // "GetLane", "SetLane":                                                   //
+  //-------------------------------------------------------------------------//
+  template<typename V>
+  constexpr typename SIMDTraits<V>::Elem GetLane(V const& a_v, int a_k)
+  {
+    if constexpr (SIMDTraits<V>::Lanes == 1)
+    {
+      (void) a_k;
+      return a_v;
+    }
+    else
+    if constexpr (std::is_same_v<V, DoubleV8>)
+      return (a_k < 4) ? a_v.m_lo[a_k] : a_v.m_hi[a_k - 4];
+    else
+      return a_v[a_k];
+  }
+
+  template<typename V>
+  constexpr void SetLane(V* a_v, int a_k, typename SIMDTraits<V>::Elem a_x)
+  {
+    if constexpr (SIMDTraits<V>::Lanes == 1)
+    {
+      (void) a_k;
+      *a_v = a_x;
+    }
+    else
+    if constexpr (std::is_same_v<V, DoubleV8>)
+    {
+      if (a_k < 4)
+        a_v->m_lo[a_k]     = a_x;
+      else
+        a_v->m_hi[a_k - 4] = a_x;
+    }
+    else
+      (*a_v)[a_k] = a_x;
+  }
+
+  //-------------------------------------------------------------------------//
+  // "LoadV", "StoreV": Between Vectors and Arrays of Lanes:                 //
+  //-------------------------------------------------------------------------//
+  // "a_p" points to "Lanes" contiguous elements of the same size as those of
+  // the vector, eg "double"s or "DimQ"s (which have the layout of "double");
+  // no alignment is required.  The copying is compiled into (1 or 2) vector
+  // loads or stores:
+  //
+  template<typename V, typename T>
+  inline V LoadV(T const* a_p)
+  {
+    static_assert(std::is_trivially_copyable_v<T> &&
+                  sizeof(T) == sizeof(typename SIMDTraits<V>::Elem) &&
+                  sizeof(V) == size_t(SIMDTraits<V>::Lanes) * sizeof(T));
+    V res;
+    std::memcpy(&res, a_p, sizeof(V));
+    return res;
+  }
+
+  template<typename V, typename T>
+  inline void StoreV(T* a_p, V const& a_v)
+  {
+    static_assert(std::is_trivially_copyable_v<T> &&
+                  sizeof(T) == sizeof(typename SIMDTraits<V>::Elem) &&
+                  sizeof(V) == size_t(SIMDTraits<V>::Lanes) * sizeof(T));
+    std::memcpy(static_cast<void*>(a_p), &a_v, sizeof(V));
+  }
+
+  //-------------------------------------------------------------------------//
+  // "ConvertV": Lane-wise Conversion between "double" and "float" Types:    //
+  //-------------------------------------------------------------------------//
+  // The types must have the same number of lanes:
+  //
+  template<typename To, typename From>
+  constexpr To ConvertV(From a_v)
+  {
+    static_assert(SIMDTraits<To>::Lanes == SIMDTraits<From>::Lanes);
+    if constexpr (SIMDTraits<To>::Lanes == 1)
+      return static_cast<To>(a_v);
+    else
+    if constexpr (std::is_same_v<From, DoubleV8>)
+    {
+      static_assert(std::is_same_v<To, FloatV8>);
+      FloatV4 lo = __builtin_convertvector(a_v.m_lo, FloatV4);
+      FloatV4 hi = __builtin_convertvector(a_v.m_hi, FloatV4);
+      return __builtin_shufflevector(lo, hi, 0, 1, 2, 3, 4, 5, 6, 7);
+    }
+    else
+    if constexpr (std::is_same_v<To, DoubleV8>)
+    {
+      static_assert(std::is_same_v<From, FloatV8>);
+      FloatV4 lo = __builtin_shufflevector(a_v, a_v, 0, 1, 2, 3);
+      FloatV4 hi = __builtin_shufflevector(a_v, a_v, 4, 5, 6, 7);
+      return DoubleV8{ __builtin_convertvector(lo, DoubleV4),
+                       __builtin_convertvector(hi, DoubleV4) };
+    }
+    else
+      return __builtin_convertvector(a_v, To);
+  }
+
+  //-------------------------------------------------------------------------//
+  // "SqRtV": Lane-wise Square Root:                                         //
+  //-------------------------------------------------------------------------//
+  // (The loop is vectorised into a single "vsqrtpd" by the compiler):
+  //
+  template<typename V>
+  inline V SqRtV(V a_v)
+  {
+    if constexpr (SIMDTraits<V>::Lanes == 1)
+      return std::sqrt(a_v);
+    else
+    if constexpr (std::is_same_v<V, DoubleV8>)
+      return DoubleV8{ SqRtV(a_v.m_lo), SqRtV(a_v.m_hi) };
+    else
+    {
+      V res {};
+      for (int k = 0; k < SIMDTraits<V>::Lanes; ++k)
+        res[k] = std::sqrt(a_v[k]);
+      return res;
+    }
+  }
+}
+// End namespace SpaceBallistics
@@ -0,0 +1,313 @@
+// vim:ts=2:et
+//===========================================================================//
+//                      "SpaceBallistics/ThreadPool.hpp":                    //
+//              A Simple Fixed-Size Thread Pool for Data Parallelism         //
+//===========================================================================//
+#pragma once
+#include "SpaceBallistics/Utils.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace SpaceBallistics
+{
+  //=========================================================================//
+  // "ThreadPool" Class:                                                     //
+  //=========================================================================//
+  // The only operation is "ParallelFor(n, f)" which invokes f(i) for all i in
+  // [0, n) on the worker threads and the calling thread, and returns when all
+  // of them are done. The indices are scheduled by work stealing: each thread
+  // initially owns a contiguous range of them, and takes them one by one from
+  // its front; a thread which has run out of work steals the back half of the
+  // range of another one. So the load is balanced even if the costs of f(i)
+  // vary wildly, with no shared counter, and the indices processed by a thr-
+  // ead are mostly contiguous. Each "f(i)" is a fixed piece of work, so the
+  // results do not depend on the scheduling if the caller combines them  in
+  // the index order. Within "f(i)", "WorkerIndex()" identifies the executing
+  // thread (eg for per-thread workspaces or output buffers).
+  // Calls from different threads are serialised;  a (nested) call from with-
+  // in a job is executed serially by the calling thread:
+  //
+  class ThreadPool
+  {
+  private:
+    //=======================================================================//
+    // Data Flds:                                                            //
+    //=======================================================================//
+    std::vector<std::thread>        m_workers;
+    std::mutex                      m_callMx;   // Serialises "ParallelFor"s
+    std::mutex                      m_mx;       // Protects the flds below
+    std::condition_variable         m_startCV;
+    std::condition_variable         m_doneCV;
+    std::function<void(int)> const* m_job;
+    int                             m_n;
+    int                             m_active;   // Workers still in the job
+    unsigned long                   m_gen;      // Job Generation
+    bool                            m_stop;
+    std::exception_ptr              m_exn;      // First exception in a job
+
+    // The ranges of indices owned by the threads (incl the calling one, at
+    // 0), as [lo, hi) packed into "(lo << 32) | hi", each in its own cache
+    // line:
+    struct alignas(64) Range
+    {
+      std::atomic<uint64_t> m_lohi;
+    };
+    std::unique_ptr<Range[]>        m_ranges;
+
+    // Whether the current thread is running a job of some pool:
+    static bool& InJob()
+    {
+      thread_local bool inJob = false;
+      return inJob;
+    }
+
+    static int& WorkerIndexRef()
+    {
+      thread_local int index = 0;
+      return index;
+    }
+
+    constexpr static uint64_t Pack(uint32_t a_lo, uint32_t a_hi)
+      { return (uint64_t(a_lo) << 32) | uint64_t(a_hi); }
+
+    //=======================================================================//
+    // Work Stealing:                                                        //
+    //=======================================================================//
+    // "PopOwn": The next index from the front of the own range, or -1:
+    //
+    int PopOwn(int a_self)
+    {
+      std::atomic<uint64_t>& r   = m_ranges[a_self].m_lohi;
+      uint64_t               cur = r.load(std::memory_order_acquire);
+      while (true)
+      {
+        uint32_t const lo = uint32_t(cur >> 32);
+        uint32_t const hi = uint32_t(cur);
+        if (lo >= hi)
+          return -1;
+        if (r.compare_exchange_weak(cur, Pack(lo + 1, hi),
+                                    std::memory_order_acq_rel))
+          return int(lo);
+      }
+    }
+
+    // "Steal": Moves the back half of the range of "a_victim" (at least one
+    // index) into the (empty) own range; returns "false" if the victim's
+    // range is empty. The range is updated atomically as a whole,  so a
+    // stale view of it can only cause a failed CAS:
+    //
+    bool Steal(int a_victim, int a_self)
+    {
+      std::atomic<uint64_t>& r   = m_ranges[a_victim].m_lohi;
+      uint64_t               cur = r.load(std::memory_order_acquire);
+      while (true)
+      {
+        uint32_t const lo = uint32_t(cur >> 32);
+        uint32_t const hi = uint32_t(cur);
+        if (lo >= hi)
+          return false;
+        uint32_t const mid = lo + (hi - lo) / 2;
+        if (r.compare_exchange_weak(cur, Pack(lo, mid),
+                                    std::memory_order_acq_rel))
+        {
+          m_ranges[a_self].m_lohi.store(Pack(mid, hi),
+                                        std::memory_order_release);
+          return true;
+        }
+      }
+    }
+
+    //=======================================================================//
+    // "RunJob": Executed by all participating threads:                      //
+    //=======================================================================//
+    // Returns when there is no work left to take or steal (though other thr-
+    // eads may still be running their last indices):
+    //
+    void RunJob(int a_self)
+    {
+      bool& inJob = InJob();
+      inJob       = true;
+      WorkerIndexRef() = a_self;
+      int const nt     = NThreads();
+
+      while (true)
+      {
+        int i = PopOwn(a_self);
+        if (i < 0)
+        {
+          for (int k = 1; k < nt && i < 0; ++k)
+            if (Steal((a_self + k) % nt, a_self))
+              i = PopOwn(a_self);
+          if (i < 0)
+            break;
+        }
+        try
+        {
+          (*m_job)(i);
+        }
+        catch (...)
+        {
+          std::lock_guard<std::mutex> lock(m_mx);
+          if (m_exn == nullptr)
+            m_exn = std::current_exception();
+        }
+      }
+      inJob = false;
+    }
+
+    //=======================================================================//
+    // "WorkerLoop":                                                         //
+    //=======================================================================//
+    void WorkerLoop(int a_self)
+    {
+      unsigned long seen = 0;
+      while (true)
+      {
+        {
+          std::unique_lock<std::mutex> lock(m_mx);
+          m_startCV.wait(lock, [&]{ return m_stop || m_gen != seen; });
+          if (m_stop)
+            return;
+          seen = m_gen;
+        }
+        RunJob(a_self);
+        {
+          std::lock_guard<std::mutex> lock(m_mx);
+          if (--m_active == 0)
+            m_doneCV.notify_one();
+        }
+      }
+    }
+
+  public:
+    //=======================================================================//
+    // Ctor, Dtor:                                                           //
+    //=======================================================================//
+    // "a_n_threads" is the total number of threads, incl the calling one (so
+    // 1 means no parallelism); 0 means the number of hardware threads:
+    //
+    explicit ThreadPool(int a_n_threads = 0)
+    : m_workers(),
+      m_job    (nullptr),
+      m_n      (0),
+      m_active (0),
+      m_gen    (0),
+      m_stop   (false),
+      m_exn    (nullptr),
+      m_ranges ()
+    {
+      if (UNLIKELY(a_n_threads < 0))
+        throw std::invalid_argument("ThreadPool: Invalid number of threads");
+      if (a_n_threads == 0)
+        a_n_threads = std::max(1, int(std::thread::hardware_concurrency()));
+
+      m_ranges.reset(new Range[size_t(a_n_threads)]);
+      for (int i = 0; i < a_n_threads; ++i)
+        m_ranges[i].m_lohi.store(0);
+
+      m_workers.reserve(size_t(a_n_threads - 1));
+      for (int i = 1; i < a_n_threads; ++i)
+        m_workers.emplace_back([this, i]{ WorkerLoop(i); });
+    }
+
+    ~ThreadPool()
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mx);
+        m_stop = true;
+      }
+      m_startCV.notify_all();
+      for (std::thread& w: m_workers)
+        w.join();
+    }
+
+    ThreadPool(ThreadPool const&)            = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    //=======================================================================//
+    // Accessors:                                                            //
+    //=======================================================================//
+    // Total number of threads (incl the caller of "ParallelFor"):
+    int NThreads() const { return int(m_workers.size()) + 1; }
+
+    // The index (in [0, NThreads())) of the current thread within the inner-
+    // most "ParallelFor" being executed by it; 0 for the calling thread and
+    // for the serial execution:
+    static int WorkerIndex() { return WorkerIndexRef(); }
+
+    //=======================================================================//
+    // "ParallelFor":                                                        //
+    //=======================================================================//
+    // If any "f(i)" throws an exception, the first one is re-thrown after all
+    // jobs are done:
+    //
+    void ParallelFor(int a_n, std::function<void(int)> const& a_f)
+    {
+      if (a_n <= 0)
+        return;
+
+      // Serial execution: no workers, a single job, or a nested call (the
+      // "WorkerIndex" of the caller is restored even if "a_f" throws):
+      if (m_workers.empty() || a_n == 1 || InJob())
+      {
+        int&  index = WorkerIndexRef();
+        int   saved = index;
+        index       = 0;
+        try
+        {
+          for (int i = 0; i < a_n; ++i)
+            a_f(i);
+        }
+        catch (...)
+        {
+          index = saved;
+          throw;
+        }
+        index = saved;
+        return;
+      }
+
+      std::lock_guard<std::mutex> callLock(m_callMx);
+      {
+        std::lock_guard<std::mutex> lock(m_mx);
+        m_job    = &a_f;
+        m_n      = a_n;
+        // The initial ranges: equal contiguous shares:
+        int const nt = NThreads();
+        for (int t = 0; t < nt; ++t)
+          m_ranges[t].m_lohi.store
+            (Pack(uint32_t((long(a_n) * t)       / nt),
+                  uint32_t((long(a_n) * (t + 1)) / nt)),
+             std::memory_order_relaxed);
+        m_active = int(m_workers.size());
+        m_exn    = nullptr;
+        ++m_gen;
+      }
+      m_startCV.notify_all();
+
+      // The calling thread participates as well:
+      RunJob(0);
+
+      std::exception_ptr exn;
+      {
+        std::unique_lock<std::mutex> lock(m_mx);
+        m_doneCV.wait(lock, [&]{ return m_active == 0; });
+        m_job = nullptr;
+        exn   = m_exn;
+        m_exn = nullptr;
+      }
+      if (exn != nullptr)
+        std::rethrow_exception(exn);
+    }
+  };
+}
+// End namespace SpaceBallistics
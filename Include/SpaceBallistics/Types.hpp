@@ -72,6 +72,11 @@ namespace SpaceBallistics
   // Gravitational Field Constant:
   using GM       = decltype(Cube(1.0_m) / Sqr(1.0_sec));
 
+  // Gravitational Potential (per unit mass, m^2/sec^2) and Gravity Gradient
+  // (d(Acc)/d(Len), 1/sec^2):
+  using GravPot  = decltype(GM()   / 1.0_m);
+  using GravGrad = decltype(Acc()  / 1.0_m);
+
   //-------------------------------------------------------------------------//
   // Powers of "Len" and their Time Derivatives: Widely used:                //
   //-------------------------------------------------------------------------//
@@ -135,6 +140,12 @@ namespace SpaceBallistics
   DCL_VEC(MoIRate, T)   // MoI Change Rates
 # undef DCL_VEC
 
+  // Unlike the above, the Gravity-Gradient Tensor is a full (symmetric) 3*3
+  // matrix, indexed as [row][col]:
+  //
+  template<typename COS>
+  using GravGradT = std::array<std::array<GravGrad, 3>, 3>;
+
   //=========================================================================//
   // Computation Tolerances:                                                 //
   //=========================================================================//
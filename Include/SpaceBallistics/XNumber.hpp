@@ -0,0 +1,99 @@
+// vim:ts=2:et
+//===========================================================================//
+//                      "SpaceBallistics/XNumber.hpp":                       //
+//             Extended-Range Floating-Point Numbers ("X-Numbers")           //
+//===========================================================================//
+#pragma once
+#include "SpaceBallistics/Types.hpp"
+#include <cmath>
+
+namespace SpaceBallistics
+{
+  //=========================================================================//
+  // "XNum":                                                                 //
+  //=========================================================================//
+  // A "double" mantissa "m_f" with an "int" exponent "m_e" (Fukushima 2012):
+  //   x = m_f * XBig^m_e,  XBig = 2^960,
+  // normalised so that XBigSI <= |m_f| < XBigS (XBigS = SqRt(XBig)), or m_f=0.
+  // Thus the range of "x" is practically unlimited,  and the precision is the
+  // same as that of "double". As long as the factors in "XLinComb" are within
+  // [1/XBigS, XBigS], a single normalisation step after each op is sufficient.
+  // Used for the Legendre functions of very high degrees,  which underflow in
+  // "double" near the poles:
+  //
+  constexpr double XBig   = 0x1p960;
+  constexpr double XBigI  = 0x1p-960;
+  constexpr double XBigS  = 0x1p480;
+  constexpr double XBigSI = 0x1p-480;
+
+  struct XNum
+  {
+    double m_f;
+    int    m_e;
+  };
+
+  //-------------------------------------------------------------------------//
+  // "XNorm": Single Normalisation Step:                                     //
+  //-------------------------------------------------------------------------//
+  inline void XNorm(XNum* a_x)
+  {
+    double const w = Abs(a_x->m_f);
+    if (w >= XBigS)
+    {
+      a_x->m_f *= XBigI;
+      ++a_x->m_e;
+    }
+    else
+    if (w < XBigSI && a_x->m_f != 0.0)
+    {
+      a_x->m_f *= XBig;
+      --a_x->m_e;
+    }
+  }
+
+  //-------------------------------------------------------------------------//
+  // "XLinComb": a_f * a_x + a_g * a_y:                                      //
+  //-------------------------------------------------------------------------//
+  // If the exponents differ by more than 1, the smaller term is below the
+  // rounding error of the larger one:
+  //
+  inline XNum XLinComb(double a_f, XNum a_x, double a_g, XNum a_y)
+  {
+    int const id = a_x.m_e - a_y.m_e;
+    XNum      z;
+    if (id == 0)
+      z = XNum{ a_f * a_x.m_f + a_g * a_y.m_f,            a_x.m_e };
+    else
+    if (id == 1)
+      z = XNum{ a_f * a_x.m_f + a_g * (a_y.m_f * XBigI),  a_x.m_e };
+    else
+    if (id == -1)
+      z = XNum{ a_f * (a_x.m_f * XBigI) + a_g * a_y.m_f,  a_y.m_e };
+    else
+    if (id > 1)
+      z = XNum{ a_f * a_x.m_f,                            a_x.m_e };
+    else
+      z = XNum{ a_g * a_y.m_f,                            a_y.m_e };
+    XNorm(&z);
+    return z;
+  }
+
+  //-------------------------------------------------------------------------//
+  // "XToF": Conversion into "double" (may underflow to 0):                  //
+  //-------------------------------------------------------------------------//
+  inline double XToF(XNum a_x)
+  {
+    return
+      (a_x.m_e ==  0) ? a_x.m_f          :
+      (a_x.m_e == -1) ? a_x.m_f * XBigI  :
+      (a_x.m_e <  -1) ? 0.0              :
+      a_x.m_f * XBig;   // May overflow, but we do not use such values
+  }
+
+  //-------------------------------------------------------------------------//
+  // "XLog2": Binary Logarithm of |x| (-Inf for 0):                          //
+  //-------------------------------------------------------------------------//
+  inline double XLog2(XNum a_x)
+    { return std::log2(Abs(a_x.m_f)) + 960.0 * double(a_x.m_e); }
+}
+// End namespace SpaceBallistics
@@ -0,0 +1,121 @@
+// vim:ts=2:et
+//===========================================================================//
+//                      "Src/PhysForces/CacheFile.cpp":                      //
+//       Binary Cache Files: Checksums, Atomic Writes, Read-Only Mappings    //
+//===========================================================================//
+#include "SpaceBallistics/PhysForces/CacheFile.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SpaceBallistics::CacheFile
+{
+  //=========================================================================//
+  // "CheckSum":                                                             //
+  //=========================================================================//
+  uint64_t CheckSum(void const* a_data, size_t a_n_words)
+  {
+    char const* p = static_cast<char const*>(a_data);
+    uint64_t    h = 14695981039346656037ULL;
+    for (size_t i = 0; i < a_n_words; ++i, p += sizeof(uint64_t))
+    {
+      uint64_t w;
+      memcpy(&w, p, sizeof(w));
+      h = (h ^ w) * 1099511628211ULL;
+    }
+    return h;
+  }
+
+  //=========================================================================//
+  // "WriteAll":                                                             //
+  //=========================================================================//
+  bool WriteAll(int a_fd, void const* a_buff, size_t a_len)
+  {
+    char const* p    = static_cast<char const*>(a_buff);
+    size_t      left = a_len;
+    while (left > 0)
+    {
+      ssize_t done = write(a_fd, p, left);
+      if (done < 0 && errno == EINTR)
+        continue;
+      if (done <= 0)
+        return false;
+      p    += done;
+      left -= size_t(done);
+    }
+    return true;
+  }
+
+  //=========================================================================//
+  // "AtomicWrite":                                                          //
+  //=========================================================================//
+  bool AtomicWrite
+  (
+    std::string const& a_file,
+    void const*        a_hdr,
+    size_t             a_hdr_len,
+    void const*        a_data,
+    size_t             a_data_len
+  )
+  {
+    std::string const tmpFile = a_file + ".tmp." + std::to_string(getpid());
+
+    int fd = open(tmpFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                  0644);
+    if (fd < 0)
+      return false;
+
+    bool ok =
+      WriteAll(fd, a_hdr,  a_hdr_len)  &&
+      WriteAll(fd, a_data, a_data_len) &&
+      fsync(fd) == 0;
+    ok = (close(fd) == 0) && ok;
+
+    if (!ok || rename(tmpFile.c_str(), a_file.c_str()) != 0)
+    {
+      unlink(tmpFile.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  //=========================================================================//
+  // "MappedFile":                                                           //
+  //=========================================================================//
+  bool MappedFile::Map(std::string const& a_file)
+  {
+    Unmap(m_addr, m_len);
+    m_addr = nullptr;
+    m_len  = 0;
+
+    int fd = open(a_file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+      close(fd);
+      return false;
+    }
+    void* addr =
+      mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);                  // The mapping remains valid
+    if (addr == MAP_FAILED)
+      return false;
+
+    m_addr = addr;
+    m_len  = size_t(st.st_size);
+    return true;
+  }
+
+  void MappedFile::Unmap(void* a_addr, size_t a_len) noexcept
+  {
+    if (a_addr != nullptr)
+      munmap(a_addr, a_len);
+  }
+}
+// End namespace SpaceBallistics::CacheFile
@@ -0,0 +1,275 @@
+// vim:ts=2:et
+//===========================================================================//
+//                     "Src/PhysForces/GravityGrid.cpp":                     //
+//      Pre-Computed Gravitational Acceleration on a Spherical-Shell Grid    //
+//===========================================================================//
+#include "SpaceBallistics/PhysForces/GravityGrid.h"
+#include "SpaceBallistics/PhysForces/CacheFile.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace SpaceBallistics
+{
+  using CacheFile::CheckSum;
+  using CacheFile::MappedFile;
+
+  namespace
+  {
+    //=======================================================================//
+    // Grid File Format:                                                     //
+    //=======================================================================//
+    // The header is followed by "m_nData" doubles (see "GravityGridBase::
+    // m_data") in the native byte order:
+    //
+    constexpr char     GridMagic[8]
+      { 'S', 'B', 'G', 'G', 'R', 'I', 'D', '\1' };
+    constexpr uint32_t GridVersion = 1;
+
+    struct GridHeader
+    {
+      char     m_magic[8];
+      uint32_t m_version;
+      int32_t  m_body;
+      int32_t  m_n;
+      int32_t  m_NR;
+      int32_t  m_NLat;
+      int32_t  m_NLon;
+      double   m_rMin;         // In m
+      double   m_rMax;         // In m
+      double   m_K;            // In m^3/sec^2
+      double   m_errBound;     // In m/sec^2
+      uint64_t m_nData;
+      uint64_t m_checkSum;     // Of the data (see "CacheFile::CheckSum")
+      char     m_reserved[48];
+    };
+    static_assert(sizeof(GridHeader) == 128);
+
+    // Number of doubles in the grid with the given dimensions:
+    uint64_t NData(int a_NR, int a_NLat, int a_NLon)
+    {
+      return 4 * uint64_t(a_NR) * uint64_t(a_NLat + 3) * uint64_t(a_NLon + 3);
+    }
+
+    [[noreturn]] void LoadError(std::string const& a_file, char const* a_msg)
+    {
+      throw std::runtime_error
+            ("GravityGrid: " + a_file + ": " + a_msg);
+    }
+  }
+
+  //=========================================================================//
+  // Non-Default Ctor:                                                       //
+  //=========================================================================//
+  GravityGridBase::GravityGridBase(std::string const& a_file, Body a_body)
+  : m_body    (a_body),
+    m_n       (0),
+    m_NR      (0),
+    m_NLat    (0),
+    m_NLon    (0),
+    m_rMin    (0.0),
+    m_rMax    (0.0),
+    m_K       (0.0),
+    m_errBound(0.0),
+    m_r0      (0.0),
+    m_idr     (0.0),
+    m_idPhi   (0.0),
+    m_idLambda(0.0),
+    m_rowLen  (0),
+    m_shellLen(0),
+    m_data    (nullptr),
+    m_map     (nullptr),
+    m_mapLen  (0)
+  {
+    //-----------------------------------------------------------------------//
+    // "mmap" the file:                                                      //
+    //-----------------------------------------------------------------------//
+    // (Until all checks are passed, the mapping is owned by "mf", as the Dtor
+    // is not invoked for a partially-constructed obj):
+    MappedFile mf;
+    if (!mf.Map(a_file))
+      LoadError(a_file, "Cannot open or mmap");
+    if (mf.Len() < sizeof(GridHeader))
+      LoadError(a_file, "Invalid size");
+
+    //-----------------------------------------------------------------------//
+    // Verify the header and the data:                                       //
+    //-----------------------------------------------------------------------//
+    GridHeader hdr;
+    memcpy(&hdr, mf.Addr(), sizeof(hdr));
+
+    double const* data =
+      reinterpret_cast<double const*>
+        (static_cast<char const*>(mf.Addr()) + sizeof(GridHeader));
+
+    if (memcmp(hdr.m_magic, GridMagic, sizeof(GridMagic)) != 0 ||
+        hdr.m_version != GridVersion                             ||
+        hdr.m_NR < 4  || hdr.m_NLat < 4 || hdr.m_NLon < 4        ||
+        hdr.m_NLon % 2 != 0                                      ||
+        hdr.m_nData != NData(hdr.m_NR, hdr.m_NLat, hdr.m_NLon)   ||
+        mf.Len() != sizeof(GridHeader) + hdr.m_nData * sizeof(double) ||
+        !(0.0 < hdr.m_rMin && hdr.m_rMin < hdr.m_rMax && hdr.m_K > 0.0) ||
+        CheckSum(data, size_t(hdr.m_nData)) != hdr.m_checkSum)
+      LoadError(a_file, "Invalid or corrupted grid file");
+
+    if (hdr.m_body != int(a_body))
+      LoadError(a_file, "The grid is for a different Body");
+
+    //-----------------------------------------------------------------------//
+    // OK:                                                                   //
+    //-----------------------------------------------------------------------//
+    m_n        = hdr.m_n;
+    m_NR       = hdr.m_NR;
+    m_NLat     = hdr.m_NLat;
+    m_NLon     = hdr.m_NLon;
+    m_rMin     = Len(hdr.m_rMin);
+    m_rMax     = Len(hdr.m_rMax);
+    m_K        = GM (hdr.m_K);
+    m_errBound = Acc(hdr.m_errBound);
+    m_r0       = hdr.m_rMin;
+    m_idr      = double(m_NR - 1) / (hdr.m_rMax - hdr.m_rMin);
+    m_idPhi    = double(m_NLat)   / Pi<double>;
+    m_idLambda = double(m_NLon)   / (2.0 * Pi<double>);
+    m_rowLen   = size_t(m_NLon + 3);
+    m_shellLen = m_rowLen * size_t(m_NLat + 3);
+    m_data     = data;
+    m_mapLen   = mf.Len();
+    m_map      = mf.Release();
+  }
+
+  //=========================================================================//
+  // Move Ctor, Dtor:                                                        //
+  //=========================================================================//
+  GravityGridBase::GravityGridBase(GravityGridBase&& a_right) noexcept
+  : m_body    (a_right.m_body),
+    m_n       (a_right.m_n),
+    m_NR      (a_right.m_NR),
+    m_NLat    (a_right.m_NLat),
+    m_NLon    (a_right.m_NLon),
+    m_rMin    (a_right.m_rMin),
+    m_rMax    (a_right.m_rMax),
+    m_K       (a_right.m_K),
+    m_errBound(a_right.m_errBound),
+    m_r0      (a_right.m_r0),
+    m_idr     (a_right.m_idr),
+    m_idPhi   (a_right.m_idPhi),
+    m_idLambda(a_right.m_idLambda),
+    m_rowLen  (a_right.m_rowLen),
+    m_shellLen(a_right.m_shellLen),
+    m_data    (a_right.m_data),
+    m_map     (a_right.m_map),
+    m_mapLen  (a_right.m_mapLen)
+  {
+    a_right.m_data   = nullptr;
+    a_right.m_map    = nullptr;
+    a_right.m_mapLen = 0;
+  }
+
+  GravityGridBase::~GravityGridBase()
+  {
+    MappedFile::Unmap(m_map, m_mapLen);
+  }
+
+  //=========================================================================//
+  // "MkErrBound":                                                           //
+  //=========================================================================//
+  Acc GravityGridBase::MkErrBound
+  (
+    GM            a_K,
+    Len           a_Re,
+    double const* a_w,
+    int           a_n,
+    Len           a_rmin,
+    Len           a_rmax,
+    int           a_NR,
+    int           a_NLat,
+    int           a_NLon
+  )
+  {
+    assert(a_w != nullptr && a_NR >= 4 && a_NLat >= 4 && a_NLon >= 4);
+
+    // The 4-point Lagrange remainder is |s(s-1)(s-2)(s-3)| / 24 times the 4th
+    // derivative (in units of the step); it is at most 3/128 in the central
+    // interval (s in [1,2], used in "phi" and "lambda"), and at most 1/24 in
+    // the outer ones (which may be used radially at the edges of the band).
+    // The corresp Lebesgue consts (the norms of the interpolation operators)
+    // are 1.25 and 1.6311:
+    constexpr double CC = 3.0 / 128.0;
+    constexpr double CE = 1.0 / 24.0;
+    constexpr double LC = 1.25;
+    constexpr double LE = 1.6311;
+
+    double const rmin = a_rmin.Magnitude();
+    double const hr   = (a_rmax - a_rmin).Magnitude() / double(a_NR - 1);
+    double const hPhi = Pi<double>       / double(a_NLat);
+    double const hLam = 2.0 * Pi<double> / double(a_NLon);
+    double const ir   = double(a_Re / a_rmin);
+    double const hr4  = Sqr(Sqr(hr / rmin));
+
+    // The error of the tensor-product interpolation is bounded by
+    //   |f - Ir f| + |Ir (f - Ip f)| + |Ir Ip (f - Il f)|,
+    // and for each degree, it cannot exceed (1 + LE*LC*LC) times the term it-
+    // self. The bound on each component is multiplied by SqRt(3) to bound the
+    // magnitude of the error vector:
+    double sum = 0.0;
+    double irl = ir;
+    for (int l = 2; l <= a_n; ++l)
+    {
+      irl *= ir;
+      double const L1   = double(l + 1);
+      double const eR   =
+        CE * hr4 * double(l+2) * double(l+3) * double(l+4) * double(l+5);
+      double const eP   = CC * Sqr(Sqr(hPhi * L1));
+      double const eL   = CC * Sqr(Sqr(hLam * L1));
+      double const e    = std::min(eR + LE * eP + LE * LC * eL,
+                                   1.0 + LE * LC * LC);
+      sum += irl * a_w[l] * e;
+    }
+    return SqRt(3.0) * sum * a_K / Sqr(a_rmin);
+  }
+
+  //=========================================================================//
+  // "Save":                                                                 //
+  //=========================================================================//
+  // The grid is written atomically (see "CacheFile::AtomicWrite"). Throws
+  // "std::runtime_error" on any error:
+  //
+  void GravityGridBase::Save
+  (
+    std::string const& a_file,
+    Body               a_body,
+    int                a_n,
+    int                a_NR,
+    int                a_NLat,
+    int                a_NLon,
+    Len                a_rmin,
+    Len                a_rmax,
+    GM                 a_K,
+    Acc                a_err_bound,
+    double const*      a_data,
+    size_t             a_len
+  )
+  {
+    assert(a_data != nullptr && a_len == NData(a_NR, a_NLat, a_NLon));
+
+    GridHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.m_magic, GridMagic, sizeof(GridMagic));
+    hdr.m_version  = GridVersion;
+    hdr.m_body     = int(a_body);
+    hdr.m_n        = a_n;
+    hdr.m_NR       = a_NR;
+    hdr.m_NLat     = a_NLat;
+    hdr.m_NLon     = a_NLon;
+    hdr.m_rMin     = a_rmin.Magnitude();
+    hdr.m_rMax     = a_rmax.Magnitude();
+    hdr.m_K        = a_K.Magnitude();
+    hdr.m_errBound = a_err_bound.Magnitude();
+    hdr.m_nData    = a_len;
+    hdr.m_checkSum = CheckSum(a_data, a_len);
+
+    if (!CacheFile::AtomicWrite
+         (a_file, &hdr, sizeof(hdr), a_data, a_len * sizeof(double)))
+      throw std::runtime_error("GravityGrid: Cannot write " + a_file);
+  }
+}
+// End namespace SpaceBallistics
@@ -0,0 +1,68 @@
+// vim:ts=2:et
+//===========================================================================//
+//                     "Src/PhysForces/GravityMap.cpp":                      //
+//     Global Maps of the Gravitational Field on Latitude/Longitude Grids    //
+//===========================================================================//
+#include "SpaceBallistics/PhysForces/GravityMap.h"
+#include "SpaceBallistics/PhysForces/CacheFile.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace SpaceBallistics
+{
+  namespace
+  {
+    //=======================================================================//
+    // Map File Format:                                                      //
+    //=======================================================================//
+    // The header is followed by "m_nData" doubles (see "GravityMap::m_data")
+    // in the native byte order, so the maps can be read directly by plotting
+    // tools (eg as a raw array of the shape [NFlds, NLat, NLon] at the offset
+    // of 128 bytes):
+    //
+    constexpr char     MapMagic[8]
+      { 'S', 'B', 'G', 'M', 'A', 'P', '\0', '\1' };
+    constexpr uint32_t MapVersion = 1;
+
+    struct MapHeader
+    {
+      char     m_magic[8];
+      uint32_t m_version;
+      int32_t  m_body;
+      int32_t  m_n;
+      int32_t  m_NFlds;
+      int32_t  m_NLat;
+      int32_t  m_NLon;
+      double   m_r;            // In m
+      double   m_K;            // In m^3/sec^2
+      uint64_t m_nData;
+      char     m_reserved[72];
+    };
+    static_assert(sizeof(MapHeader) == 128);
+  }
+
+  //=========================================================================//
+  // "Save":                                                                 //
+  //=========================================================================//
+  void GravityMap::Save(std::string const& a_file) const
+  {
+    MapHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.m_magic, MapMagic, sizeof(MapMagic));
+    hdr.m_version = MapVersion;
+    hdr.m_body    = int(m_body);
+    hdr.m_n       = m_n;
+    hdr.m_NFlds   = NFlds;
+    hdr.m_NLat    = m_NLat;
+    hdr.m_NLon    = m_NLon;
+    hdr.m_r       = m_r.Magnitude();
+    hdr.m_K       = m_K.Magnitude();
+    hdr.m_nData   = m_data.size();
+
+    if (!CacheFile::AtomicWrite
+         (a_file, &hdr, sizeof(hdr),
+          m_data.data(), m_data.size() * sizeof(double)))
+      throw std::runtime_error("GravityMap: Cannot write " + a_file);
+  }
+}
+// End namespace SpaceBallistics
@@ -0,0 +1,406 @@
+// vim:ts=2:et
+//===========================================================================//
+//                    "Src/PhysForces/GravityModel.cpp":                     //
+//         Run-Time Gravity Field Models (ICGEM Files, Binary Cache)         //
+//===========================================================================//
+#include "SpaceBallistics/PhysForces/GravityModel.h"
+#include "SpaceBallistics/PhysForces/CacheFile.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <sys/stat.h>
+
+namespace SpaceBallistics
+{
+  using CacheFile::CheckSum;
+  using CacheFile::MappedFile;
+
+  namespace
+  {
+    //=======================================================================//
+    // Binary Cache Format:                                                  //
+    //=======================================================================//
+    // The header is followed by "NCoeffs(N)" "PackedSHCoeffs" in the order
+    // defined by "GravityModel::CoeffIdx". All data are in the native
+    // byte order (the cache is not meant to be portable between platforms;
+    // a foreign cache is rejected by the "m_magic" / "m_version" check and is
+    // then re-created):
+    //
+    constexpr char     CacheMagic[8]
+      { 'S', 'B', 'G', 'R', 'A', 'V', '\0', '\1' };
+    constexpr uint32_t CacheVersion  = 1;
+
+    struct CacheHeader
+    {
+      char     m_magic[8];
+      uint32_t m_version;
+      int32_t  m_N;
+      double   m_Re;           // In m
+      double   m_K;            // In m^3/sec^2
+      uint64_t m_srcSize;      // Size  of the source file
+      int64_t  m_srcMTime;     // MTime of the source file (nsec)
+      uint64_t m_nCoeffs;
+      uint64_t m_checkSum;     // Of the coeffs (see "CacheFile::CheckSum")
+      char     m_name[64];     // Model Name (0-terminated, possibly truncated)
+    };
+    static_assert(sizeof(CacheHeader) == 128);
+    static_assert(sizeof(CacheHeader) % alignof(PackedSHCoeffs) == 0);
+
+    //-----------------------------------------------------------------------//
+    // "FileStamp": Size and MTime of a file; "false" if it does not exist:  //
+    //-----------------------------------------------------------------------//
+    bool FileStamp
+      (std::string const& a_file, uint64_t* a_size, int64_t* a_mtime)
+    {
+      struct stat st;
+      if (stat(a_file.c_str(), &st) != 0)
+        return false;
+      *a_size  = uint64_t(st.st_size);
+      *a_mtime = int64_t (st.st_mtim.tv_sec) * 1'000'000'000 +
+                 int64_t (st.st_mtim.tv_nsec);
+      return true;
+    }
+
+    //=======================================================================//
+    // Tokenising and Number Parsing (for ".gfc" Files):                     //
+    //=======================================================================//
+    // "std::from_chars" is used: it is locale-independent, does not allocate,
+    // and is much faster than the iostreams. The files are "mmap"ed, so there
+    // is no copying at all:
+    //
+    [[noreturn]] void ParseError
+      (std::string const& a_file, int a_line, char const* a_msg)
+    {
+      throw std::runtime_error
+            ("GravityModel: " + a_file + ':' + std::to_string(a_line) + ": " +
+             a_msg);
+    }
+
+    // Extracts the next white-space-separated token from [a_p, a_end); an
+    // empty token is returned at the end of the line:
+    std::string_view NextToken(char const** a_p, char const* a_end)
+    {
+      char const* p = *a_p;
+      while (p < a_end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        ++p;
+      char const* b = p;
+      while (p < a_end && *p != ' ' && *p != '\t' && *p != '\r')
+        ++p;
+      *a_p = p;
+      return std::string_view(b, size_t(p - b));
+    }
+
+    double ToDouble
+      (std::string_view a_tok, std::string const& a_file, int a_line)
+    {
+      // Fortran-style exponents ("1.0D-06") occur in some ICGEM files; they
+      // are converted into the C ones in a local copy:
+      char buff[64];
+      if (a_tok.empty() || a_tok.size() >= sizeof(buff))
+        ParseError(a_file, a_line, "Invalid number");
+      memcpy(buff, a_tok.data(), a_tok.size());
+      for (size_t i = 0; i < a_tok.size(); ++i)
+        if (buff[i] == 'D' || buff[i] == 'd')
+          buff[i] = 'e';
+      char const* b = buff;
+      char const* e = buff + a_tok.size();
+      if (*b == '+')
+        ++b;
+
+      double res = 0.0;
+      auto [end, ec] = std::from_chars(b, e, res);
+      if (ec != std::errc() || end != e)
+        ParseError(a_file, a_line, "Invalid number");
+      return res;
+    }
+
+    int ToInt(std::string_view a_tok, std::string const& a_file, int a_line)
+    {
+      int res = 0;
+      auto [end, ec] =
+        std::from_chars(a_tok.data(), a_tok.data() + a_tok.size(), res);
+      if (ec != std::errc() || end != a_tok.data() + a_tok.size())
+        ParseError(a_file, a_line, "Invalid integer");
+      return res;
+    }
+  }
+
+  //=========================================================================//
+  // Non-Default Ctor:                                                       //
+  //=========================================================================//
+  GravityModel::GravityModel
+  (
+    std::string const& a_gfc_file,
+    std::string const& a_cache_file
+  )
+  : m_name  (),
+    m_N     (0),
+    m_Re    (0.0),
+    m_K     (0.0),
+    m_coeffs(nullptr),
+    m_map   (nullptr),
+    m_mapLen(0),
+    m_cached(false),
+    m_own   ()
+  {
+    std::string const cacheFile =
+      a_cache_file.empty() ? (a_gfc_file + ".sbgc") : a_cache_file;
+
+    uint64_t srcSize  = 0;
+    int64_t  srcMTime = 0;
+    bool     hasSrc   = FileStamp(a_gfc_file, &srcSize, &srcMTime);
+
+    // Try the cache first:
+    if (MapCache(cacheFile, hasSrc, srcSize, srcMTime))
+    {
+      m_cached = true;
+      return;
+    }
+
+    if (!hasSrc)
+      throw std::runtime_error
+            ("GravityModel: No valid cache and no source file: " + a_gfc_file);
+
+    // Parse the source, create the cache and map it (so that the memory is
+    // shared with other processes); if that fails, use the parsed coeffs:
+    ParseGFC(a_gfc_file);
+
+    if (WriteCache(cacheFile, srcSize, srcMTime) &&
+        MapCache  (cacheFile, true, srcSize, srcMTime))
+      std::vector<PackedSHCoeffs>().swap(m_own);
+    else
+      m_coeffs = m_own.data();
+  }
+
+  //=========================================================================//
+  // Move Ctor, Dtor:                                                        //
+  //=========================================================================//
+  GravityModel::GravityModel(GravityModel&& a_right) noexcept
+  : m_name  (std::move(a_right.m_name)),
+    m_N     (a_right.m_N),
+    m_Re    (a_right.m_Re),
+    m_K     (a_right.m_K),
+    m_coeffs(a_right.m_coeffs),     // The "m_own" buffer is moved, not copied
+    m_map   (a_right.m_map),
+    m_mapLen(a_right.m_mapLen),
+    m_cached(a_right.m_cached),
+    m_own   (std::move(a_right.m_own))
+  {
+    a_right.m_coeffs = nullptr;
+    a_right.m_map    = nullptr;
+    a_right.m_mapLen = 0;
+  }
+
+  GravityModel::~GravityModel()
+  {
+    MappedFile::Unmap(m_map, m_mapLen);
+  }
+
+  //=========================================================================//
+  // "MapCache":                                                             //
+  //=========================================================================//
+  // Returns "false" if the cache does not exist or is invalid (in which case
+  // it will be re-created):
+  //
+  bool GravityModel::MapCache
+  (
+    std::string const& a_cache_file,
+    bool               a_check_src,
+    uint64_t           a_src_size,
+    int64_t            a_src_mtime
+  )
+  {
+    MappedFile mf;
+    if (!mf.Map(a_cache_file) || mf.Len() < sizeof(CacheHeader))
+      return false;
+
+    CacheHeader hdr;
+    memcpy(&hdr, mf.Addr(), sizeof(hdr));
+
+    if (memcmp(hdr.m_magic, CacheMagic, sizeof(CacheMagic)) != 0 ||
+        hdr.m_version != CacheVersion                              ||
+        hdr.m_N < 0   || hdr.m_N == 1                              ||
+        hdr.m_nCoeffs != uint64_t(NCoeffs(hdr.m_N))                ||
+        mf.Len() != sizeof(CacheHeader) +
+                    hdr.m_nCoeffs * sizeof(PackedSHCoeffs)         ||
+        !(hdr.m_Re > 0.0 && hdr.m_K > 0.0))
+      return false;
+
+    if (a_check_src &&
+       (hdr.m_srcSize != a_src_size || hdr.m_srcMTime != a_src_mtime))
+      return false;
+
+    auto const* coeffs =
+      reinterpret_cast<PackedSHCoeffs const*>
+        (static_cast<char const*>(mf.Addr()) + sizeof(CacheHeader));
+
+    // Each "PackedSHCoeffs" is 2 words:
+    if (CheckSum(coeffs, 2 * size_t(hdr.m_nCoeffs)) != hdr.m_checkSum)
+      return false;
+
+    // OK, take over the mapping:
+    hdr.m_name[sizeof(hdr.m_name)-1] = '\0';
+    m_name     = hdr.m_name;
+    m_N        = hdr.m_N;
+    m_Re       = Len(hdr.m_Re);
+    m_K        = GM (hdr.m_K);
+    m_coeffs   = coeffs;
+    m_mapLen   = mf.Len();
+    m_map      = mf.Release();
+    return true;
+  }
+
+  //=========================================================================//
+  // "WriteCache":                                                           //
+  //=========================================================================//
+  // The cache is written atomically (see "CacheFile::AtomicWrite"). Returns
+  // "false" on any error:
+  //
+  bool GravityModel::WriteCache
+  (
+    std::string const& a_cache_file,
+    uint64_t           a_src_size,
+    int64_t            a_src_mtime
+  )
+  const
+  {
+    CacheHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.m_magic, CacheMagic, sizeof(CacheMagic));
+    hdr.m_version  = CacheVersion;
+    hdr.m_N        = m_N;
+    hdr.m_Re       = m_Re.Magnitude();
+    hdr.m_K        = m_K .Magnitude();
+    hdr.m_srcSize  = a_src_size;
+    hdr.m_srcMTime = a_src_mtime;
+    hdr.m_nCoeffs  = m_own.size();
+    hdr.m_checkSum = CheckSum(m_own.data(), 2 * m_own.size());
+    strncpy(hdr.m_name, m_name.c_str(), sizeof(hdr.m_name)-1);
+
+    return CacheFile::AtomicWrite
+      (a_cache_file, &hdr, sizeof(hdr),
+       m_own.data(),   m_own.size() * sizeof(PackedSHCoeffs));
+  }
+
+  //=========================================================================//
+  // "ParseGFC":                                                             //
+  //=========================================================================//
+  // Parses an ICGEM ".gfc" file (formats 1.0 and 2.0). The header keywords
+  // used are "modelname", "earth_gravity_constant" (used for all Bodies),
+  // "radius", "max_degree" and "norm" ("fully_normalized" (default) or
+  // "unnormalized"). In the data section, the static "gfc" records and the
+  // reference values of the "gfct" records are used; the time-variable parts
+  // ("trnd", "dot", "acos", "asin") are ignored. Degrees 0 and 1 are ignored
+  // as well (the central term is implied, and the origin is at the CoM):
+  //
+  void GravityModel::ParseGFC(std::string const& a_gfc_file)
+  {
+    MappedFile mf;
+    if (!mf.Map(a_gfc_file))
+      throw std::runtime_error("GravityModel: Cannot read " + a_gfc_file);
+
+    char const* p      = static_cast<char const*>(mf.Addr());
+    char const* end    = p + mf.Len();
+    int         line   = 0;
+    bool        inHead = true;
+    bool        unNorm = false;
+    int         maxDeg = -1;
+    double      re     = 0.0;
+    double      k      = 0.0;
+    std::vector<double> cs;         // (C,S) pairs, in the "CoeffIdx" order
+
+    while (p < end)
+    {
+      // Get the next line:
+      ++line;
+      char const* le = static_cast<char const*>(memchr(p, '\n', size_t(end-p)));
+      if (le == nullptr)
+        le = end;
+      char const* q  = p;
+      p              = (le < end) ? le + 1 : end;
+
+      std::string_view key = NextToken(&q, le);
+      if (key.empty())
+        continue;
+
+      if (inHead)
+      {
+        //-------------------------------------------------------------------//
+        // Header:                                                           //
+        //-------------------------------------------------------------------//
+        std::string_view val = NextToken(&q, le);
+        if (key == "end_of_head")
+        {
+          if (maxDeg < 0 || !(re > 0.0) || !(k > 0.0))
+            ParseError(a_gfc_file, line,
+                       "Missing max_degree, radius or earth_gravity_constant");
+          inHead = false;
+          m_N    = (maxDeg < 2) ? 0 : maxDeg;
+          m_Re   = Len(re);
+          m_K    = GM (k);
+          cs.assign(2 * size_t(NCoeffs(m_N)), 0.0);
+        }
+        else
+        if (key == "modelname")
+          m_name = std::string(val);
+        else
+        if (key == "earth_gravity_constant")
+          k      = ToDouble(val, a_gfc_file, line);
+        else
+        if (key == "radius")
+          re     = ToDouble(val, a_gfc_file, line);
+        else
+        if (key == "max_degree")
+          maxDeg = ToInt   (val, a_gfc_file, line);
+        else
+        if (key == "norm")
+          unNorm = (val == "unnormalized");
+        // Other header lines are ignored
+        continue;
+      }
+      //---------------------------------------------------------------------//
+      // Data Records:                                                       //
+      //---------------------------------------------------------------------//
+      if (key == "trnd" || key == "dot" || key == "acos" || key == "asin")
+        continue;
+      if (key != "gfc" && key != "gfct")
+        ParseError(a_gfc_file, line, "Unknown record");
+
+      int    l = ToInt   (NextToken(&q, le), a_gfc_file, line);
+      int    m = ToInt   (NextToken(&q, le), a_gfc_file, line);
+      double c = ToDouble(NextToken(&q, le), a_gfc_file, line);
+      double s = ToDouble(NextToken(&q, le), a_gfc_file, line);
+
+      if (m < 0 || m > l || l > maxDeg)
+        ParseError(a_gfc_file, line, "Invalid degree or order");
+      if (l < 2)
+        continue;
+
+      if (unNorm)
+      {
+        // Convert into the fully-normalised ones: divide by
+        // SqRt((2 - delta(m,0)) * (2l+1) * (l-m)! / (l+m)!):
+        double lnN = 0.5 * (std::log(double((m == 0 ? 1 : 2) * (2*l+1))) +
+                            std::lgamma(double(l-m+1))                    -
+                            std::lgamma(double(l+m+1)));
+        double f   = std::exp(-lnN);
+        c *= f;
+        s *= f;
+      }
+      size_t i  = size_t(CoeffIdx(l, m, m_N));
+      cs[2*i]   = c;
+      cs[2*i+1] = s;
+    }
+    if (inHead)
+      ParseError(a_gfc_file, line, "No end_of_head");
+
+    m_own.clear();
+    m_own.reserve(cs.size() / 2);
+    for (size_t i = 0; i < cs.size(); i += 2)
+      m_own.push_back(PackedSHCoeffs{ cs[i], cs[i+1] });
+  }
+}
+// End namespace SpaceBallistics
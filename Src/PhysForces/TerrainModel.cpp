@@ -0,0 +1,395 @@
+// vim:ts=2:et
+//===========================================================================//
+//                    "Src/PhysForces/TerrainModel.cpp":                     //
+//     Digital Elevation Models from "mmap"ed Tiles, Terrain-Aware Impacts   //
+//===========================================================================//
+#include "SpaceBallistics/PhysForces/TerrainModel.h"
+#include "SpaceBallistics/PhysForces/CacheFile.h"
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SpaceBallistics
+{
+  namespace
+  {
+    constexpr char     TileMagic[8]
+      { 'S', 'B', 'D', 'E', 'M', 'T', 'L', '\1' };
+    constexpr uint32_t TileVersion = 1;
+
+    // Tolerance for the tile geometry checks (rad):
+    constexpr double   GeomTol     = 1e-9;
+
+    [[noreturn]] void LoadError(std::string const& a_file, char const* a_msg)
+    {
+      throw std::runtime_error
+            ("TerrainModel: " + a_file + ": " + a_msg);
+    }
+
+    //-----------------------------------------------------------------------//
+    // "CheckHeader":                                                        //
+    //-----------------------------------------------------------------------//
+    // Whether the header is valid for the tile (i, j) of the given grid, and
+    // the file is of the right size:
+    //
+    bool CheckHeader
+    (
+      TerrainModel::TileHeader const& a_hdr,
+      size_t                          a_file_size,
+      Body                            a_body,
+      int                             a_n_tile_rows,
+      int                             a_n_tile_cols,
+      int                             a_i,
+      int                             a_j
+    )
+    {
+      double const tilePhi    = Pi<double>       / double(a_n_tile_rows);
+      double const tileLambda = 2.0 * Pi<double> / double(a_n_tile_cols);
+      return
+        memcmp(a_hdr.m_magic, TileMagic, sizeof(TileMagic)) == 0         &&
+        a_hdr.m_version == TileVersion && a_hdr.m_body == int(a_body)     &&
+        a_hdr.m_NLat >= 2 && a_hdr.m_NLon >= 2                            &&
+        a_file_size == sizeof(TerrainModel::TileHeader) +
+                       size_t(a_hdr.m_NLat) * size_t(a_hdr.m_NLon) *
+                       sizeof(int16_t)                                    &&
+        std::fabs(a_hdr.m_phiN -
+                  (0.5 * Pi<double> - double(a_i) * tilePhi)) < GeomTol   &&
+        std::fabs(a_hdr.m_lambdaW - double(a_j) * tileLambda) < GeomTol   &&
+        std::fabs(double(a_hdr.m_NLat - 1) * a_hdr.m_dPhi    - tilePhi)
+          < GeomTol                                                       &&
+        std::fabs(double(a_hdr.m_NLon - 1) * a_hdr.m_dLambda - tileLambda)
+          < GeomTol                                                       &&
+        a_hdr.m_R > 0.0 && a_hdr.m_scale > 0.0                            &&
+        a_hdr.m_hMin <= a_hdr.m_hMax;
+    }
+  }
+
+  //=========================================================================//
+  // Non-Default Ctor:                                                       //
+  //=========================================================================//
+  TerrainModel::TerrainModel
+  (
+    std::string const& a_dir,
+    Body               a_body,
+    int                a_n_tile_rows,
+    int                a_n_tile_cols,
+    int                a_cache_size,
+    Len                a_h_no_data
+  )
+  : m_dir         (a_dir),
+    m_body        (a_body),
+    m_NTileRows   (a_n_tile_rows),
+    m_NTileCols   (a_n_tile_cols),
+    m_idTilePhi   (double(a_n_tile_rows) / Pi<double>),
+    m_idTileLambda(double(a_n_tile_cols) / (2.0 * Pi<double>)),
+    m_R           (0.0),
+    m_hNoData     (a_h_no_data),
+    m_hMin        (a_h_no_data),
+    m_hMax        (a_h_no_data),
+    m_present     (),
+    m_slotOf      (),
+    m_slots       (),
+    m_last        (-1),
+    m_clock       (0),
+    m_nMaps       (0),
+    m_nFailed     (0)
+  {
+    if (UNLIKELY(a_n_tile_rows < 1 || a_n_tile_cols < 1 || a_cache_size < 1))
+      throw std::invalid_argument("TerrainModel: Invalid Param(s)");
+
+    size_t const nTiles = size_t(a_n_tile_rows) * size_t(a_n_tile_cols);
+    m_present.assign(nTiles, false);
+    m_slotOf .assign(nTiles, -1);
+    m_slots  .assign
+      (size_t(a_cache_size),
+       Slot{ -1, 0, nullptr, 0, nullptr, 0, 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 });
+
+    //-----------------------------------------------------------------------//
+    // Scan the tile headers:                                                //
+    //-----------------------------------------------------------------------//
+    bool any = false;
+    for (int i = 0; i < a_n_tile_rows; ++i)
+    for (int j = 0; j < a_n_tile_cols; ++j)
+    {
+      std::string const file = TileFile(a_dir, i, j);
+      int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0)
+      {
+        if (errno == ENOENT)
+          continue;             // Missing tiles are OK
+        LoadError(file, "Cannot open");
+      }
+      TileHeader  hdr;
+      struct stat st;
+      bool ok = fstat(fd, &st) == 0 &&
+                pread(fd, &hdr, sizeof(hdr), 0) == ssize_t(sizeof(hdr));
+      close(fd);
+      if (!ok || !CheckHeader(hdr, size_t(st.st_size), a_body, a_n_tile_rows,
+                              a_n_tile_cols, i, j))
+        LoadError(file, "Invalid tile file");
+
+      if (any && hdr.m_R != m_R.Magnitude())
+        LoadError(file, "Inconsistent reference radius");
+
+      m_R    = Len(hdr.m_R);
+      m_hMin = std::min(m_hMin, Len(hdr.m_hMin));
+      m_hMax = std::max(m_hMax, Len(hdr.m_hMax));
+      m_present[size_t(i) * size_t(a_n_tile_cols) + size_t(j)] = true;
+      any    = true;
+    }
+    if (!any)
+      LoadError(a_dir, "No tiles found");
+  }
+
+  //=========================================================================//
+  // Move Ctor, Dtor:                                                        //
+  //=========================================================================//
+  TerrainModel::TerrainModel(TerrainModel&& a_right) noexcept
+  : m_dir         (std::move(a_right.m_dir)),
+    m_body        (a_right.m_body),
+    m_NTileRows   (a_right.m_NTileRows),
+    m_NTileCols   (a_right.m_NTileCols),
+    m_idTilePhi   (a_right.m_idTilePhi),
+    m_idTileLambda(a_right.m_idTileLambda),
+    m_R           (a_right.m_R),
+    m_hNoData     (a_right.m_hNoData),
+    m_hMin        (a_right.m_hMin),
+    m_hMax        (a_right.m_hMax),
+    m_present     (std::move(a_right.m_present)),
+    m_slotOf      (std::move(a_right.m_slotOf)),
+    m_slots       (std::move(a_right.m_slots)),
+    m_last        (a_right.m_last),
+    m_clock       (a_right.m_clock),
+    m_nMaps       (a_right.m_nMaps),
+    m_nFailed     (a_right.m_nFailed)
+  {
+    // The mappings are now owned by this obj:
+    a_right.m_slots.clear();
+    a_right.m_last = -1;
+  }
+
+  TerrainModel::~TerrainModel()
+  {
+    for (Slot& slot: m_slots)
+      Unmap(&slot);
+  }
+
+  //=========================================================================//
+  // "Elevation":                                                            //
+  //=========================================================================//
+  Len TerrainModel::Elevation(Angle a_phi, Angle a_lambda) noexcept
+  {
+    double const phi    = a_phi.Magnitude();
+    double       lambda = std::fmod(a_lambda.Magnitude(), 2.0 * Pi<double>);
+    if (lambda < 0.0)
+      lambda += 2.0 * Pi<double>;
+
+    // The tile:
+    int const i    = std::clamp(int((0.5 * Pi<double> - phi) * m_idTilePhi),
+                                0, m_NTileRows - 1);
+    int const j    = std::clamp(int(lambda * m_idTileLambda),
+                                0, m_NTileCols - 1);
+    int const tile = i * m_NTileCols + j;
+
+    // Fast path: the same tile as in the last look-up:
+    int const s =
+      (m_last >= 0 && m_slots[size_t(m_last)].m_tile == tile)
+      ? m_last
+      : GetSlot(tile);
+    if (UNLIKELY(s < 0))
+      return m_hNoData;
+
+    m_last = s;
+    Slot& slot  = m_slots[size_t(s)];
+    slot.m_used = ++m_clock;
+
+    // The cell and the bilinear weights:
+    double const u  = (slot.m_phiN   - phi)    * slot.m_idPhi;
+    double const v  = (lambda - slot.m_lambdaW) * slot.m_idLambda;
+    int    const r0 = std::clamp(int(u), 0, slot.m_NLat - 2);
+    int    const c0 = std::clamp(int(v), 0, slot.m_NLon - 2);
+    double const fu = std::clamp(u - double(r0), 0.0, 1.0);
+    double const fv = std::clamp(v - double(c0), 0.0, 1.0);
+
+    int16_t const* p   = slot.m_data + size_t(r0) * size_t(slot.m_NLon) +
+                         size_t(c0);
+    int16_t const* q   = p + slot.m_NLon;
+    double   const top = (1.0 - fv) * double(p[0]) + fv * double(p[1]);
+    double   const bot = (1.0 - fv) * double(q[0]) + fv * double(q[1]);
+    return Len(slot.m_offset + slot.m_scale * ((1.0 - fu) * top + fu * bot));
+  }
+
+  //=========================================================================//
+  // "GetSlot": The LRU Tile Cache:                                          //
+  //=========================================================================//
+  int TerrainModel::GetSlot(int a_tile) noexcept
+  {
+    int s = m_slotOf[size_t(a_tile)];
+    if (s >= 0)
+      return s;
+    if (!m_present[size_t(a_tile)])
+      return -1;
+
+    // Find a free slot, or the Least-Recently-Used one:
+    s = 0;
+    for (int k = 0; k < int(m_slots.size()); ++k)
+    {
+      Slot const& slot = m_slots[size_t(k)];
+      if (slot.m_tile < 0)
+      {
+        s = k;
+        break;
+      }
+      if (slot.m_used < m_slots[size_t(s)].m_used)
+        s = k;
+    }
+    Slot& slot = m_slots[size_t(s)];
+    Unmap(&slot);
+
+    // Map the tile. The header has already been checked by the Ctor, but the
+    // file may have been changed since then, so it is checked again;  on any
+    // failure, the tile is treated as missing from now on:
+    int const         i    = a_tile / m_NTileCols;
+    int const         j    = a_tile % m_NTileCols;
+    std::string const file = TileFile(m_dir, i, j);
+    CacheFile::MappedFile mf;
+    TileHeader            hdr;
+    bool ok = mf.Map(file) && mf.Len() >= sizeof(TileHeader);
+    if (ok)
+    {
+      memcpy(&hdr, mf.Addr(), sizeof(hdr));
+      ok = CheckHeader(hdr, mf.Len(), m_body, m_NTileRows, m_NTileCols, i, j)
+           && hdr.m_R == m_R.Magnitude();
+    }
+    if (UNLIKELY(!ok))
+    {
+      m_present[size_t(a_tile)] = false;
+      ++m_nFailed;
+      return -1;
+    }
+    slot.m_tile     = a_tile;
+    slot.m_used     = m_clock;
+    slot.m_mapLen   = mf.Len();
+    slot.m_map      = mf.Release();
+    slot.m_data     =
+      reinterpret_cast<int16_t const*>
+        (static_cast<char const*>(slot.m_map) + sizeof(TileHeader));
+    slot.m_NLat     = hdr.m_NLat;
+    slot.m_NLon     = hdr.m_NLon;
+    slot.m_phiN     = hdr.m_phiN;
+    slot.m_lambdaW  = hdr.m_lambdaW;
+    slot.m_idPhi    = 1.0 / hdr.m_dPhi;
+    slot.m_idLambda = 1.0 / hdr.m_dLambda;
+    slot.m_scale    = hdr.m_scale;
+    slot.m_offset   = hdr.m_offset;
+    m_slotOf[size_t(a_tile)] = s;
+    ++m_nMaps;
+    return s;
+  }
+
+  //=========================================================================//
+  // "Unmap":                                                                //
+  //=========================================================================//
+  void TerrainModel::Unmap(Slot* a_slot) noexcept
+  {
+    assert(a_slot != nullptr);
+    if (a_slot->m_tile < 0)
+      return;
+    CacheFile::MappedFile::Unmap(a_slot->m_map, a_slot->m_mapLen);
+    m_slotOf[size_t(a_slot->m_tile)] = -1;
+    if (m_last >= 0 && &m_slots[size_t(m_last)] == a_slot)
+      m_last = -1;
+    a_slot->m_tile = -1;
+    a_slot->m_map  = nullptr;
+    a_slot->m_data = nullptr;
+  }
+
+  //=========================================================================//
+  // "TileFile":                                                             //
+  //=========================================================================//
+  std::string TerrainModel::TileFile(std::string const& a_dir, int a_i, int a_j)
+  {
+    char name[32];
+    snprintf(name, sizeof(name), "/T%04d_%04d.sbdem", a_i, a_j);
+    return a_dir + name;
+  }
+
+  //=========================================================================//
+  // "SaveTile":                                                             //
+  //=========================================================================//
+  void TerrainModel::SaveTile
+  (
+    std::string const& a_dir,
+    Body               a_body,
+    int                a_n_tile_rows,
+    int                a_n_tile_cols,
+    int                a_i,
+    int                a_j,
+    Len                a_R,
+    int                a_NLat,
+    int                a_NLon,
+    double const*      a_h,
+    double             a_scale
+  )
+  {
+    if (UNLIKELY(a_n_tile_rows < 1 || a_n_tile_cols < 1     ||
+                 a_i < 0 || a_i >= a_n_tile_rows             ||
+                 a_j < 0 || a_j >= a_n_tile_cols             ||
+                 !IsPos(a_R) || a_NLat < 2 || a_NLon < 2     ||
+                 a_h == nullptr || !(a_scale > 0.0)))
+      throw std::invalid_argument("TerrainModel::SaveTile: Invalid Param(s)");
+
+    // Quantise the elevations around the mid-range "offset":
+    size_t const n    = size_t(a_NLat) * size_t(a_NLon);
+    auto   const mm   = std::minmax_element(a_h, a_h + n);
+    double const off  = a_scale * std::round(0.5 * (*mm.first + *mm.second)
+                                             / a_scale);
+    std::vector<int16_t> data(n);
+    double hMin =  HUGE_VAL;
+    double hMax = -HUGE_VAL;
+    for (size_t k = 0; k < n; ++k)
+    {
+      double const s = std::round((a_h[k] - off) / a_scale);
+      if (UNLIKELY(!(-32767.0 <= s && s <= 32767.0)))
+        throw std::invalid_argument
+              ("TerrainModel::SaveTile: Elevation range too large for the "
+               "scale");
+      data[k] = int16_t(s);
+      double const h = off + a_scale * s;
+      hMin = std::min(hMin, h);
+      hMax = std::max(hMax, h);
+    }
+
+    TileHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.m_magic, TileMagic, sizeof(TileMagic));
+    hdr.m_version = TileVersion;
+    hdr.m_body    = int(a_body);
+    hdr.m_NLat    = a_NLat;
+    hdr.m_NLon    = a_NLon;
+    hdr.m_phiN    =
+      0.5 * Pi<double> - double(a_i) * Pi<double> / double(a_n_tile_rows);
+    hdr.m_lambdaW = double(a_j) * 2.0 * Pi<double> / double(a_n_tile_cols);
+    hdr.m_dPhi    =
+      Pi<double> / (double(a_n_tile_rows) * double(a_NLat - 1));
+    hdr.m_dLambda =
+      2.0 * Pi<double> / (double(a_n_tile_cols) * double(a_NLon - 1));
+    hdr.m_R       = a_R.Magnitude();
+    hdr.m_scale   = a_scale;
+    hdr.m_offset  = off;
+    hdr.m_hMin    = hMin;
+    hdr.m_hMax    = hMax;
+
+    std::string const file    = TileFile(a_dir, a_i, a_j);
+    if (!CacheFile::AtomicWrite
+         (file, &hdr, sizeof(hdr), data.data(), n * sizeof(int16_t)))
+      throw std::runtime_error("TerrainModel: Cannot write " + file);
+  }
+}
+// End namespace SpaceBallistics
@@ -0,0 +1,254 @@
+// vim:ts=2:et
+//===========================================================================//
+//                         "Tests/GravFieldBench.cpp":                       //
+//    Micro-Benchmarks of the Gravitational Field Evaluation, per Degree     //
+//===========================================================================//
+// Times "GravAcc" for the Earth and the Moon, for the degrees 0, 2, 4, 8, ...
+// N, for the full and zonal-only fields, over several altitude bands; reports
+// ns/call, GFLOP/s and bytes/call. Options:
+//   -o File : also write the results to "File" in CSV, for tracking regress-
+//             ions (one line per configuration, see "CSVHeader" below);
+//   -t Sec  : min measurement time per configuration (default: 0.05 sec);
+//   -b Body : "Earth" or "Moon" only (default: both).
+// The FLOP and byte counts are NOMINAL, ie derived from the structure of the
+// column recursion ("ColSumsFrom") rather than measured:  29 FLOPs and one
+// (C, S) coeffs pair (16 bytes) per (l, m) term, plus ~20 FLOPs per column
+// (the sectoral term and cos/sin(m*lambda)) and ~50 FLOPs per call (the
+// angles and the final transform). Thus, GFLOP/s is mainly useful for com-
+// paring configurations and builds, not as an absolute hardware metric:
+//
+#include "SpaceBallistics/PhysForces/GravityField.hpp"
+#include "SpaceBallistics/CoOrds/Bodies.h"
+#include "SpaceBallistics/CoOrds/BodyCentricCOSes.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace SpaceBallistics;
+using namespace std;
+
+//===========================================================================//
+// Gravitational Field Coeffs:                                               //
+//===========================================================================//
+namespace SpaceBallistics
+{
+  using EGF = GravityField<Body::Earth>;
+  using MGF = GravityField<Body::Moon>;
+
+  extern template
+  EGF::SpherHarmonicCoeffs const
+  GravityField<Body::Earth>::s_coeffs[((EGF::N+1)*(EGF::N+2))/2];
+
+  extern template
+  MGF::SpherHarmonicCoeffs const
+  GravityField<Body::Moon>::s_coeffs[((MGF::N+1)*(MGF::N+2))/2];
+}
+
+namespace
+{
+  //=========================================================================//
+  // Nominal Costs (see above):                                              //
+  //=========================================================================//
+  constexpr double FLOPsPerTerm = 29.0;
+  constexpr double FLOPsPerCol  = 20.0;
+  constexpr double FLOPsPerCall = 50.0;
+  constexpr double BytesPerTerm = 16.0;
+
+  // The number of (l, m) terms for l = 2 .. n:
+  double NTerms(int a_n, bool a_zonal_only)
+  {
+    if (a_n < 2)
+      return 0.0;
+    return a_zonal_only
+           ? double(a_n - 1)
+           : double(a_n + 1) * double(a_n + 2) / 2.0 - 3.0;
+  }
+
+  char const CSVHeader[] =
+    "body,mode,degree,h_min_km,h_max_km,ns_per_call,gflops,bytes_per_call";
+
+  //=========================================================================//
+  // "Band": Altitude Band:                                                  //
+  //=========================================================================//
+  struct Band
+  {
+    double m_hMin;   // km
+    double m_hMax;   // km
+  };
+
+  //=========================================================================//
+  // "RunBody":                                                              //
+  //=========================================================================//
+  // Returns the checksum of all accelerations computed (which also prevents
+  // the compiler from optimising the evaluations away):
+  //
+  template<Body BodyName>
+  double RunBody
+  (
+    char const*        a_name,
+    Band const       (&a_bands)[3],
+    double             a_min_time,
+    ofstream*          a_csv
+  )
+  {
+    using GF = GravityField<BodyName>;
+    GF& gf = GF::ThisThread();
+
+    // The degrees: 0, then powers of 2, then N:
+    vector<int> degs { 0 };
+    for (int n = 2; n < gf.MaxDeg(); n *= 2)
+      degs.push_back(n);
+    degs.push_back(gf.MaxDeg());
+
+    // Random positions in each band (uniform on the sphere), the same for all
+    // degrees:
+    constexpr int      NP = 256;
+    mt19937_64         gen(20240917);
+    uniform_real_distribution<double> u01(0.0, 1.0);
+    double             sum = 0.0;
+
+    for (Band const& band: a_bands)
+    {
+      vector<PosVRot<BodyName>> pos(NP);
+      for (PosVRot<BodyName>& p: pos)
+      {
+        Len    const r =
+          gf.GetRe() +
+          To_Len(Len_km(band.m_hMin + (band.m_hMax - band.m_hMin) * u01(gen)));
+        double const z      = 2.0 * u01(gen) - 1.0;
+        double const rxy    = sqrt(1.0 - z * z);
+        double const lambda = 2.0 * Pi<double> * u01(gen);
+        p = {{ r * (rxy * cos(lambda)), r * (rxy * sin(lambda)), r * z }};
+      }
+
+      for (int zo = 0; zo < 2; ++zo)
+      for (int n: degs)
+      {
+        bool const zonal = (zo == 1);
+        if (zonal && n == 0)
+          continue;      // Same as the full field
+
+        // Find the number of sweeps over "pos" which takes at least "a_min_
+        // time", then take the best of 3 measurements:
+        double bestNS = HUGE_VAL;
+        long   nSweeps = 1;
+        for (int rep = 0; rep < 3; )
+        {
+          auto const t0 = chrono::steady_clock::now();
+          for (long s = 0; s < nSweeps; ++s)
+          for (PosVRot<BodyName> const& p: pos)
+          {
+            AccVRot<BodyName> acc {{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+            gf(0.0_sec, p, &acc, n, zonal);
+            sum += acc[0].Magnitude();
+          }
+          double const dt =
+            chrono::duration<double>(chrono::steady_clock::now() - t0)
+            .count();
+          if (dt < a_min_time)
+          {
+            nSweeps *= 2;
+            continue;
+          }
+          bestNS = min(bestNS, 1e9 * dt / (double(nSweeps) * NP));
+          ++rep;
+        }
+
+        double const terms  = NTerms(n, zonal);
+        double const cols   = (n < 2) ? 0.0 : zonal ? 1.0 : double(n + 1);
+        double const flops  =
+          FLOPsPerTerm * terms + FLOPsPerCol * cols + FLOPsPerCall;
+        double const bytes  = BytesPerTerm * terms;
+        double const gflops = flops / bestNS;
+
+        char line[256];
+        snprintf(line, sizeof(line), "%-6s %-6s %4d %8.0f %8.0f %12.1f "
+                 "%8.3f %12.0f", a_name, zonal ? "zonal" : "full", n,
+                 band.m_hMin, band.m_hMax, bestNS, gflops, bytes);
+        cout << line << endl;
+
+        if (a_csv != nullptr)
+          *a_csv << a_name << ',' << (zonal ? "zonal" : "full") << ',' << n
+                 << ',' << band.m_hMin << ',' << band.m_hMax << ',' << bestNS
+                 << ',' << gflops  << ',' << bytes << '\n';
+      }
+    }
+    return sum;
+  }
+}
+
+//===========================================================================//
+// "main":                                                                   //
+//===========================================================================//
+int main(int argc, char* argv[])
+{
+  string csvFile;
+  double minTime = 0.05;
+  string body;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (i + 1 < argc && strcmp(argv[i], "-o") == 0)
+      csvFile = argv[++i];
+    else
+    if (i + 1 < argc && strcmp(argv[i], "-t") == 0)
+      minTime = atof(argv[++i]);
+    else
+    if (i + 1 < argc && strcmp(argv[i], "-b") == 0)
+      body    = argv[++i];
+    else
+    {
+      cerr << "USAGE: " << argv[0] << " [-o CSVFile] [-t MinTimeSec] "
+              "[-b Earth|Moon]" << endl;
+      return 1;
+    }
+  }
+  if (!(minTime > 0.0) || (!body.empty() && body != "Earth" && body != "Moon"))
+  {
+    cerr << "ERROR: Invalid option(s)" << endl;
+    return 1;
+  }
+
+  ofstream csv;
+  if (!csvFile.empty())
+  {
+    csv.open(csvFile);
+    if (!csv)
+    {
+      cerr << "ERROR: Cannot create " << csvFile << endl;
+      return 1;
+    }
+    csv.precision(6);
+    csv << CSVHeader << '\n';
+  }
+  ofstream* csvp = csvFile.empty() ? nullptr : &csv;
+
+  cout << "# Body   Mode   Deg  hMin,km  hMax,km      ns/call  GFLOP/s "
+          "  bytes/call" << endl;
+
+  // Altitude bands: LEO, high LEO / low MEO, MEO for the Earth; low, medium
+  // and high lunar orbits for the Moon:
+  constexpr Band EarthBands[3] { {200.0, 600.0}, {600.0, 2000.0},
+                                 {2000.0, 20000.0} };
+  constexpr Band MoonBands [3] { {10.0, 100.0},  {100.0, 1000.0},
+                                 {1000.0, 10000.0} };
+  double sum = 0.0;
+  if (body.empty() || body == "Earth")
+    sum += RunBody<Body::Earth>("Earth", EarthBands, minTime, csvp);
+  if (body.empty() || body == "Moon")
+    sum += RunBody<Body::Moon> ("Moon",  MoonBands,  minTime, csvp);
+
+  cout << "# CheckSum = " << sum << endl;
+  if (csvp != nullptr && !csv)
+  {
+    cerr << "ERROR: Cannot write " << csvFile << endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,779 @@
+// vim:ts=2:et
+//===========================================================================//
+//                         "Tests/GravFieldTest.cpp":                        //
+//       Consistency of the Gravitational Field Evaluation Algorithms        //
+//===========================================================================//
+#include "SpaceBallistics/PhysForces/GravityField.hpp"
+#include "SpaceBallistics/PhysForces/GravityModel.h"
+#include "SpaceBallistics/PhysForces/GravityGrid.h"
+#include "SpaceBallistics/PhysForces/GravityMap.h"
+#include "SpaceBallistics/PhysForces/MultiRateGravity.hpp"
+#include "SpaceBallistics/CoOrds/Bodies.h"
+#include "SpaceBallistics/CoOrds/BodyCentricCOSes.h"
+#include "SpaceBallistics/ThreadPool.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <unistd.h>
+
+using namespace SpaceBallistics;
+using namespace std;
+
+//===========================================================================//
+// Lunar Gravitational Field Coeffs:                                         //
+//===========================================================================//
+namespace SpaceBallistics
+{
+  using MGF = GravityField<Body::Moon>;
+
+  extern template
+  MGF::SpherHarmonicCoeffs const
+  GravityField<Body::Moon>::s_coeffs[((MGF::N+1)*(MGF::N+2))/2];
+}
+
+namespace
+{
+  //=========================================================================//
+  // "Check": Reports a Failed Check:                                        //
+  //=========================================================================//
+  // Returns "a_cond", so the results can be accumulated as
+  //   ok = Check(...) && ok;
+  //
+  bool Check(bool a_cond, char const* a_what)
+  {
+    if (!a_cond)
+      cerr << "ERROR: " << a_what << endl;
+    return a_cond;
+  }
+
+  //=========================================================================//
+  // Synthetic High-Degree Coeffs (for the Extended-Range Test):             //
+  //=========================================================================//
+  // Deterministic pseudo-random values of the magnitude ~1e-6:
+  //
+  void XCoeffs(int a_l, int a_m, double* a_C, double* a_S)
+  {
+    *a_C = 1e-6 * sin(12.9898 * double(a_l) + 78.233 * double(a_m));
+    *a_S = 1e-6 * cos(39.3467 * double(a_l) + 11.135 * double(a_m));
+  }
+
+  //=========================================================================//
+  // "RefColSums": Reference Column Sums in "long double":                   //
+  //=========================================================================//
+  // Same quantities as "GravityField::ColSums" (for the "XCoeffs"), computed
+  // by the textbook recursions for the fully-normalised Legendre functions in
+  // "long double", where the sectoral terms of degrees up to several thousand
+  // do not underflow. Also returns the scale of the column (the sum of the
+  // abs values of all terms) in "a_scale", and the sectoral term itself in
+  // "a_Qmm":
+  //
+  void RefColSums
+  (
+    int          a_m,
+    int          a_n,
+    double       a_t,
+    double       a_u,
+    double       a_ir,
+    long double  a_ab[6],
+    long double* a_scale,
+    long double* a_Qmm
+  )
+  {
+    long double const t  = a_t;
+    long double const ir = a_ir;
+    long double const iu = ir * a_u;
+    int         const m  = a_m;
+
+    // (Re/r)^m * P(m,m):
+    long double Q = 1.0L;
+    for (int k = 1; k <= m; ++k)
+      Q *= sqrtl((k == 1) ? 3.0L : (2.0L * k + 1.0L) / (2.0L * k)) * iu;
+    *a_Qmm = Q;
+
+    long double Q1 = 0.0L;       // (Re/r)^(l-1) * P(l-1,m)
+    long double Q2 = 0.0L;       // (Re/r)^(l-2) * P(l-2,m)
+    std::fill_n(a_ab, 6, 0.0L);
+    *a_scale = 0.0L;
+
+    for (int l = m; l <= a_n; ++l)
+    {
+      long double const L = l;
+      if (l > m)
+      {
+        long double const a =
+          sqrtl((2.0L*L - 1.0L) * (2.0L*L + 1.0L) / ((L - m) * (L + m)));
+        long double const b =
+          sqrtl((2.0L*L + 1.0L) * (L + m - 1.0L) * (L - m - 1.0L) /
+                ((L - m) * (L + m) * (2.0L*L - 3.0L)));
+        Q2 = Q1;
+        Q1 = Q;
+        Q  = a * t * ir * Q1 - b * ir * ir * Q2;
+      }
+      if (l < 2)
+        continue;
+
+      // u * dP/d(phi) = (1-t^2) * dP/dt:
+      long double const uDQ =
+        sqrtl((2.0L*L + 1.0L) * (L - m) * (L + m) / (2.0L*L - 1.0L))
+          * ir * Q1 - L * t * Q;
+      long double const lQ  = (L + 1.0L) * Q;
+
+      double C, S;
+      XCoeffs(l, m, &C, &S);
+      a_ab[0] += uDQ * C;
+      a_ab[1] += uDQ * S;
+      a_ab[2] += lQ  * C;
+      a_ab[3] += lQ  * S;
+      a_ab[4] += Q   * C;
+      a_ab[5] += Q   * S;
+      *a_scale +=
+        (fabsl(uDQ) + fabsl(lQ) + fabsl(Q)) * (fabs(C) + fabs(S));
+    }
+  }
+}
+
+//===========================================================================//
+// "main":                                                                   //
+//===========================================================================//
+int main()
+{
+  // Test Positions: Along a meridian, from the North to the South Pole,  at
+  // the altitude "h" (the Poles are included: the Pines formulation must be
+  // regular there, unlike the Spherical one):
+  constexpr int  NP = 19;
+  constexpr Len  h  = To_Len(50.0_km);
+  constexpr Len  r  = MGF::Re + h;
+
+  Len x[NP];
+  Len y[NP];
+  Len z[NP];
+  for (int i = 0; i < NP; ++i)
+  {
+    double phi    = Pi<double> * (0.5 - double(i) / double(NP-1));
+    double lambda = 0.3;
+    x[i]          = r * Cos(phi) * Cos(lambda);
+    y[i]          = r * Cos(phi) * Sin(lambda);
+    z[i]          = r * Sin(phi);
+  }
+
+  // Tolerances: The algebraically equivalent evaluations must agree up to the
+  // accumulated rounding errors, relative to the central acceleration "g0"
+  // (or to K/r^3 for the gradients); a failed check makes "main" return 1:
+  Acc      const g0   = MGF::K / Sqr(r);
+  Acc      const tolA = 1e-11 * g0;
+  GravGrad const tolG = 1e-7  * MGF::K / Cube(r);
+  bool           ok   = true;
+
+  // Batched Computation (Spherical formulation):
+  Acc ax[NP];
+  Acc ay[NP];
+  Acc az[NP];
+  MGF::GravAccBatch(0.0_sec, NP, x, y, z, ax, ay, az);
+
+  // The max diffs over the test positions (for "dSP" and "dSB", excluding the
+  // Poles, where the Spherical formulation is singular):
+  Acc      maxSP(0.0);
+  Acc      maxSB(0.0);
+  GravGrad maxG (0.0);
+  GravGrad maxTr(0.0);
+  Acc      maxJ (0.0);
+  Acc      maxF (0.0);
+
+  for (int i = 0; i < NP; ++i)
+  {
+    PosVRot<Body::Moon> pos {{ x[i], y[i], z[i] }};
+    AccVRot<Body::Moon> accS{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+    AccVRot<Body::Moon> accP{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+
+    MGF::GravAcc     (0.0_sec, pos, &accS);
+    MGF::GravAccPines(0.0_sec, pos, &accP);
+
+    // Acceleration, Potential and Gravity-Gradient Tensor in one pass. The
+    // tensor is verified against the central differences of "GravAccPines"
+    // (the step "dx" is small enough for the truncation error to be below
+    // the rounding one):
+    AccVRot<Body::Moon>      accG{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+    GravPot                  pot (0.0);
+    GravGradTRot<Body::Moon> grad{};
+    MGF::GravAccGrad(0.0_sec, pos, &accG, &pot, &grad);
+
+    constexpr Len dx = 1.0_m;
+    GravGrad      dG (0.0);
+    for (size_t j = 0; j < 3; ++j)
+    {
+      PosVRot<Body::Moon> posP = pos;
+      PosVRot<Body::Moon> posM = pos;
+      posP[j] += dx;
+      posM[j] -= dx;
+      AccVRot<Body::Moon> accPP{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+      AccVRot<Body::Moon> accPM{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+      MGF::GravAccPines(0.0_sec, posP, &accPP);
+      MGF::GravAccPines(0.0_sec, posM, &accPM);
+      for (size_t k = 0; k < 3; ++k)
+        dG = std::max(dG, Abs((accPP[k] - accPM[k]) / (2.0 * dx) - grad[k][j]));
+    }
+    GravGrad trace = grad[0][0] + grad[1][1] + grad[2][2];
+
+    // Low-Degree Fast Paths vs the generic ones (the closed-form zonal field
+    // is regular on the polar axis, so it is compared with the Pines one):
+    AccVRot<Body::Moon> accJ {{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+    AccVRot<Body::Moon> accZ {{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+    AccVRot<Body::Moon> accF {{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+    AccVRot<Body::Moon> acc8 {{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+    MGF::GravAccJ<6> (0.0_sec, pos, &accJ);
+    MGF::GravAccPines(0.0_sec, pos, &accZ, 6, true);
+    MGF::GravAcc<8>  (0.0_sec, pos, &accF);
+    MGF::GravAcc     (0.0_sec, pos, &acc8, 8);
+    Acc dJ(0.0);
+    Acc dF(0.0);
+    for (size_t k = 0; k < 3; ++k)
+    {
+      dJ = std::max(dJ, Abs(accJ[k] - accZ[k]));
+      dF = std::max(dF, Abs(accF[k] - acc8[k]));
+    }
+
+    // Diffs between the Spherical and Pines formulations, and between the
+    // Scalar and Batched evaluations:
+    Acc dSP = Abs(accS[0] - accP[0]) + Abs(accS[1] - accP[1]) +
+              Abs(accS[2] - accP[2]);
+    Acc dSB = Abs(accS[0] - ax[i])   + Abs(accS[1] - ay[i])   +
+              Abs(accS[2] - az[i]);
+
+    cout << "z = "        << To_Len_km(z[i])
+         << "\tPines: "   << accP[0].Magnitude() << ' '
+                          << accP[1].Magnitude() << ' '
+                          << accP[2].Magnitude()
+         << "\tdSP = "    << dSP.Magnitude()
+         << "\tdSB = "    << dSB.Magnitude()
+         << "\tU = "      << pot.Magnitude()
+         << "\tdG = "     << dG.Magnitude()
+         << "\ttrG = "    << trace.Magnitude()
+         << "\tdJ = "     << dJ.Magnitude()
+         << "\tdF = "     << dF.Magnitude() << endl;
+
+    if (0 < i && i < NP-1)
+    {
+      maxSP = std::max(maxSP, dSP);
+      maxSB = std::max(maxSB, dSB);
+    }
+    maxG  = std::max(maxG,  dG);
+    maxTr = std::max(maxTr, Abs(trace));
+    maxJ  = std::max(maxJ,  dJ);
+    maxF  = std::max(maxF,  dF);
+  }
+  ok = Check(maxSP <= tolA, "Spherical vs Pines (dSP)")          && ok;
+  ok = Check(maxSB <= tolA, "Scalar vs Batched (dSB)")           && ok;
+  ok = Check(maxG  <= tolG, "Gradient vs finite diffs (dG)")     && ok;
+  ok = Check(maxTr <= tolG, "Gradient not trace-free (trG)")     && ok;
+  ok = Check(maxJ  <= tolA, "Closed-form zonal vs Pines (dJ)")   && ok;
+  ok = Check(maxF  <= tolA, "Fixed-degree vs generic (dF)")      && ok;
+
+  //-------------------------------------------------------------------------//
+  // Normalisation of the Degree-2 Terms:                                    //
+  //-------------------------------------------------------------------------//
+  // The scalar "GravAcc" of degree 2 vs the closed-form field. With the fully-
+  // normalised (to 4*Pi) functions  P(2,0) = SqRt(5)/2 * (3u^2-1), P(2,1) =
+  // SqRt(15) * u*cos(phi), P(2,2) = SqRt(15)/2 * cos(phi)^2, the non-central
+  // potential is K*Re^2 * Q(x,y,z) / r^5, where Q is the quadratic form below.
+  // This verifies the normalisation of the m > 0 terms independently of the
+  // other evaluators (their contribution must be well above the tolerance,
+  // so that an error by a factor of SqRt(2) there would be detected):
+  //
+  {
+    double const C20 = MGF::Coeffs(2, 0).m_Clm;
+    double const C21 = MGF::Coeffs(2, 1).m_Clm;
+    double const S21 = MGF::Coeffs(2, 1).m_Slm;
+    double const C22 = MGF::Coeffs(2, 2).m_Clm;
+    double const S22 = MGF::Coeffs(2, 2).m_Slm;
+    double const qa  = 0.5 * SqRt(5.0)  * C20;
+    double const qb  =       SqRt(15.0) * C21;
+    double const qc  =       SqRt(15.0) * S21;
+    double const qd  = 0.5 * SqRt(15.0) * C22;
+    double const qe  =       SqRt(15.0) * S22;
+
+    Acc dN (0.0);
+    Acc m0N(0.0);   // The max contribution of the m > 0 terms
+    for (int i = 1; i < NP-1; ++i)
+    {
+      PosVRot<Body::Moon> pos {{ x[i], y[i], z[i] }};
+      AccVRot<Body::Moon> acc {{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+      MGF::GravAcc(0.0_sec, pos, &acc, 2);
+
+      // In units of Re:
+      double const X  = double(x[i] / MGF::Re);
+      double const Y  = double(y[i] / MGF::Re);
+      double const Z  = double(z[i] / MGF::Re);
+      double const R2 = X * X + Y * Y + Z * Z;
+      double const R  = SqRt(R2);
+      double const Q  = qa * (3.0 * Z * Z - R2) + qb * X * Z + qc * Y * Z +
+                        qd * (X * X - Y * Y)    + qe * X * Y;
+      double const dQ[3]
+      {
+        -2.0 * qa * X + qb * Z + 2.0 * qd * X + qe * Y,
+        -2.0 * qa * Y + qc * Z - 2.0 * qd * Y + qe * X,
+         4.0 * qa * Z + qb * X + qc * Y
+      };
+      // The same with the m = 0 term only:
+      double const Q0 = qa * (3.0 * Z * Z - R2);
+      double const dQ0[3] { -2.0 * qa * X, -2.0 * qa * Y, 4.0 * qa * Z };
+
+      double const P[3] { X, Y, Z };
+      Acc    const unit = MGF::K / Sqr(MGF::Re);
+      double const R5   = R2 * R2 * R;
+      for (size_t k = 0; k < 3; ++k)
+      {
+        // The central term, and the degree-2 one:
+        Acc const accC = - unit * P[k] / (R2 * R);
+        Acc const acc2 = unit * (dQ [k] / R5 - 5.0 * Q  * P[k] / (R5 * R2));
+        Acc const acc0 = unit * (dQ0[k] / R5 - 5.0 * Q0 * P[k] / (R5 * R2));
+        dN  = std::max(dN,  Abs(acc[k] - (accC + acc2)));
+        m0N = std::max(m0N, Abs(acc2 - acc0));
+      }
+    }
+    cout << "Degree 2: dN = " << dN.Magnitude() << "\tm>0 terms = "
+         << m0N.Magnitude()   << endl;
+    ok = Check(dN  <= tolA,       "Degree 2 vs closed form (dN)")    && ok;
+    ok = Check(m0N >  1e3 * tolA, "Degree 2: m > 0 terms too small") && ok;
+  }
+
+  //-------------------------------------------------------------------------//
+  // Multi-Threaded Evaluation:                                              //
+  //-------------------------------------------------------------------------//
+  // Must agree with the sequential one up to rounding errors, and be bitwise
+  // reproducible (the Poles are excluded:  the Spherical formulation is sin-
+  // gular there):
+  //
+  {
+    ThreadPool pool(4);
+    Acc        dMT(0.0);
+    bool       repro = true;
+    for (int i = 1; i < NP-1; ++i)
+    {
+      PosVRot<Body::Moon> pos {{ x[i], y[i], z[i] }};
+      AccVRot<Body::Moon> accS{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+      AccVRot<Body::Moon> acc1{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+      AccVRot<Body::Moon> acc2{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+      MGF::GravAcc  (0.0_sec, pos, &accS);
+      MGF::GravAccMT(0.0_sec, pos, &acc1, pool);
+      MGF::GravAccMT(0.0_sec, pos, &acc2, pool);
+      for (size_t k = 0; k < 3; ++k)
+        dMT = std::max(dMT, Abs(accS[k] - acc1[k]));
+      repro = repro && memcmp(&acc1, &acc2, sizeof(acc1)) == 0;
+    }
+    cout << "MultiThreaded: NThreads = " << pool.NThreads()
+         << "\tdMT = "  << dMT.Magnitude()
+         << "\tRepro = " << repro << endl;
+    ok = Check(dMT <= tolA, "MultiThreaded vs sequential (dMT)") && ok;
+    ok = Check(repro,       "MultiThreaded not reproducible")    && ok;
+  }
+
+  //-------------------------------------------------------------------------//
+  // Interpolation Grid:                                                     //
+  //-------------------------------------------------------------------------//
+  // A small grid (degree "NI") around the altitude "h";  the actual interpola-
+  // tion error must be within the guaranteed bound:
+  //
+  {
+    constexpr int NI       = 20;
+    string const  gridFile = "GravFieldTest-Moon.sbgg";
+    ThreadPool    pool;
+    MGF           gf;
+    GravityGrid<Body::Moon>::Build
+      (gf, gridFile, r - To_Len(10.0_km), r + To_Len(10.0_km), 4, 90, 180,
+       pool, NI);
+
+    GravityGrid<Body::Moon> grid(gridFile);
+    Acc dGrid(0.0);
+    for (int i = 0; i < NP; ++i)
+    {
+      PosVRot<Body::Moon> pos {{ x[i], y[i], z[i] }};
+      AccVRot<Body::Moon> accE{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+      AccVRot<Body::Moon> accI{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+      gf.Pines(0.0_sec, pos, &accE, NI);
+      bool in = grid.GravAcc(0.0_sec, pos, &accI);
+      ok = Check(in, "Grid: position out of range") && ok;
+      for (size_t k = 0; k < 3; ++k)
+        dGrid = std::max(dGrid, Abs(accE[k] - accI[k]));
+    }
+    cout << "Grid: dGrid = " << dGrid.Magnitude()
+         << "\tErrBound = "  << grid.ErrBound().Magnitude() << endl;
+    ok = Check(dGrid <= grid.ErrBound(), "Grid: dGrid > ErrBound") && ok;
+  }
+
+  //-------------------------------------------------------------------------//
+  // Global Map Synthesis:                                                   //
+  //-------------------------------------------------------------------------//
+  // The (FFT-based) map at the altitude "h" must agree with the point-wise
+  // evaluation of the full acceleration (minus the central term) at the nodes:
+  //
+  {
+    ThreadPool pool;
+    MGF        gf;
+    GravityMap map = GravityMap::Synthesise(gf, r, 18, 36, pool);
+    map.Save("GravFieldTest-Moon.sbgm");
+
+    Acc dMap(0.0);
+    for (int i = 0; i < map.NLat(); ++i)
+    for (int j = 0; j < map.NLon(); ++j)
+    {
+      double phi    = double(map.Phi   (i));
+      double lambda = double(map.Lambda(j));
+      double up[3] { Cos(phi) * Cos(lambda), Cos(phi) * Sin(lambda), Sin(phi) };
+      PosVRot<Body::Moon> pos {{ r * up[0], r * up[1], r * up[2] }};
+      AccVRot<Body::Moon> acc {{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+      gf(0.0_sec, pos, &acc);
+
+      Acc accUp = MGF::K / Sqr(r);
+      for (size_t k = 0; k < 3; ++k)
+        accUp += acc[k] * up[k];
+      dMap = std::max
+             (dMap, Abs(accUp - Acc(map(GravityMap::Fld::AccUp, i, j))));
+    }
+    cout << "Map: dMap = " << dMap.Magnitude() << endl;
+    ok = Check(dMap <= 10.0 * tolA, "Map vs point-wise (dMap)") && ok;
+  }
+
+  //-------------------------------------------------------------------------//
+  // Multi-Rate Evaluation:                                                  //
+  //-------------------------------------------------------------------------//
+  // Along the meridian densely sampled between the test positions  (steps of
+  // ~3 km), with the residual refreshed every 10 km;  the error vs the full
+  // evaluation is O(maxDist^2):
+  //
+  {
+    constexpr int NS = 100;
+    MultiRateGravity<Body::Moon> mrg;
+    Acc dMR(0.0);
+    for (int i = 0; i < NP-1; ++i)
+    for (int j = 0; j < NS;   ++j)
+    {
+      double s = double(j) / double(NS);
+      PosVRot<Body::Moon> pos
+        {{ x[i] + s * (x[i+1] - x[i]), y[i] + s * (y[i+1] - y[i]),
+           z[i] + s * (z[i+1] - z[i]) }};
+      AccVRot<Body::Moon> accE{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+      AccVRot<Body::Moon> accM{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+      MGF::GravAccPines(0.0_sec, pos, &accE);
+      mrg.GravAcc      (0.0_sec, pos, &accM);
+      for (size_t k = 0; k < 3; ++k)
+        dMR = std::max(dMR, Abs(accE[k] - accM[k]));
+    }
+    cout << "MultiRate: dMR = "  << dMR.Magnitude()
+         << "	Refreshes = "     << mrg.NRefreshes()
+         << " / " << (NP-1) * NS << endl;
+    // The extrapolation error over 10 km is a few 1e-6 of "g0" at this alti-
+    // tude; the threshold leaves a margin of ~10:
+    ok = Check(dMR <= 1e-4 * g0, "MultiRate vs full (dMR)") && ok;
+  }
+
+  //-------------------------------------------------------------------------//
+  // Mixed-Precision Evaluation:                                             //
+  //-------------------------------------------------------------------------//
+  // Both the scalar and the batched (8-lane) versions vs the "double" ones;
+  // the errors must be within the a-priori estimate:
+  //
+  {
+    MGF gf;
+    Acc mx[NP];
+    Acc my[NP];
+    Acc mz[NP];
+    gf.MixedBatch(0.0_sec, NP, x, y, z, mx, my, mz);
+
+    Acc dMix(0.0);
+    for (int i = 1; i < NP-1; ++i)
+    {
+      PosVRot<Body::Moon> pos {{ x[i], y[i], z[i] }};
+      AccVRot<Body::Moon> accM{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+      gf.Mixed(0.0_sec, pos, &accM);
+      dMix = std::max({ dMix, Abs(accM[0] - ax[i]), Abs(accM[1] - ay[i]),
+                        Abs(accM[2] - az[i]), Abs(mx[i] - ax[i]),
+                        Abs(my[i] - ay[i]),   Abs(mz[i] - az[i]) });
+    }
+    cout << "Mixed: dMix = "  << dMix.Magnitude()
+         << "\tErrEst = "     << gf.MixedErrEst(r).Magnitude() << endl;
+    ok = Check(dMix <= gf.MixedErrEst(r), "Mixed: dMix > ErrEst") && ok;
+  }
+
+  //-------------------------------------------------------------------------//
+  // Several Degrees in One Pass:                                            //
+  //-------------------------------------------------------------------------//
+  // Must agree with the separate evaluations up to rounding errors (the Poles
+  // are excluded, as above). Same for "GravAccMultiAt", where each degree is
+  // evaluated at a different position:
+  //
+  {
+    constexpr int Degs[] { 0, 20, 50, 100, 300, MGF::FullDeg };
+    constexpr int ND     = int(std::size(Degs));
+    Acc dMD(0.0);
+    Acc dMA(0.0);
+    for (int i = 1; i < NP-1; ++i)
+    {
+      PosVRot<Body::Moon> pos {{ x[i], y[i], z[i] }};
+      AccVRot<Body::Moon> accs[ND];
+      for (AccVRot<Body::Moon>& acc: accs)
+        acc.fill(Acc(0.0));
+      MGF::GravAccMulti(0.0_sec, pos, ND, Degs, accs);
+
+      for (int j = 0; j < ND; ++j)
+      {
+        AccVRot<Body::Moon> acc{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+        MGF::GravAcc(0.0_sec, pos, &acc, Degs[j]);
+        for (size_t k = 0; k < 3; ++k)
+          dMD = std::max(dMD, Abs(accs[j][k] - acc[k]));
+      }
+
+      PosVRot<Body::Moon> poss[ND];
+      for (int j = 0; j < ND; ++j)
+      {
+        int const ij = 1 + (i - 1 + j) % (NP - 2);
+        poss[j] = PosVRot<Body::Moon>{{ x[ij], y[ij], z[ij] }};
+        accs[j].fill(Acc(0.0));
+      }
+      MGF::GravAccMultiAt(0.0_sec, ND, Degs, poss, accs);
+
+      for (int j = 0; j < ND; ++j)
+      {
+        AccVRot<Body::Moon> acc{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+        MGF::GravAcc(0.0_sec, poss[j], &acc, Degs[j]);
+        for (size_t k = 0; k < 3; ++k)
+          dMA = std::max(dMA, Abs(accs[j][k] - acc[k]));
+      }
+    }
+    cout << "MultiDegree: dMD = " << dMD.Magnitude()
+         << "\tdMA = " << dMA.Magnitude() << endl;
+    ok = Check(dMD <= tolA, "MultiDegree vs separate (dMD)")         && ok;
+    ok = Check(dMA <= tolA, "MultiDegree at own positions (dMA)")    && ok;
+  }
+
+  //-------------------------------------------------------------------------//
+  // Altitude-Adaptive Truncation:                                           //
+  //-------------------------------------------------------------------------//
+  // At each altitude, "GravAccTol" must agree with the full-degree evaluation
+  // up to "tol" (plus rounding errors), and the selected degree must decrease
+  // as the altitude grows (the Poles are excluded, as above):
+  //
+  {
+    constexpr Len Hs[] { To_Len(20.0_km),  To_Len(200.0_km),
+                         To_Len(2000.0_km) };
+    Acc const     tol  = 1e-9 * g0;
+    MGF&          gf   = MGF::ThisThread();
+    int           prev = MGF::N + 1;
+    for (Len hh: Hs)
+    {
+      Len const rh = MGF::Re + hh;
+      int const n  = gf.TruncDegree(rh, tol);
+      Acc       dTol(0.0);
+      for (int i = 1; i < NP-1; ++i)
+      {
+        double const        s = double(rh / r);
+        PosVRot<Body::Moon> pos {{ s * x[i], s * y[i], s * z[i] }};
+        AccVRot<Body::Moon> accF{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+        AccVRot<Body::Moon> accT{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+        MGF::GravAcc   (0.0_sec, pos, &accF);
+        MGF::GravAccTol(0.0_sec, pos, &accT, tol);
+        for (size_t k = 0; k < 3; ++k)
+          dTol = std::max(dTol, Abs(accF[k] - accT[k]));
+      }
+      cout << "Tol: h = "  << To_Len_km(hh) << "\tn = " << n
+           << "\tdTol = "  << dTol.Magnitude()
+           << "\ttol = "   << tol.Magnitude() << endl;
+      ok = Check(dTol <= tol + tolA, "GravAccTol vs full (dTol)")     && ok;
+      ok = Check(n < prev,           "TruncDegree not decreasing")    && ok;
+      prev = n;
+    }
+  }
+
+  //-------------------------------------------------------------------------//
+  // Partials wrt the Coeffs:                                                //
+  //-------------------------------------------------------------------------//
+  // The acceleration is linear in the coeffs, so the partials times the coeffs
+  // must give the non-central acceleration (the Poles are excluded, as above):
+  //
+  {
+    ThreadPool pool(4);
+    MGF        gf;
+    int const  NE = NP - 2;
+    size_t const        np = size_t(gf.NPartials());
+    vector<double>      D (3 * size_t(NE) * np);
+    vector<Time> const  ts(size_t(NE), 0.0_sec);
+    gf.Partials(NE, ts.data(), x + 1, y + 1, z + 1, D.data(), np, pool);
+
+    Acc dPC(0.0);
+    for (int e = 0; e < NE; ++e)
+    {
+      PosVRot<Body::Moon> pos {{ x[e+1], y[e+1], z[e+1] }};
+      AccVRot<Body::Moon> acc {{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+      AccVRot<Body::Moon> acc0{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+      gf(0.0_sec, pos, &acc);
+      gf(0.0_sec, pos, &acc0, 0);
+      for (size_t k = 0; k < 3; ++k)
+      {
+        double const* Dk = D.data() + (3 * size_t(e) + k) * np;
+        double        s  = 0.0;
+        for (int m = 0; m <= MGF::N; ++m)
+        for (int l = m; l <= MGF::N; ++l)
+        {
+          size_t const          j   = 2 * size_t(MGF::CoeffIdx(l, m));
+          PackedSHCoeffs const& SHC = MGF::Coeffs(l, m);
+          s += Dk[j] * SHC.m_Clm + Dk[j+1] * SHC.m_Slm;
+        }
+        dPC = std::max(dPC, Abs(Acc(s) - (acc[k] - acc0[k])));
+      }
+    }
+    cout << "Partials: NPartials = " << np << "\tdPC = " << dPC.Magnitude()
+         << endl;
+    ok = Check(dPC <= tolA, "Partials * Coeffs vs GravAcc (dPC)") && ok;
+  }
+
+  //-------------------------------------------------------------------------//
+  // Run-Time Model:                                                         //
+  //-------------------------------------------------------------------------//
+  // Write the compiled-in coeffs up to degree "NG" into an ICGEM file, load it
+  // (twice: the 2nd time, via the "mmap"ed cache), and compare the results
+  // with those of the compiled-in model truncated at "NG" (must be identical),
+  // and also with the run-time truncation at NG/2:
+  //
+  constexpr int NG      = 60;
+  string const  gfcFile = "GravFieldTest-Moon.gfc";
+  {
+    ofstream gfc(gfcFile);
+    gfc.precision(17);
+    gfc << "product_type            gravity_field\n"
+        << "modelname               TestMoon\n"
+        << "earth_gravity_constant  " << MGF::K.Magnitude()  << '\n'
+        << "radius                  " << MGF::Re.Magnitude() << '\n'
+        << "max_degree              " << NG                  << '\n'
+        << "norm                    fully_normalized\n"
+        << "key  L  M  C  S\n"
+        << "end_of_head ==========================================\n";
+    gfc << "gfc  0  0  1.0  0.0\n";
+    for (int l = 2; l <= NG; ++l)
+    for (int m = 0; m <= l; ++m)
+    {
+      PackedSHCoeffs const& SHC = MGF::Coeffs(l, m);
+      gfc << "gfc " << l << ' ' << m << ' ' << SHC.m_Clm << ' ' << SHC.m_Slm
+          << '\n';
+    }
+  }
+  (void) remove((gfcFile + ".sbgc").c_str());
+
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    GravityModel model(gfcFile);
+    GravityField<Body::Moon> gf (model);
+    GravityField<Body::Moon> gfH(model, NG/2);
+    Acc dRT(0.0);
+    Acc dRH(0.0);
+
+    for (int i = 0; i < NP; ++i)
+    {
+      PosVRot<Body::Moon> pos {{ x[i], y[i], z[i] }};
+      AccVRot<Body::Moon> accM{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+      AccVRot<Body::Moon> accR{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+      AccVRot<Body::Moon> accH{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+      AccVRot<Body::Moon> accT{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+      MGF::GravAcc(0.0_sec, pos, &accM, NG);
+      gf          (0.0_sec, pos, &accR);
+      gfH         (0.0_sec, pos, &accH);
+      gf          (0.0_sec, pos, &accT, NG/2);
+      for (size_t k = 0; k < 3; ++k)
+      {
+        dRT = std::max(dRT, Abs(accM[k] - accR[k]));
+        dRH = std::max(dRH, Abs(accH[k] - accT[k]));
+      }
+    }
+    // The cache must have been created on the 1st pass, and used on the 2nd:
+    ok = Check(access((gfcFile + ".sbgc").c_str(), R_OK) == 0,
+               "RunTime Model: no cache file")                      && ok;
+    ok = Check(model.FromCache() == (pass == 1),
+               "RunTime Model: cache not (or unexpectedly) used")   && ok;
+
+    cout << "RunTime Model \""  << model.Name() << "\": N = " << model.N()
+         << ", Mapped = "        << model.IsMapped()
+         << ", FromCache = "     << model.FromCache()
+         << "\tdRT = "          << dRT.Magnitude()
+         << "\tdRH = "          << dRH.Magnitude() << endl;
+    ok = Check(IsZero(dRT),  "RunTime vs compiled-in model (dRT)")  && ok;
+    ok = Check(dRH <= tolA,  "RunTime truncation at NG/2 (dRH)")    && ok;
+  }
+
+  //-------------------------------------------------------------------------//
+  // Sectoral Terms in the Extended Range:                                   //
+  //-------------------------------------------------------------------------//
+  // A synthetic run-time model of degree "NX", with the non-0 coeffs in a few
+  // columns only (the others are 0 by default).  At high latitudes, the sec-
+  // toral terms of those columns (but the 1st one) underflow "double", so the
+  // column sums of "LatRowSums" are computed via "ColSumsAny" by "ColSumsX"
+  // (or skipped as negligible, see "ColGrowth"). They must agree with the
+  // "long double" reference, relative to the scale of the column:
+  //
+  constexpr int NX       = 2000;
+  constexpr int XCols[]  { 60, 100, 150, 300, 480, 1000, 1900 };
+  string const  gfcFileX = "GravFieldTest-MoonX.gfc";
+  {
+    ofstream gfc(gfcFileX);
+    gfc.precision(17);
+    gfc << "product_type            gravity_field\n"
+        << "modelname               TestMoonX\n"
+        << "earth_gravity_constant  " << MGF::K.Magnitude()  << '\n'
+        << "radius                  " << MGF::Re.Magnitude() << '\n'
+        << "max_degree              " << NX                  << '\n'
+        << "norm                    fully_normalized\n"
+        << "key  L  M  C  S\n"
+        << "end_of_head ==========================================\n";
+    gfc << "gfc  0  0  1.0  0.0\n";
+    for (int m : XCols)
+    for (int l = m; l <= NX; ++l)
+    {
+      double C, S;
+      XCoeffs(l, m, &C, &S);
+      gfc << "gfc " << l << ' ' << m << ' ' << C << ' ' << S << '\n';
+    }
+  }
+  (void) remove((gfcFileX + ".sbgc").c_str());
+  {
+    GravityModel             model(gfcFileX);
+    GravityField<Body::Moon> gf   (model);
+    Len const                rX = 1.001 * MGF::Re;
+    vector<double>           ab(6 * size_t(NX + 1));
+
+    for (double phiDeg : { 75.0, 88.0 })
+    {
+      Angle const phi(phiDeg * Pi<double> / 180.0);
+      gf.LatRowSums(phi, rX, MGF::FullDeg, ab.data());
+
+      // The same "t", "u" and "ir" as in "LatRowSums":
+      double const t  = Sin(double(phi));
+      double const u  = Cos(double(phi));
+      double const ir = double(MGF::Re / rX);
+
+      double dX   = 0.0;     // Max relative error over the columns
+      int    nExt = 0;       // Number of significant columns in the ext range
+      for (int m : XCols)
+      {
+        long double abR[6], scale, Qmm;
+        RefColSums(m, NX, t, u, ir, abR, &scale, &Qmm);
+
+        // The terms below 2^-480 may be omitted (see "ColStartX"):
+        long double const floor = 0x1p-470L;
+        for (int j = 0; j < 6; ++j)
+        {
+          long double const d = fabsl(ab[6 * size_t(m) + size_t(j)] - abR[j]);
+          dX = std::max(dX, double(d / (scale + floor)));
+        }
+        if (Qmm < 0x1p-480L && scale > 0x1p-400L)
+          ++nExt;
+      }
+      cout << "Extended Range: phi = " << phiDeg << " deg, NExt = " << nExt
+           << "\tdX = " << dX << endl;
+      ok = Check(nExt > 0,   "Extended Range: not exercised")             && ok;
+      ok = Check(dX <= 1e-12, "Extended Range vs long double (dX)")       && ok;
+    }
+  }
+  (void) remove(gfcFileX.c_str());
+  (void) remove((gfcFileX + ".sbgc").c_str());
+  return ok ? 0 : 1;
+}
@@ -5,12 +5,20 @@
 //                    in an Irregualr Gravitational Field                    //
 //===========================================================================//
 #include "SpaceBallistics/PhysForces/GravityField.hpp"
+#include "SpaceBallistics/PhysForces/MultiRateGravity.hpp"
+#include "SpaceBallistics/PhysForces/MultiDegreeGravity.hpp"
 #include "SpaceBallistics/CoOrds/Bodies.h"
 #include "SpaceBallistics/CoOrds/BodyCentricCOSes.h"
 #include "SpaceBallistics/CoOrds/Locations.h"
+#include "SpaceBallistics/ODE/RungeKutta.hpp"
+#include "SpaceBallistics/ODE/GaussJackson.hpp"
+#include "SpaceBallistics/ODE/LockStep.hpp"
+#include "SpaceBallistics/ODE/StateViews.hpp"
 #include <gsl/gsl_odeiv2.h>
 #include <gsl/gsl_errno.h>
+#include <cstring>
 #include <iostream>
+#include <vector>
 
 using namespace SpaceBallistics;
 using namespace std;
@@ -23,31 +31,53 @@ namespace
   // The dimensionality of the ODE system to be solved is 6:
   constexpr static int ODEDim = 6;
 
+  // The COS in which the motion is integrated:
+  using LOCOS = BodyCentricFixedCOS<Body::Moon>;
+
+  // With the "-p" option, the Pines formulation of the Lunar Gravity Field
+  // (which is regular on the polar axis, see "GravAccPines") is used instead
+  // of the Spherical one:
+  bool s_pines = false;
+
+  void LunarGravAcc
+  (
+    Time                       a_t,
+    PosVRot<Body::Moon> const& a_pos,
+    AccVRot<Body::Moon>*       a_acc
+  )
+  {
+    if (s_pines)
+      GravityField<Body::Moon>::GravAccPines(a_t, a_pos, a_acc);
+    else
+      GravityField<Body::Moon>::GravAcc     (a_t, a_pos, a_acc);
+  }
+
   // XXX:
   // (*) For GSL compatibility reasons, the args of this function are NOT
-  //     dimensioned; however, all internal computations use DimTypes;
+  //     dimensioned; however, they are loaded and stored as typed vectors
+  //     (see "StateViews.hpp"), and all computations use DimTypes;
   // (*) Currently, only the (quite complex)  Lunar Gravity Field is used
   //     to compute the RHS; Solar, Earth and Planetary perturbations, as
   //     well as the effects of non-inertiality of the SelenoCentricFixed
-  //     CoS, are currently OMITTED:
+  //     CoS, are currently OMITTED;
+  // (*) "a_params" is either NULL (then the full field is evaluated at each
+  //     call), or a ptr to the "MultiRateGravity" evaluator:
   //
   int ODERHS
   (
     double       a_t,
     double const a_y    [ODEDim],
     double       a_y_dot[ODEDim],
-    void*        // UNUSED
+    void*        a_params
   )
   {
     // Co-Ords and Velocity Components in the "quasi-inertial" SelenoCentric
-    // Fixed COS:
-    PosVFix<Body::Moon> posF{{Len(a_y[0]), Len(a_y[1]), Len(a_y[2])}}; // m
+    // Fixed COS (see "StateViews.hpp"):
+    PosVFix<Body::Moon> const posF = PosOf<LOCOS>(a_y);
     Time    t   (a_t);                                                 // sec
 
-    // ("UnTyped") derivatives of those Co-Ords are the corresp Velocities:
-    a_y_dot[0] = a_y[3];
-    a_y_dot[1] = a_y[4];
-    a_y_dot[2] = a_y[5];
+    // The derivatives of those Co-Ords are the corresp Velocities:
+    StoreDPos<LOCOS>(a_y_dot, VelOf<LOCOS>(a_y));
 
     // Now compute the Accelerations. To that end, we need to convert "posF"
     // into the Rotating COS, compute the accelerations there,  and  convert
@@ -77,7 +107,12 @@ namespace
     // collision with the Lunar surface; 
     try
     {
-      GravityField<Body::Moon>::GravAcc(Time(a_t), posR, &accR);
+      // NB: The "MultiRateGravity" always uses the Pines formulation:
+      auto* multiRate = static_cast<MultiRateGravity<Body::Moon>*>(a_params);
+      if (multiRate != nullptr)
+        multiRate->GravAcc(Time(a_t), posR, &accR);
+      else
+        LunarGravAcc(Time(a_t), posR, &accR);
     }
     catch (GravityField<Body::Moon>::ImpactExn const& exn)
     {
@@ -89,21 +124,180 @@ namespace
            << To_Angle_deg(exn.m_phi)    << endl;
       return GSL_EBADFUNC;
     }
-    // If OK: Convert "accR"  back into the Fixed COS:
-    AccVFix<Body::Moon> accF
-    {{
-      cosMRA * accR[0] - sinMRA * accR[1],
-      sinMRA * accR[0] + cosMRA * accR[1],
-      accR[2],
-    }};
-    // Put them back into the "UnTypes" C array:
-    a_y_dot[3] = accF[0].Magnitude();
-    a_y_dot[4] = accF[1].Magnitude();
-    a_y_dot[5] = accF[2].Magnitude();
+    // If OK: Convert "accR" back into the Fixed COS, and store it into the
+    // GSL array:
+    StoreAcc<LOCOS>
+    (
+      a_y_dot,
+      AccVFix<Body::Moon>
+      {{
+        cosMRA * accR[0] - sinMRA * accR[1],
+        sinMRA * accR[0] + cosMRA * accR[1],
+        accR[2],
+      }}
+    );
 
     // All Done!
     return 0;
   }
+
+  //=========================================================================//
+  // ODE RHS for Several Degrees at Once:                                    //
+  //=========================================================================//
+  // The state vector consists of NDegs() blocks of "ODEDim", one per degree
+  // (see "MultiDegreeGravity"); the conversions between the Fixed and Rotat-
+  // ing COSes are the same as in "ODERHS" above. "a_params" is a ptr to the
+  // "MultiDegreeGravity" evaluator:
+  //
+  int ODERHSMulti
+  (
+    double       a_t,
+    double const a_y    [],
+    double       a_y_dot[],
+    void*        a_params
+  )
+  {
+    auto* multiDeg = static_cast<MultiDegreeGravity<Body::Moon>*>(a_params);
+    assert(multiDeg != nullptr);
+    int   const nd = multiDeg->NDegs();
+
+    constexpr Time PMoon  = To_Time(27.321661_day);
+    double         MRA    = TwoPi<double> * double(Time(a_t) / PMoon);
+    double         cosMRA = Cos(MRA);
+    double         sinMRA = Sin(MRA);
+
+    size_t const                     nds = size_t(nd);
+    std::vector<PosVRot<Body::Moon>> posR(nds);
+    std::vector<AccVRot<Body::Moon>> accR
+      (nds, AccVRot<Body::Moon>{{Acc(0.0), Acc(0.0), Acc(0.0)}});
+
+    // The states and their derivatives, as typed vectors:
+    StateBatchView<LOCOS, double const> y   (a_y,     nds);
+    StateBatchView<LOCOS>               yDot(a_y_dot, nds);
+
+    for (size_t j = 0; j < nds; ++j)
+    {
+      PosVFix<Body::Moon> const posF = y.PosAt(j);
+      yDot.StoreDPos(j, y.VelAt(j));
+      posR[j] = PosVRot<Body::Moon>
+      {{
+        cosMRA * posF[0] + sinMRA * posF[1],
+        cosMRA * posF[1] - sinMRA * posF[0],
+        posF[2]
+      }};
+    }
+    try
+    {
+      multiDeg->GravAccs(Time(a_t), posR.data(), accR.data());
+    }
+    catch (GravityField<Body::Moon>::ImpactExn const& exn)
+    {
+      cout << exn.m_t.Magnitude() << "  " << To_Len_km(exn.m_h) << endl;
+      cout << "# LUNAR SURFACE IMPACT NEAR lambda = "
+           << To_Angle_deg(exn.m_lambda) << ", phi = "
+           << To_Angle_deg(exn.m_phi)    << endl;
+      return GSL_EBADFUNC;
+    }
+    for (size_t j = 0; j < nds; ++j)
+    {
+      AccVRot<Body::Moon> const& acc = accR[j];
+      yDot.StoreAcc
+      (
+        j,
+        AccVFix<Body::Moon>
+        {{
+          cosMRA * acc[0] - sinMRA * acc[1],
+          sinMRA * acc[0] + cosMRA * acc[1],
+          acc[2]
+        }}
+      );
+    }
+    return 0;
+  }
+
+  //=========================================================================//
+  // Typed ODE RHS, for the Native Integrators:                              //
+  //=========================================================================//
+  // The same model as in "ODERHS", but over the typed state in the Seleno-
+  // Centric Fixed COS; "ImpactExn" is propagated to the caller:
+  //
+  struct LunarRHS
+  {
+    void operator()
+    (
+      Time                       a_t,
+      PosVFix<Body::Moon> const& a_pos,
+      VelVFix<Body::Moon> const&,
+      AccVFix<Body::Moon>*       a_acc
+    )
+    const
+    {
+      constexpr Time PMoon  = To_Time(27.321661_day);
+      double         MRA    = TwoPi<double> * double(a_t / PMoon);
+      double         cosMRA = Cos(MRA);
+      double         sinMRA = Sin(MRA);
+
+      PosVRot<Body::Moon> posR
+      {{
+        cosMRA * a_pos[0] + sinMRA * a_pos[1],
+        cosMRA * a_pos[1] - sinMRA * a_pos[0],
+        a_pos[2]
+      }};
+      AccVRot<Body::Moon> accR {{Acc(0.0), Acc(0.0), Acc(0.0)}};
+      LunarGravAcc(a_t, posR, &accR);
+
+      (*a_acc)[0] += cosMRA * accR[0] - sinMRA * accR[1];
+      (*a_acc)[1] += sinMRA * accR[0] + cosMRA * accR[1];
+      (*a_acc)[2] += accR[2];
+    }
+  };
+
+  //=========================================================================//
+  // Typed ODE RHS for 4 Trajectories in the SIMD Lanes:                     //
+  //=========================================================================//
+  // The same model as in "LunarRHS", for the "LockStepRK" integrator: the ac-
+  // celerations in all 4 lanes are computed by a single batched call,  which
+  // streams the coeffs once for all of them:
+  //
+  struct LunarLanesRHS
+  {
+    void operator()
+    (
+      Time                  a_t,
+      LanesV<Len, 4> const& a_pos,
+      LanesV<Vel, 4> const&,
+      LanesV<Acc, 4>*       a_acc
+    )
+    const
+    {
+      constexpr Time PMoon  = To_Time(27.321661_day);
+      double         MRA    = TwoPi<double> * double(a_t / PMoon);
+      double         cosMRA = Cos(MRA);
+      double         sinMRA = Sin(MRA);
+
+      LanesV<Len, 4> posR;
+      LanesV<Acc, 4> accR;
+      for (size_t k = 0; k < 4; ++k)
+      {
+        posR[0][k] = cosMRA * a_pos[0][k] + sinMRA * a_pos[1][k];
+        posR[1][k] = cosMRA * a_pos[1][k] - sinMRA * a_pos[0][k];
+        posR[2][k] = a_pos[2][k];
+        accR[0][k] = Acc(0.0);
+        accR[1][k] = Acc(0.0);
+        accR[2][k] = Acc(0.0);
+      }
+      GravityField<Body::Moon>::GravAccBatch
+        (a_t, 4, posR[0].data(), posR[1].data(), posR[2].data(),
+         accR[0].data(), accR[1].data(), accR[2].data());
+
+      for (size_t k = 0; k < 4; ++k)
+      {
+        (*a_acc)[0][k] += cosMRA * accR[0][k] - sinMRA * accR[1][k];
+        (*a_acc)[1][k] += sinMRA * accR[0][k] + cosMRA * accR[1][k];
+        (*a_acc)[2][k] += accR[2][k];
+      }
+    }
+  };
 }
 
 //===========================================================================//
@@ -124,11 +318,53 @@ namespace SpaceBallistics
 //===========================================================================//
 // "main":                                                                   //
 //===========================================================================//
-int main()
+int main(int argc, char* argv[])
 {
+  // The command-line options (see below) may be given in any order:
+  auto hasOpt = [argc, argv](char const* a_opt) -> bool
+  {
+    for (int i = 1; i < argc; ++i)
+      if (strcmp(argv[i], a_opt) == 0)
+        return true;
+    return false;
+  };
+
+  // With the "-p" option, the Pines formulation is used (see "LunarGravAcc"):
+  s_pines = hasOpt("-p");
+
+  // With the "-m" option, the Multi-Rate Gravity is used (the field of degrees
+  // up to 20 is evaluated at each RHS call, and the higher-degree residual is
+  // refreshed after each 10 km of motion):
+  bool multiRate = hasOpt("-m");
+  MultiRateGravity<Body::Moon> MRG;
+
+  // With the "-d" option, the trajectories for the degrees 20, 50, 100, 300
+  // and N are propagated together (see "MultiDegreeGravity"),  and the devi-
+  // ations of the lower-degree ones from the full-degree one are output:
+  bool multiDeg  = hasOpt("-d");
+  constexpr int Degs[] { 20, 50, 100, 300, MGF::FullDeg };
+  MultiDegreeGravity<Body::Moon> MDG(int(std::size(Degs)), Degs);
+  int const nd = multiDeg ? MDG.NDegs() : 1;
+
+  // With the "-8" option, the native typed DOP853 integrator is used instead
+  // of GSL's RKF45 (see "RungeKutta.hpp"); with "-j", the Gauss-Jackson one
+  // (see "GaussJackson.hpp"):
+  bool native    = hasOpt("-8");
+  bool gaussJ    = hasOpt("-j");
+
+  // With the "-v" option, 4 orbits (with the initial altitudes differing by
+  // 1 km) are propagated together in the SIMD lanes by the DOP853 method
+  // (see "LockStep.hpp"), and all 4 altitudes are output:
+  bool lanes     = hasOpt("-v");
+
   // System Definition: Presumably, for an explicit itegration method, no Jacob-
-  // ian of the RHS is required. There are no params either:
-  gsl_odeiv2_system ODE { ODERHS, nullptr, ODEDim, nullptr };
+  // ian of the RHS is required. The param is the optional Multi-Rate evaluator
+  // or the Multi-Degree one:
+  gsl_odeiv2_system ODE =
+    multiDeg
+    ? gsl_odeiv2_system{ ODERHSMulti, nullptr, size_t(ODEDim * nd), &MDG }
+    : gsl_odeiv2_system
+        { ODERHS, nullptr, ODEDim, multiRate ? &MRG : nullptr };
 
   // Initial Condition:
   // We assume that at t0=0, the Fixed and Rotating COSes coincide; the Orbiter
@@ -142,12 +378,14 @@ int main()
   constexpr Len  r0     = ReMoon     + h0;
   constexpr Vel  V0     = SqRt(KMoon / r0);
 
-  // "UnTyped" initial state vector for GSL:
-  double y[ODEDim]
+  // "UnTyped" initial state vector for GSL (the same for all degrees):
+  std::vector<double> y(size_t(ODEDim * nd));
+  for (int j = 0; j < nd; ++j)
   {
-    r0.Magnitude(), 0.0, 0.0,
-    0.0, 0.0, V0.Magnitude()
-  };
+    double* yj = y.data() + ODEDim * j;
+    yj[0] = r0.Magnitude();
+    yj[5] = V0.Magnitude();
+  }
 
   // Run the RKF45 Integrator for 1 Year with 10 sec initial TimeStep:
   constexpr Time   tau     = 10.0_sec;
@@ -159,6 +397,111 @@ int main()
   // Observation Time Step:
   constexpr Time   tauObs  = 10.0 * tau;
 
+  if (native || gaussJ)
+  {
+    // The velocity tolerance corresponds to the position one over 1 rad of
+    // the orbital motion; the Gauss-Jackson step is "tau":
+    PosVFix<Body::Moon> const pos0 {{ r0,       0.0_m,    0.0_m }};
+    VelVFix<Body::Moon> const vel0 {{ Vel(0.0), Vel(0.0), V0    }};
+    Vel                 const absPrecV = AbsPrec * V0 / r0;
+
+    auto run = [&](auto& a_ode) -> void
+    {
+      for (Time t = t0; t < T; )
+      {
+        t = std::min(t + tauObs, T);
+        try
+        {
+          a_ode.Propagate(t);
+        }
+        catch (GravityField<Body::Moon>::ImpactExn const& exn)
+        {
+          cout << exn.m_t.Magnitude() << "  " << To_Len_km(exn.m_h) << endl;
+          cout << "# LUNAR SURFACE IMPACT NEAR lambda = "
+               << To_Angle_deg(exn.m_lambda) << ", phi = "
+               << To_Angle_deg(exn.m_phi)    << endl;
+          break;
+        }
+        PosVFix<Body::Moon> const& pos = a_ode.GetPos();
+        cout << t.Magnitude() << "  "
+             << To_Len_km(SqRt(Sqr(pos[0]) + Sqr(pos[1]) + Sqr(pos[2])) -
+                          ReMoon) << endl;
+      }
+    };
+
+    if (native)
+    {
+      DOP853<LOCOS, LunarRHS> ode
+        (LunarRHS{}, t0, pos0, vel0, RelPrec, AbsPrec, absPrecV, tau);
+      run(ode);
+      cout << "# DOP853: " << ode.NSteps()    << " steps, "
+           << ode.NRejected() << " rejected, " << ode.NRHSCalls()
+           << " RHS calls" << endl;
+    }
+    else
+    {
+      GaussJackson<LOCOS, LunarRHS> ode
+        (LunarRHS{}, t0, pos0, vel0, tau, RelPrec, AbsPrec, absPrecV);
+      run(ode);
+      cout << "# Gauss-Jackson: " << ode.NSteps() << " steps, "
+           << ode.NStarts()  << " starts, "  << ode.NRHSCalls()
+           << " RHS calls" << endl;
+    }
+    return 0;
+  }
+
+  if (lanes)
+  {
+    // The lanes are terminated at the altitude of 1 km (rather than by the
+    // "ImpactExn", which would stop all of them):
+    using LS = LockStepDOP853<LOCOS, LunarLanesRHS, 4, AltitudeEvent<LOCOS>>;
+    PosVFix<Body::Moon> pos0[4];
+    VelVFix<Body::Moon> vel0[4];
+    for (size_t k = 0; k < 4; ++k)
+    {
+      Len const rk = r0 + double(k) * To_Len(1.0_km);
+      pos0[k] = PosVFix<Body::Moon>{{ rk,       0.0_m,    0.0_m }};
+      vel0[k] = VelVFix<Body::Moon>
+                  {{ Vel(0.0), Vel(0.0), SqRt(KMoon / rk) }};
+    }
+    LS ode(LunarLanesRHS{}, t0, 4, pos0, vel0, RelPrec, AbsPrec,
+           AbsPrec * V0 / r0, tau, Time(0.0),
+           AltitudeEvent<LOCOS>{ ReMoon + To_Len(1.0_km) },
+           EventDir::Falling);
+
+    for (Time t = t0; t < T && ode.NLive() > 0; )
+    {
+      t = std::min(t + tauObs, T);
+      try
+      {
+        ode.Propagate(t);
+      }
+      catch (GravityField<Body::Moon>::ImpactExn const& exn)
+      {
+        cout << "# LUNAR SURFACE IMPACT AT t = " << exn.m_t.Magnitude()
+             << endl;
+        break;
+      }
+      cout << ode.GetTime().Magnitude();
+      for (int k = 0; k < 4; ++k)
+      {
+        PosVFix<Body::Moon> const pos = ode.GetPos(k);
+        cout << "  "
+             << To_Len_km(SqRt(Sqr(pos[0]) + Sqr(pos[1]) + Sqr(pos[2])) -
+                          ReMoon);
+      }
+      cout << endl;
+    }
+    for (int k = 0; k < 4; ++k)
+      if (ode.HasEvent(k))
+        cout << "# Lane " << k << ": LOW ALTITUDE AT t = "
+             << ode.GetTime(k).Magnitude() << endl;
+    cout << "# DOP853 x4: " << ode.NSteps()    << " steps, "
+         << ode.NRejected() << " rejected, " << ode.NRHSCalls()
+         << " batched RHS calls" << endl;
+    return 0;
+  }
+
   gsl_odeiv2_driver* ODEDriver =
     gsl_odeiv2_driver_alloc_y_new
       (&ODE,            gsl_odeiv2_step_rkf45,
@@ -170,17 +513,40 @@ int main()
   while (t < T.Magnitude())
   {
     double t1 =  t + tauObs.Magnitude();
-    int    rc =  gsl_odeiv2_driver_apply(ODEDriver, &t, t1, y);
+    int    rc =  gsl_odeiv2_driver_apply(ODEDriver, &t, t1, y.data());
 
     if (UNLIKELY(rc != 0))
     {
       cout << "# ERROR, exiting..." << endl;
       break;
     }
-    // Output the current Altitude:
+    // Output the current Altitude (of the full-degree trajectory):
+    double const* y0 = y.data() + ODEDim * (nd - 1);
     Len_km  h =
-      To_Len_km(Len(SqRt(Sqr(y[0]) + Sqr(y[1]) + Sqr(y[2]))) - ReMoon);
-    cout << t << "  " << h << endl;
+      To_Len_km(Len(SqRt(Sqr(y0[0]) + Sqr(y0[1]) + Sqr(y0[2]))) - ReMoon);
+    cout << t << "  " << h;
+
+    // and the deviations of the lower-degree trajectories from it:
+    for (int j = 0; j < nd - 1; ++j)
+    {
+      double const* yj = y.data() + ODEDim * j;
+      cout << "  "
+           << To_Len_km(Len(SqRt(Sqr(yj[0] - y0[0]) + Sqr(yj[1] - y0[1]) +
+                                 Sqr(yj[2] - y0[2]))));
+    }
+    cout << endl;
+  }
+
+  if (multiRate)
+    cout << "# Multi-Rate Gravity: " << MRG.NRefreshes() << " refreshes"
+         << endl;
+  if (multiDeg)
+  {
+    cout << "# Multi-Degree Gravity: Deviations from N="
+         << MDG.Degree(nd - 1) << " for N =";
+    for (int j = 0; j < nd - 1; ++j)
+      cout << ' ' << MDG.Degree(j);
+    cout << endl;
   }
 
   // De-Allocate the Driver:
@@ -0,0 +1,474 @@
+// vim:ts=2:et
+//===========================================================================//
+//                            "Tests/ODETest.cpp":                           //
+//               Native ODE Integrators on the Kepler Problem                //
+//===========================================================================//
+#include "SpaceBallistics/ODE/RungeKutta.hpp"
+#include "SpaceBallistics/ODE/Events.hpp"
+#include "SpaceBallistics/ODE/GaussJackson.hpp"
+#include "SpaceBallistics/ODE/Ensemble.hpp"
+#include "SpaceBallistics/ODE/LockStep.hpp"
+#include "SpaceBallistics/ODE/StateViews.hpp"
+#include "SpaceBallistics/CoOrds/Bodies.h"
+#include "SpaceBallistics/CoOrds/BodyCentricCOSes.h"
+#include "SpaceBallistics/PhysForces/BodyData.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace SpaceBallistics;
+using namespace std;
+
+namespace
+{
+  //=========================================================================//
+  // The Problem:                                                            //
+  //=========================================================================//
+  // An eccentric Earth orbit (e=0.5, perigee altitude ~620 km), propagated
+  // over 10 revolutions; the exact solution returns to the initial state:
+  //
+  using COS = BodyCentricFixedCOS<Body::Earth>;
+  constexpr GM     K  = BodyData<Body::Earth>::K;
+  constexpr Len    A  = To_Len(14000.0_km);
+  constexpr double E  = 0.5;
+
+  struct KeplerRHS
+  {
+    void operator()
+    (
+      Time,
+      PosV<COS> const& a_r,
+      VelV<COS> const&,
+      AccV<COS>*       a_acc
+    )
+    const
+    {
+      Len const r = SqRt(Sqr(a_r[0]) + Sqr(a_r[1]) + Sqr(a_r[2]));
+      auto const f = K / Cube(r);
+      for (size_t i = 0; i < 3; ++i)
+        (*a_acc)[i] -= f * a_r[i];
+    }
+  };
+
+  // The same, for "NL" trajectories in the lanes (see "LockStep.hpp"):
+  template<int NL>
+  struct KeplerLanesRHS
+  {
+    void operator()
+    (
+      Time,
+      LanesV<Len, NL> const& a_r,
+      LanesV<Vel, NL> const&,
+      LanesV<Acc, NL>*       a_acc
+    )
+    const
+    {
+      for (size_t k = 0; k < size_t(NL); ++k)
+      {
+        Len const r =
+          SqRt(Sqr(a_r[0][k]) + Sqr(a_r[1][k]) + Sqr(a_r[2][k]));
+        auto const f = K / Cube(r);
+        for (size_t i = 0; i < 3; ++i)
+          (*a_acc)[i][k] -= f * a_r[i][k];
+      }
+    }
+  };
+
+  // For the ensembles: the force model settings are the scale of "K" and the
+  // surface radius, below which "SurfaceExn" is thrown (like "ImpactExn" of
+  // "GravityField"):
+  struct SurfaceExn {};
+
+  struct ModelRHS
+  {
+    double m_KScale;
+    Len    m_Rs;
+
+    void operator()
+    (
+      Time,
+      PosV<COS> const& a_r,
+      VelV<COS> const&,
+      AccV<COS>*       a_acc
+    )
+    const
+    {
+      Len const r = SqRt(Sqr(a_r[0]) + Sqr(a_r[1]) + Sqr(a_r[2]));
+      if (r < m_Rs)
+        throw SurfaceExn{};
+      auto const f = m_KScale * K / Cube(r);
+      for (size_t i = 0; i < 3; ++i)
+        (*a_acc)[i] -= f * a_r[i];
+    }
+  };
+
+  //=========================================================================//
+  // "Run":                                                                  //
+  //=========================================================================//
+  // Returns the final position error:
+  //
+  template<RKMethod Method>
+  Len Run(char const* a_name, double a_rel_tol)
+  {
+    Len  const rp = A * (1.0 - E);
+    Vel  const vp = SqRt(K / A * (1.0 + E) / (1.0 - E));
+    Time const P  = TwoPi<double> * SqRt(Cube(A) / K);
+
+    PosV<COS> const r0 {{ rp,       0.0_m, 0.0_m    }};
+    VelV<COS> const v0 {{ Vel(0.0), vp,    Vel(0.0) }};
+
+    RKIntegrator<Method, COS, KeplerRHS> ode
+      (KeplerRHS{}, 0.0_sec, r0, v0,
+       a_rel_tol, a_rel_tol * To_Len(1000.0_km), a_rel_tol * Vel(1000.0));
+    ode.Propagate(10.0 * P);
+
+    PosV<COS> const& r   = ode.GetPos();
+    Len       const  err =
+      SqRt(Sqr(r[0] - r0[0]) + Sqr(r[1] - r0[1]) + Sqr(r[2] - r0[2]));
+    cout << a_name << ": RelTol = " << a_rel_tol << ", Err = "
+         << err.Magnitude() << " m, Steps = " << ode.NSteps()
+         << ", Rejected = "   << ode.NRejected() << ", RHS Calls = "
+         << ode.NRHSCalls() << endl;
+    return err;
+  }
+
+  //=========================================================================//
+  // "RunGJ":                                                                //
+  //=========================================================================//
+  // The same problem, by the Gauss-Jackson method with 1000 steps per rev;
+  // must be more accurate than DOP853 at RelTol=1e-13, with ~1 RHS call per
+  // step. Then back to the initial state, with the output times off the
+  // grid:
+  //
+  bool RunGJ()
+  {
+    Len  const rp = A * (1.0 - E);
+    Vel  const vp = SqRt(K / A * (1.0 + E) / (1.0 - E));
+    Time const P  = TwoPi<double> * SqRt(Cube(A) / K);
+
+    PosV<COS> const r0 {{ rp,       0.0_m, 0.0_m    }};
+    VelV<COS> const v0 {{ Vel(0.0), vp,    Vel(0.0) }};
+
+    GaussJackson<COS, KeplerRHS> gj
+      (KeplerRHS{}, 0.0_sec, r0, v0, P / 1000.0, 1e-13, Len(1e-6), Vel(1e-9));
+    gj.Propagate(10.0 * P);
+
+    PosV<COS> const& r   = gj.GetPos();
+    Len       const  err =
+      SqRt(Sqr(r[0] - r0[0]) + Sqr(r[1] - r0[1]) + Sqr(r[2] - r0[2]));
+    double    const  rps = double(gj.NRHSCalls()) / double(gj.NSteps());
+    cout << "GJ8   : Err = " << err.Magnitude() << " m, Steps = "
+         << gj.NSteps() << ", Starts = " << gj.NStarts() << ", RHS Calls = "
+         << gj.NRHSCalls() << endl;
+    if (gj.GetTime() != 10.0 * P || !(err < Len(1e-3)) || !(rps < 1.1))
+      return false;
+
+    for (int k = 69; k >= 0; --k)
+      gj.Propagate(double(k) / 7.0 * P);
+    Len const errB =
+      SqRt(Sqr(r[0] - r0[0]) + Sqr(r[1] - r0[1]) + Sqr(r[2] - r0[2]));
+    cout << "GJ8   : Backwards: Err = " << errB.Magnitude() << " m, Starts = "
+         << gj.NStarts() << endl;
+    return gj.GetTime() == 0.0_sec && errB < Len(1e-3) && gj.NStarts() == 2;
+  }
+
+  //=========================================================================//
+  // "RunEnsemble":                                                          //
+  //=========================================================================//
+  // 500 trajectories with the perigee radii from 5000 to 9000 km (so some of
+  // them hit the surface at 6378 km) and wildly varying lengths, over 4 thr-
+  // eads; the results must be identical to those of the sequential propaga-
+  // tion:
+  //
+  bool RunEnsemble()
+  {
+    using Ens = Ensemble<COS, ModelRHS>;
+    Len  const Rs = To_Len(6378.0_km);
+    Time const P  = TwoPi<double> * SqRt(Cube(A) / K);
+
+    std::vector<Ens::Case> cases;
+    for (int i = 0; i < 500; ++i)
+    {
+      double const x  = double(i) / 499.0;
+      Len    const rp = To_Len(5000.0_km) + x * To_Len(4000.0_km);
+      Len    const ra = 2.0 * A - rp;
+      Vel    const vp = SqRt(2.0 * K * ra / (rp * (rp + ra)));
+      cases.push_back
+        (Ens::Case{ 0.0_sec,
+                    PosV<COS>{{ Len(0.0), rp,      Len(0.0) }},
+                    VelV<COS>{{ -vp,      Vel(0.0), Vel(0.0) }},
+                    (0.01 + 3.0 * double((i * 37) % 101) / 100.0) * P,
+                    ModelRHS{ 1.0 + 1e-3 * double(i % 3), Rs } });
+    }
+
+    ThreadPool                   pool(4);
+    Ens                          ens (pool, 1e-10, Len(1e-3), Vel(1e-6));
+    EnsembleCollector<COS>       coll(pool);
+    ens.Run(cases, coll);
+    std::vector<Ens::Result> const res = coll.Results();
+
+    int  nImpacts = 0;
+    bool ok       = (res.size() == cases.size());
+    for (size_t i = 0; ok && i < res.size(); ++i)
+    {
+      Ens::Case const& c = cases[i];
+      RKIntegrator<RKMethod::DOP853, COS, ModelRHS> ode
+        (c.m_rhs, c.m_t0, c.m_r0, c.m_v0, 1e-10, Len(1e-3), Vel(1e-6));
+      bool impact = false;
+      try
+      {
+        ode.Propagate(c.m_tEnd);
+      }
+      catch (SurfaceExn const&)
+      {
+        impact = true;
+      }
+      nImpacts += impact;
+      ok = res[i].m_index   == i                                  &&
+           res[i].m_outcome ==
+             (impact ? EnsembleOutcome::Exception
+                     : EnsembleOutcome::Completed)                &&
+           res[i].m_t       == ode.GetTime()                      &&
+           res[i].m_r       == ode.GetPos()                       &&
+           res[i].m_v       == ode.GetVel()                       &&
+           res[i].m_nRHS    == ode.NRHSCalls();
+    }
+    cout << "Ensemble: " << res.size() << " trajectories, " << nImpacts
+         << " impacts: " << (ok ? "OK" : "FAILED") << endl;
+    return ok && nImpacts > 0 && nImpacts < int(res.size());
+  }
+
+  //=========================================================================//
+  // "RunLockStep":                                                          //
+  //=========================================================================//
+  // 8 orbits with the same period (so they all return to the initial states
+  // after 10 revs) but different eccentricities and orientations, in 8 lanes
+  // with the shared adaptive step; the errors must be as for the single-traj-
+  // ectory DOP853 at the same tolerance. With a fixed step, the result of a
+  // trajectory must not depend on the others in its group.  Then 2 radial
+  // free falls onto the sphere of radius Re (as in "RunEvents") and 1 orbit
+  // in 3 of 4 lanes, with the impacts as the terminal events:
+  //
+  bool RunLockStep()
+  {
+    constexpr int NL = 8;
+    using LS = LockStepDOP853<COS, KeplerLanesRHS<NL>, NL>;
+    Time const P = TwoPi<double> * SqRt(Cube(A) / K);
+
+    PosV<COS> r0[NL];
+    VelV<COS> v0[NL];
+    for (int k = 0; k < NL; ++k)
+    {
+      double const e  = 0.1 + 0.4 * double(k) / double(NL - 1);
+      double const w  = 0.4 * double(k);
+      Len    const rp = A * (1.0 - e);
+      Vel    const vp = SqRt(K / A * (1.0 + e) / (1.0 - e));
+      size_t const i  = size_t(k);
+      // The velocity is perpendicular to "r0", so "r0" is the periapsis; the
+      // inclination is 60 deg:
+      r0[i] = PosV<COS>{{ rp * std::cos(w), rp * std::sin(w), 0.0_m }};
+      v0[i] = VelV<COS>{{ -0.5 * vp * std::sin(w), 0.5 * vp * std::cos(w),
+                          std::sqrt(0.75) * vp }};
+    }
+    LS ls(KeplerLanesRHS<NL>{}, 0.0_sec, NL, r0, v0, 1e-10, Len(1e-3),
+          Vel(1e-6));
+    ls.Propagate(10.0 * P);
+
+    Len maxErr(0.0);
+    for (int k = 0; k < NL; ++k)
+    {
+      PosV<COS> const r = ls.GetPos(k);
+      PosV<COS> const& q = r0[size_t(k)];
+      maxErr = std::max(maxErr, SqRt(Sqr(r[0] - q[0]) + Sqr(r[1] - q[1]) +
+                                     Sqr(r[2] - q[2])));
+    }
+    cout << "LockStep: " << NL << " lanes: MaxErr = " << maxErr.Magnitude()
+         << " m, Steps = " << ls.NSteps() << ", RHS Calls = "
+         << ls.NRHSCalls() << endl;
+    bool ok = ls.GetTime() == 10.0 * P && ls.NLive() == NL &&
+              maxErr < 1e-10 * To_Len(1e8_km);
+
+    // Fixed steps: the trajectory 0 in 2 different groups:
+    LS ls1(KeplerLanesRHS<NL>{}, 0.0_sec, 3, r0, v0, 1e-10, Len(1e-3),
+           Vel(1e-6));
+    ls.Reset(0.0_sec, NL, r0, v0);
+    ls. SetFixedStep(P / 2000.0);
+    ls1.SetFixedStep(P / 2000.0);
+    ls. Propagate(P);
+    ls1.Propagate(P);
+    ok = ok && ls1.NLanes() == 3 && ls.GetPos(0) == ls1.GetPos(0) &&
+         ls.GetVel(0) == ls1.GetVel(0) && ls1.NSteps() == 2000;
+
+    // Impacts:
+    using LSE =
+      LockStepDOP853<COS, KeplerLanesRHS<4>, 4, AltitudeEvent<COS>>;
+    Len  const R = To_Len(6378.0_km);
+    Time tI[2];
+    PosV<COS> r1[3];
+    VelV<COS> v1[3];
+    for (size_t k = 0; k < 2; ++k)
+    {
+      Len    const rs = double(k + 2) * R;
+      double const x  = double(R / rs);
+      tI[k] = SqRt(Cube(rs) / (2.0 * K)) *
+              (std::sqrt(x * (1.0 - x)) + std::acos(std::sqrt(x)));
+      r1[k] = PosV<COS>{{ Len(0.0), Len(0.0), rs }};
+      v1[k] = VelV<COS>{{ Vel(0.0), Vel(0.0), Vel(0.0) }};
+    }
+    r1[2] = r0[0];
+    v1[2] = v0[0];
+    LSE lse(KeplerLanesRHS<4>{}, 0.0_sec, 3, r1, v1, 1e-12, Len(1e-3),
+            Vel(1e-6), Time(0.0), Time(0.0), AltitudeEvent<COS>{R},
+            EventDir::Falling);
+    lse.Propagate(P);
+
+    Time const tErr = std::max(Abs(lse.GetTime(0) - tI[0]),
+                               Abs(lse.GetTime(1) - tI[1]));
+    Len  const hErr = std::max(Abs(lse.GetPos(0)[2] - R),
+                               Abs(lse.GetPos(1)[2] - R));
+    cout << "LockStep: Events: MaxTimeErr = " << tErr.Magnitude()
+         << " sec, ImpactPosErr = " << hErr.Magnitude() << " m" << endl;
+    return ok && lse.HasEvent(0) && lse.HasEvent(1) && !lse.HasEvent(2) &&
+           lse.NLive() == 1 && lse.GetTime() == P && lse.GetTime(2) == P &&
+           tErr < Time(1e-3) && hErr < Len(1e-2);
+  }
+
+  //=========================================================================//
+  // "RunEvents":                                                            //
+  //=========================================================================//
+  // The same orbit, inclined by 30 deg; the line of nodes is the line of
+  // apsides, so the apsides and the nodes are both at the multiples of P/2.
+  // Then a radial free fall onto the sphere of radius Re, with the analytic
+  // impact time. The events are located on the dense output, with the refine-
+  // ment by "StopAt" if "a_refine" is set (which only matters for RKF78, as
+  // DOP853 has its own dense output of the order 7). Returns "true" iff all
+  // event times are within 1 msec, and the impact position is accurate:
+  //
+  template<RKMethod Method>
+  bool RunEvents(char const* a_name, bool a_refine)
+  {
+    Len  const rp = A * (1.0 - E);
+    Vel  const vp = SqRt(K / A * (1.0 + E) / (1.0 - E));
+    Time const P  = TwoPi<double> * SqRt(Cube(A) / K);
+    double const ci = std::cos(Pi<double> / 6.0);
+    double const si = std::sin(Pi<double> / 6.0);
+
+    PosV<COS> const r0 {{ rp,       0.0_m,   0.0_m   }};
+    VelV<COS> const v0 {{ Vel(0.0), ci * vp, si * vp }};
+
+    RKIntegrator<Method, COS, KeplerRHS> ode
+      (KeplerRHS{}, 0.0_sec, r0, v0, 1e-12, Len(1e-3), Vel(1e-6));
+
+    // The apsides (the initial periapsis is ignored):
+    Time maxErr(0.0);
+    Time te(0.0);
+    for (int k = 1; k <= 6; ++k)
+    {
+      if (!PropagateToEvent
+          (&ode, 4.0 * P, RadialVelEvent<COS>{}, EventDir::Any, &te,
+           a_refine))
+        return false;
+      maxErr = std::max(maxErr, Abs(te - (0.5 * double(k)) * P));
+    }
+    // The ascending node at 4P (the one at 3P is the current position):
+    if (!PropagateToEvent
+        (&ode, 5.0 * P, NodeEvent<COS>{}, EventDir::Rising, &te, a_refine) ||
+        ode.GetTime() != te)
+      return false;
+    maxErr = std::max(maxErr, Abs(te - 4.0 * P));
+
+    // Radial free fall from r1 = 2*Re with zero velocity:
+    Len    const R  = To_Len(6378.0_km);
+    Len    const r1 = 2.0 * R;
+    double const x  = double(R / r1);
+    Time   const tI = SqRt(Cube(r1) / (2.0 * K)) *
+                      (std::sqrt(x * (1.0 - x)) + std::acos(std::sqrt(x)));
+    ode.Reset(0.0_sec, PosV<COS>{{ r1, 0.0_m, 0.0_m }},
+              VelV<COS>{{ Vel(0.0), Vel(0.0), Vel(0.0) }});
+    if (!PropagateToEvent
+        (&ode, 2.0 * tI, AltitudeEvent<COS>{R}, EventDir::Falling, &te,
+         a_refine))
+      return false;
+    Len const hErr = Abs(ode.GetPos()[0] - R);
+    maxErr = std::max(maxErr, Abs(te - tI));
+
+    cout << a_name << ": Events (" << (a_refine ? "Refined" : "Dense  ")
+         << "): MaxTimeErr = "       << maxErr.Magnitude()
+         << " sec, ImpactPosErr = " << hErr.Magnitude() << " m" << endl;
+    // The impact position error is the impact speed (~8 km/sec) times the
+    // event time error, which is larger for the Hermite dense output:
+    bool const accurate = a_refine || RKTableau<Method>::Dense;
+    return maxErr < Time(1e-3) && hErr < Len(accurate ? 1e-2 : 0.5);
+  }
+}
+
+//===========================================================================//
+// "main":                                                                   //
+//===========================================================================//
+int main()
+{
+  // The errors must decrease with the tolerance (roughly proportionally, as
+  // the global error is dominated by the accumulated local ones):
+  bool ok = true;
+  for (double relTol: { 1e-7, 1e-10, 1e-13 })
+  {
+    Len const errD = Run<RKMethod::DOP853>("DOP853", relTol);
+    Len const errF = Run<RKMethod::RKF78> ("RKF78 ", relTol);
+    Len const maxErr = relTol * To_Len(1e8_km);
+    ok = ok && errD < maxErr && errF < maxErr;
+  }
+  if (!ok)
+  {
+    cerr << "ERROR: Integration error too large" << endl;
+    return 1;
+  }
+
+  // Gauss-Jackson:
+  if (!RunGJ())
+  {
+    cerr << "ERROR: Gauss-Jackson integration failed" << endl;
+    return 1;
+  }
+
+  // Events located on the dense output:
+  if (!RunEvents<RKMethod::DOP853>("DOP853", false) ||
+      !RunEvents<RKMethod::RKF78> ("RKF78 ", false) ||
+      !RunEvents<RKMethod::DOP853>("DOP853", true)  ||
+      !RunEvents<RKMethod::RKF78> ("RKF78 ", true))
+  {
+    cerr << "ERROR: Events not found or inaccurate" << endl;
+    return 1;
+  }
+
+  // Ensembles:
+  if (!RunEnsemble())
+  {
+    cerr << "ERROR: Ensemble results differ from the sequential ones" << endl;
+    return 1;
+  }
+
+  // Lock-step propagation in the lanes:
+  if (!RunLockStep())
+  {
+    cerr << "ERROR: Lock-step propagation failed" << endl;
+    return 1;
+  }
+
+  // Typed Views: A batch of 2 states with a padded stride; the stores via
+  // the typed views must go to the right places of the flat array, and the
+  // loads must see the current contents of the flat array:
+  double y[14] {};
+  StateBatchView<COS>               bv (y, 2, 7);
+  StateBatchView<COS, double const> bvc(y, 2, 7);
+  bv.StorePos(1, PosV<COS>{{ 1.0_m,    2.0_m,    3.0_m    }});
+  bv.StoreVel(1, VelV<COS>{{ Vel(4.0), Vel(0.0), Vel(0.0) }});
+  bv.StoreAcc(0, AccV<COS>{{ Acc(0.0), Acc(5.0), Acc(0.0) }});
+  y[0] = 6.0;
+  ok = y[7]  == 1.0   && y[9] == 3.0 && y[10] == 4.0 && y[4] == 5.0 &&
+       bvc.PosAt(1)[2] == 3.0_m    && bvc.PosAt(0)[0] == 6.0_m     &&
+       bvc.VelAt(1)[0] == Vel(4.0) && bvc.AccAt(0)[1] == Acc(5.0)  &&
+       PosOf<COS>(y + 7) == bv.PosAt(1) && bvc.Raw(1) == y + 7;
+  cout << "StateViews: " << (ok ? "OK" : "FAILED") << endl;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,306 @@
+// vim:ts=2:et
+//===========================================================================//
+//                          "Tests/TerrainTest.cpp":                         //
+//         Tiled Digital Elevation Models and Terrain-Aware Impacts          //
+//===========================================================================//
+#include "SpaceBallistics/PhysForces/TerrainModel.h"
+#include "SpaceBallistics/PhysForces/BodyData.hpp"
+#include "SpaceBallistics/PhysForces/GravityField.hpp"
+#include "SpaceBallistics/CoOrds/Bodies.h"
+#include "SpaceBallistics/CoOrds/BodyCentricCOSes.h"
+#include "SpaceBallistics/ODE/Events.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace SpaceBallistics;
+using namespace std;
+
+//===========================================================================//
+// Lunar Gravitational Field Coeffs:                                         //
+//===========================================================================//
+namespace SpaceBallistics
+{
+  using MGF = GravityField<Body::Moon>;
+
+  extern template
+  MGF::SpherHarmonicCoeffs const
+  GravityField<Body::Moon>::s_coeffs[((MGF::N+1)*(MGF::N+2))/2];
+}
+
+namespace
+{
+  // The synthetic terrain: linear in (phi, lambda), so the bilinear interpo-
+  // lation must reproduce it up to the quantisation errors:
+  double H(double a_phi, double a_lambda)
+    { return 1000.0 * a_phi + 500.0 * a_lambda - 800.0; }
+
+  // Central-Body gravity in the Fixed COS (the Body is only needed for the
+  // terrain look-ups here):
+  using FCOS = BodyCentricFixedCOS<Body::Moon>;
+
+  struct CentralRHS
+  {
+    void operator()
+    (
+      Time,
+      PosV<FCOS> const& a_r,
+      VelV<FCOS> const&,
+      AccV<FCOS>*       a_acc
+    )
+    const
+    {
+      Len  const r = SqRt(Sqr(a_r[0]) + Sqr(a_r[1]) + Sqr(a_r[2]));
+      auto const f = BodyData<Body::Moon>::K / Cube(r);
+      for (size_t i = 0; i < 3; ++i)
+        (*a_acc)[i] -= f * a_r[i];
+    }
+  };
+}
+
+//===========================================================================//
+// "main":                                                                   //
+//===========================================================================//
+int main()
+{
+  constexpr int    NRows = 4;
+  constexpr int    NCols = 8;
+  constexpr int    NLat  = 101;
+  constexpr int    NLon  = 201;
+  constexpr double Scale = 0.125;
+  constexpr Len    R     = To_Len(1737.4_km);
+  constexpr Len    hND   = Len(-5000.0);
+  constexpr int    MI    = NRows - 1;   // The missing tile
+  constexpr int    MJ    = NCols - 1;   //
+  string const     dir   = "TerrainTest-Moon.dem";
+
+  //-------------------------------------------------------------------------//
+  // Write the tiles (all but one):                                          //
+  //-------------------------------------------------------------------------//
+  filesystem::remove_all        (dir);
+  filesystem::create_directories(dir);
+
+  double const tilePhi    = Pi<double>       / NRows;
+  double const tileLambda = 2.0 * Pi<double> / NCols;
+  vector<double> h(size_t(NLat * NLon));
+
+  for (int i = 0; i < NRows; ++i)
+  for (int j = 0; j < NCols; ++j)
+  {
+    if (i == MI && j == MJ)
+      continue;
+    for (int p = 0; p < NLat; ++p)
+    for (int q = 0; q < NLon; ++q)
+      h[size_t(p * NLon + q)] =
+        H(0.5 * Pi<double> - tilePhi * (double(i) + double(p) / (NLat-1)),
+          tileLambda * (double(j) + double(q) / (NLon-1)));
+    TerrainModel::SaveTile
+      (dir, Body::Moon, NRows, NCols, i, j, R, NLat, NLon, h.data(), Scale);
+  }
+
+  TerrainModel terr(dir, Body::Moon, NRows, NCols, 4, hND);
+  cout << "# MaxElev = " << terr.MaxElev().Magnitude() << " m" << endl;
+
+  //-------------------------------------------------------------------------//
+  // Interpolation Accuracy, and the Cache:                                  //
+  //-------------------------------------------------------------------------//
+  // Random look-ups all over the globe: the LRU cache of 4 slots is thrashed,
+  // so there must be many mappings:
+  mt19937_64                        gen(12345);
+  uniform_real_distribution<double> uPhi(-0.5 * Pi<double>, 0.5 * Pi<double>);
+  uniform_real_distribution<double> uLam(-Pi<double>,       3.0 * Pi<double>);
+  double errMax = 0.0;
+  int    nND    = 0;
+  for (int k = 0; k < 100000; ++k)
+  {
+    double const phi    = uPhi(gen);
+    double const lambda = uLam(gen);
+    double       lam    = fmod(lambda, 2.0 * Pi<double>);
+    if (lam < 0.0)
+      lam += 2.0 * Pi<double>;
+    int const i = min(int((0.5 * Pi<double> - phi) / tilePhi), NRows-1);
+    int const j = min(int(lam / tileLambda),                   NCols-1);
+
+    Len const e = terr.Elevation(Angle(phi), Angle(lambda));
+    if (i == MI && j == MJ)
+    {
+      // The missing tile:
+      if (e != hND)
+      {
+        cerr << "ERROR: No-Data Elevation expected: " << e.Magnitude()
+             << endl;
+        return 1;
+      }
+      ++nND;
+      continue;
+    }
+    errMax = max(errMax, fabs(e.Magnitude() - H(phi, lam)));
+  }
+  cout << "Random: errMax = " << errMax << " m (Scale = " << Scale
+       << " m), NoData = " << nND << ", NMaps = " << terr.NMaps()
+       << ", NFailed = " << terr.NFailed() << endl;
+  if (errMax > 0.5 * Scale + 1e-9)
+  {
+    cerr << "ERROR: Interpolation error too large" << endl;
+    return 1;
+  }
+
+  // Look-ups along a short track stay within one tile: there must be no new
+  // mappings after the first one:
+  long const nMaps0 = terr.NMaps();
+  for (int k = 0; k < 10000; ++k)
+    (void) terr.Elevation(Angle(0.1 + 1e-5 * k), Angle(2.0 + 2e-5 * k));
+  cout << "Track:  NMaps = " << (terr.NMaps() - nMaps0) << endl;
+
+  //-------------------------------------------------------------------------//
+  // Impact Detection along a Descending Trajectory:                         //
+  //-------------------------------------------------------------------------//
+  // From 20 km above the reference sphere, descending at 50 m per step while
+  // moving East; "IsImpact" is polled after every step:
+  double const phi0 = 0.2;
+  double const lam0 = 1.0;
+  int          step = 0;
+  for (; step < 1000; ++step)
+  {
+    Len    const r   = R + Len(20000.0 - 50.0 * step);
+    double const lam = lam0 + 1e-4 * step;
+    PosVRot<Body::Moon> pos
+      {{ r * Cos(phi0) * Cos(lam), r * Cos(phi0) * Sin(lam), r * Sin(phi0) }};
+
+    Angle lambda, phi;
+    if (terr.IsImpact(pos, &lambda, &phi))
+    {
+      Len const hImp = terr.Elevation(phi, lambda);
+      cout << "Impact: step = " << step << ", alt = "
+           << (r - R).Magnitude() << " m, terrain = " << hImp.Magnitude()
+           << " m, lambda = " << lambda.Magnitude()
+           << ", phi = "      << phi.Magnitude() << endl;
+      if (r - R > hImp || r - R + Len(50.0) <= hImp)
+      {
+        cerr << "ERROR: Impact detected at a wrong step" << endl;
+        return 1;
+      }
+      break;
+    }
+  }
+  if (step == 1000)
+  {
+    cerr << "ERROR: No impact detected" << endl;
+    return 1;
+  }
+
+  //-------------------------------------------------------------------------//
+  // Impact as an ODE Event:                                                 //
+  //-------------------------------------------------------------------------//
+  // A ballistic descent (integrated in the Fixed COS, while the Body rotates)
+  // from 20 km, stopped at the terrain by "PropagateToEvent" with a "Terrain-
+  // Event": the altitude over the terrain must then be 0, up to the event time
+  // error times the vertical speed (~300 m/sec); as DOP853 has its own dense
+  // output of the order 7, the event time is accurate with or without the
+  // refinement (which is then not performed):
+  for (bool refine: { false, true })
+  {
+    constexpr Time PMoon = To_Time(27.321661_day);
+    double const   c0    = Cos(phi0);
+    double const   s0    = Sin(phi0);
+    Len    const   r0    = R + Len(20000.0);
+    Vel    const   vDown = Vel(100.0);
+    Vel    const   vEast = Vel(1000.0);
+    PosV<FCOS> const pos0
+      {{ r0 * c0 * Cos(lam0), r0 * c0 * Sin(lam0), r0 * s0 }};
+    VelV<FCOS> const vel0
+      {{ - vDown * c0 * Cos(lam0) - vEast * Sin(lam0),
+         - vDown * c0 * Sin(lam0) + vEast * Cos(lam0),
+         - vDown * s0 }};
+
+    RKIntegrator<RKMethod::DOP853, FCOS, CentralRHS> ode
+      (CentralRHS{}, 0.0_sec, pos0, vel0, 1e-10, Len(1e-3), Vel(1e-6));
+    TerrainEvent<FCOS> const g { &terr, PMoon };
+    Time te(0.0);
+    bool const hit =
+      PropagateToEvent
+        (&ode, 1000.0_sec, g, EventDir::Falling, &te, refine);
+
+    // The altitude at the event, via the Rotating COS:
+    Len alt(0.0);
+    if (hit)
+      alt = Len(g(te, ode.GetPos(), ode.GetVel()));
+    cout << "Event:  refine = " << refine << ", hit = " << hit
+         << ", t = "         << te.Magnitude()
+         << " sec, alt = "   << alt.Magnitude() << " m, RHS Calls = "
+         << ode.NRHSCalls()  << endl;
+    if (!hit || Abs(alt) > Len(1e-3))
+    {
+      cerr << "ERROR: Terrain event not found or inaccurate" << endl;
+      return 1;
+    }
+  }
+
+  // A position above the highest terrain is rejected without look-ups:
+  long const nMaps1 = terr.NMaps();
+  Len  const rHigh  = R + terr.MaxElev() + Len(1.0);
+  PosVRot<Body::Moon> high {{ Len(0.0), Len(0.0), -rHigh }};
+  cout << "High:   IsImpact = " << terr.IsImpact(high) << ", NMaps = "
+       << (terr.NMaps() - nMaps1) << endl;
+
+  //-------------------------------------------------------------------------//
+  // Basin below the Equatorial Radius of the Gravity Model:                 //
+  //-------------------------------------------------------------------------//
+  // The terrain at (phiB, lamB) is ~2 km below "MGF::Re", so with the default
+  // impact radius, "GravityField" throws "ImpactExn" before the terrain is
+  // reached. With the impact radius lowered to "MinRadius()", the field must
+  // be evaluated all the way down, until "IsImpact" detects the terrain:
+  double const phiB = -1.0;
+  double const lamB =  0.5;
+  Len    const hB   = terr.Elevation(Angle(phiB), Angle(lamB));
+  cout << "Basin:  terrain - Re = " << (R + hB - MGF::Re).Magnitude()
+       << " m, MinRadius - Re = "   << (terr.MinRadius() - MGF::Re).Magnitude()
+       << " m" << endl;
+  if (!(R + hB < MGF::Re && terr.MinRadius() <= R + hB))
+  {
+    cerr << "ERROR: The basin is not below Re, or MinRadius is wrong" << endl;
+    return 1;
+  }
+  for (bool lowered: { false, true })
+  {
+    MGF gf(20);
+    if (lowered)
+      gf.SetImpactRadius(terr.MinRadius());
+
+    bool exn   = false;
+    bool hit   = false;
+    int  stepB = 0;
+    for (; stepB < 1000 && !exn && !hit; ++stepB)
+    {
+      Len const r = R + Len(20000.0 - 50.0 * stepB);
+      PosVRot<Body::Moon> pos
+        {{ r * Cos(phiB) * Cos(lamB), r * Cos(phiB) * Sin(lamB),
+           r * Sin(phiB) }};
+      try
+      {
+        AccVRot<Body::Moon> acc{{ Acc(0.0), Acc(0.0), Acc(0.0) }};
+        gf(0.0_sec, pos, &acc);
+      }
+      catch (MGF::ImpactExn const&)
+      {
+        exn = true;
+      }
+      hit = !exn && terr.IsImpact(pos);
+    }
+    cout << "Basin:  ImpactRadius - Re = "
+         << (gf.ImpactRadius() - MGF::Re).Magnitude() << " m, step = "
+         << stepB << ", ImpactExn = " << exn << ", terrain hit = " << hit
+         << endl;
+    if (lowered ? (exn || !hit) : !exn)
+    {
+      cerr << "ERROR: Impact radius not applied" << endl;
+      return 1;
+    }
+  }
+
+  filesystem::remove_all(dir);
+  return 0;
+}